@@ -20,7 +20,7 @@ namespace {
 class BordersTest : public ::libvpx_test::EncoderTest,
     public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
  protected:
-  BordersTest() : EncoderTest(GET_PARAM(0)) {}
+  BordersTest() : EncoderTest(GET_PARAM(0)), cpu_used_(1) {}
   virtual ~BordersTest() {}
 
   virtual void SetUp() {
@@ -31,7 +31,7 @@ class BordersTest : public ::libvpx_test::EncoderTest,
   virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
                                   ::libvpx_test::Encoder *encoder) {
     if (video->frame() == 1) {
-      encoder->Control(VP8E_SET_CPUUSED, 1);
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
       encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
       encoder->Control(VP8E_SET_ARNR_MAXFRAMES, 7);
       encoder->Control(VP8E_SET_ARNR_STRENGTH, 5);
@@ -43,6 +43,8 @@ class BordersTest : public ::libvpx_test::EncoderTest,
     if (pkt->data.frame.flags & VPX_FRAME_IS_KEY) {
     }
   }
+
+  int cpu_used_;
 };
 
 TEST_P(BordersTest, TestEncodeHighBitrate) {
@@ -77,6 +79,21 @@ TEST_P(BordersTest, TestLowBitrate) {
 
   ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
 }
+TEST_P(BordersTest, TestRealtime) {
+  // Validate that this clip encodes and decodes without a mismatch in the
+  // real-time mode, which predicts from candidate motion vectors that may
+  // point far past the border of the reference frames.
+  SetMode(::libvpx_test::kRealTime);
+  cpu_used_ = 5;
+  cfg_.g_lag_in_frames = 0;
+  cfg_.rc_end_usage = VPX_CBR;
+  cfg_.rc_target_bitrate = 200;
+
+  ::libvpx_test::I420VideoSource video("hantro_odd.yuv", 208, 144, 30, 1, 0,
+                                       40);
+
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+}
 
 VP9_INSTANTIATE_TEST_CASE(BordersTest, ::testing::Values(
     ::libvpx_test::kTwoPassGood));
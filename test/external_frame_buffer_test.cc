@@ -24,6 +24,7 @@
 namespace {
 
 const int kVideoNameParam = 1;
+const char kVP8TestFile[] = "vp80-00-comprehensive-001.ivf";
 const char kVP9TestFile[] = "vp90-2-02-size-lf-1920x1080.webm";
 
 struct ExternalFrameBuffer {
@@ -270,26 +271,15 @@ class ExternalFrameBufferMD5Test
   ExternalFrameBufferList fb_list_;
 };
 
-#if CONFIG_WEBM_IO
-// Class for testing passing in external frame buffers to libvpx.
-class ExternalFrameBufferTest : public ::testing::Test {
+// Base class for testing passing in external frame buffers to libvpx. The
+// subclasses open a video and a decoder for it.
+class ExternalFrameBufferTestBase : public ::testing::Test {
  protected:
-  ExternalFrameBufferTest()
+  ExternalFrameBufferTestBase()
       : video_(NULL),
         decoder_(NULL),
         num_buffers_(0) {}
 
-  virtual void SetUp() {
-    video_ = new libvpx_test::WebMVideoSource(kVP9TestFile);
-    ASSERT_TRUE(video_ != NULL);
-    video_->Init();
-    video_->Begin();
-
-    vpx_codec_dec_cfg_t cfg = {0};
-    decoder_ = new libvpx_test::VP9Decoder(cfg, 0);
-    ASSERT_TRUE(decoder_ != NULL);
-  }
-
   virtual void TearDown() {
     delete decoder_;
     delete video_;
@@ -328,6 +318,9 @@ class ExternalFrameBufferTest : public ::testing::Test {
     return VPX_CODEC_OK;
   }
 
+  libvpx_test::CompressedVideoSource *video_;
+  libvpx_test::Decoder *decoder_;
+
  private:
   void CheckDecodedFrames() {
     libvpx_test::DxDataIterator dec_iter = decoder_->GetDxData();
@@ -339,12 +332,41 @@ class ExternalFrameBufferTest : public ::testing::Test {
     }
   }
 
-  libvpx_test::WebMVideoSource *video_;
-  libvpx_test::VP9Decoder *decoder_;
   int num_buffers_;
   ExternalFrameBufferList fb_list_;
 };
-#endif  // CONFIG_WEBM_IO
+
+#if CONFIG_VP8_DECODER
+class ExternalFrameBufferVP8Test : public ExternalFrameBufferTestBase {
+ protected:
+  virtual void SetUp() {
+    video_ = new libvpx_test::IVFVideoSource(kVP8TestFile);
+    ASSERT_TRUE(video_ != NULL);
+    video_->Init();
+    video_->Begin();
+
+    vpx_codec_dec_cfg_t cfg = {0};
+    decoder_ = new libvpx_test::VP8Decoder(cfg, 0);
+    ASSERT_TRUE(decoder_ != NULL);
+  }
+};
+#endif  // CONFIG_VP8_DECODER
+
+#if CONFIG_VP9_DECODER && CONFIG_WEBM_IO
+class ExternalFrameBufferTest : public ExternalFrameBufferTestBase {
+ protected:
+  virtual void SetUp() {
+    video_ = new libvpx_test::WebMVideoSource(kVP9TestFile);
+    ASSERT_TRUE(video_ != NULL);
+    video_->Init();
+    video_->Begin();
+
+    vpx_codec_dec_cfg_t cfg = {0};
+    decoder_ = new libvpx_test::VP9Decoder(cfg, 0);
+    ASSERT_TRUE(decoder_ != NULL);
+  }
+};
+#endif  // CONFIG_VP9_DECODER && CONFIG_WEBM_IO
 
 // This test runs through the set of test vectors, and decodes them.
 // Libvpx will call into the application to allocate a frame buffer when
@@ -356,17 +378,13 @@ TEST_P(ExternalFrameBufferMD5Test, ExtFBMD5Match) {
   libvpx_test::CompressedVideoSource *video = NULL;
 
   // Number of buffers equals #VP9_MAXIMUM_REF_BUFFERS +
-  // #VPX_MAXIMUM_WORK_BUFFERS + four jitter buffers.
+  // #VPX_MAXIMUM_WORK_BUFFERS + four jitter buffers, which is more than
+  // enough for VP8 as well.
   const int jitter_buffers = 4;
   const int num_buffers =
       VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS + jitter_buffers;
   set_num_buffers(num_buffers);
 
-#if CONFIG_VP8_DECODER
-  // Tell compiler we are not using kVP8TestVectors.
-  (void)libvpx_test::kVP8TestVectors;
-#endif
-
   // Open compressed video file.
   if (filename.substr(filename.length() - 3, 3) == "ivf") {
     video = new libvpx_test::IVFVideoSource(filename);
@@ -391,7 +409,61 @@ TEST_P(ExternalFrameBufferMD5Test, ExtFBMD5Match) {
   delete video;
 }
 
-#if CONFIG_WEBM_IO
+#if CONFIG_VP8_DECODER
+TEST_F(ExternalFrameBufferVP8Test, MinFrameBuffers) {
+  // Minimum number of external frame buffers for VP8 is
+  // #VP8_MAXIMUM_REF_BUFFERS + #VPX_MAXIMUM_WORK_BUFFERS.
+  const int num_buffers = VP8_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
+  ASSERT_EQ(VPX_CODEC_OK,
+            SetFrameBufferFunctions(
+                num_buffers, get_vp9_frame_buffer, release_vp9_frame_buffer));
+  ASSERT_EQ(VPX_CODEC_OK, DecodeRemainingFrames());
+}
+
+TEST_F(ExternalFrameBufferVP8Test, NotEnoughBuffers) {
+  // The VP8 decoder sets up all of its frame buffers on the first frame.
+  const int num_buffers = 2;
+  ASSERT_EQ(VPX_CODEC_OK,
+            SetFrameBufferFunctions(
+                num_buffers, get_vp9_frame_buffer, release_vp9_frame_buffer));
+  ASSERT_EQ(VPX_CODEC_MEM_ERROR, DecodeOneFrame());
+}
+
+TEST_F(ExternalFrameBufferVP8Test, NoRelease) {
+  const int num_buffers = VP8_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
+  ASSERT_EQ(VPX_CODEC_OK,
+            SetFrameBufferFunctions(num_buffers, get_vp9_frame_buffer,
+                                    do_not_release_vp9_frame_buffer));
+  ASSERT_EQ(VPX_CODEC_MEM_ERROR, DecodeRemainingFrames());
+}
+
+TEST_F(ExternalFrameBufferVP8Test, NullRealloc) {
+  const int num_buffers = VP8_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
+  ASSERT_EQ(VPX_CODEC_OK,
+            SetFrameBufferFunctions(num_buffers, get_vp9_zero_frame_buffer,
+                                    release_vp9_frame_buffer));
+  ASSERT_EQ(VPX_CODEC_MEM_ERROR, DecodeOneFrame());
+}
+
+TEST_F(ExternalFrameBufferVP8Test, ReallocOneLessByte) {
+  const int num_buffers = VP8_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
+  ASSERT_EQ(VPX_CODEC_OK,
+            SetFrameBufferFunctions(
+                num_buffers, get_vp9_one_less_byte_frame_buffer,
+                release_vp9_frame_buffer));
+  ASSERT_EQ(VPX_CODEC_MEM_ERROR, DecodeOneFrame());
+}
+
+TEST_F(ExternalFrameBufferVP8Test, SetAfterDecode) {
+  const int num_buffers = VP8_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS;
+  ASSERT_EQ(VPX_CODEC_OK, DecodeOneFrame());
+  ASSERT_EQ(VPX_CODEC_ERROR,
+            SetFrameBufferFunctions(
+                num_buffers, get_vp9_frame_buffer, release_vp9_frame_buffer));
+}
+#endif  // CONFIG_VP8_DECODER
+
+#if CONFIG_VP9_DECODER && CONFIG_WEBM_IO
 TEST_F(ExternalFrameBufferTest, MinFrameBuffers) {
   // Minimum number of external frame buffers for VP9 is
   // #VP9_MAXIMUM_REF_BUFFERS + #VPX_MAXIMUM_WORK_BUFFERS.
@@ -472,10 +544,19 @@ TEST_F(ExternalFrameBufferTest, SetAfterDecode) {
             SetFrameBufferFunctions(
                 num_buffers, get_vp9_frame_buffer, release_vp9_frame_buffer));
 }
-#endif  // CONFIG_WEBM_IO
+#endif  // CONFIG_VP9_DECODER && CONFIG_WEBM_IO
+
+#if CONFIG_VP8_DECODER
+VP8_INSTANTIATE_TEST_CASE(ExternalFrameBufferMD5Test,
+                          ::testing::ValuesIn(libvpx_test::kVP8TestVectors,
+                                              libvpx_test::kVP8TestVectors +
+                                              libvpx_test::kNumVP8TestVectors));
+#endif  // CONFIG_VP8_DECODER
 
+#if CONFIG_VP9_DECODER
 VP9_INSTANTIATE_TEST_CASE(ExternalFrameBufferMD5Test,
                           ::testing::ValuesIn(libvpx_test::kVP9TestVectors,
                                               libvpx_test::kVP9TestVectors +
                                               libvpx_test::kNumVP9TestVectors));
+#endif  // CONFIG_VP9_DECODER
 }  // namespace
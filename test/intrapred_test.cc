@@ -13,17 +13,25 @@
 #include "test/acm_random.h"
 #include "test/clear_system_state.h"
 #include "test/register_state_check.h"
+#include "test/util.h"
 #include "third_party/googletest/src/include/gtest/gtest.h"
 
 #include "./vpx_config.h"
+#if CONFIG_VP8
 #include "./vp8_rtcd.h"
 #include "vp8/common/blockd.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd.h"
+#endif
 #include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/mem.h"
 
 namespace {
 
 using libvpx_test::ACMRandom;
 
+#if CONFIG_VP8
 class IntraPredBase {
  public:
   virtual ~IntraPredBase() { libvpx_test::ClearSystemState(); }
@@ -382,5 +390,127 @@ INSTANTIATE_TEST_CASE_P(SSSE3, IntraPredUVTest,
                         ::testing::Values(
                             vp8_build_intra_predictors_mbuv_s_ssse3));
 #endif
+#endif  // CONFIG_VP8
+
+#if CONFIG_VP9
+typedef void (*vp9_intra_pred_fn_t)(uint8_t *dst, ptrdiff_t stride,
+                                    const uint8_t *above, const uint8_t *left);
+
+// <optimized function, reference function, block size>
+typedef std::tr1::tuple<vp9_intra_pred_fn_t, vp9_intra_pred_fn_t, int>
+    vp9_intra_pred_param_t;
+
+class VP9IntraPredTest
+    : public ::testing::TestWithParam<vp9_intra_pred_param_t> {
+ public:
+  virtual void SetUp() {
+    pred_fn_ = GET_PARAM(0);
+    ref_fn_ = GET_PARAM(1);
+    block_size_ = GET_PARAM(2);
+    above_ = above_data_ + 16;
+    rnd_.Reset(ACMRandom::DeterministicSeed());
+  }
+
+  virtual void TearDown() { libvpx_test::ClearSystemState(); }
+
+ protected:
+  static const int kNumTests = 1000;
+  static const int kMaxBlockSize = 32;
+  static const int kStride = kMaxBlockSize * 2;
+  static const int kDstSize = kStride * (kMaxBlockSize + 2);
+
+  // Fills the above row (including the above-left and above-right pixels)
+  // and the left column. Every few iterations the edges are set to extreme
+  // values to exercise the rounding.
+  void FillEdges(int iteration) {
+    const int mode = iteration % 4;
+    for (int i = -1; i < 2 * block_size_; ++i)
+      above_[i] = mode == 1 ? 255 : mode == 2 ? 0 : rnd_.Rand8();
+    for (int i = 0; i < block_size_; ++i)
+      left_[i] = mode == 1 ? 0 : mode == 2 ? 255 : rnd_.Rand8();
+  }
+
+  vp9_intra_pred_fn_t pred_fn_;
+  vp9_intra_pred_fn_t ref_fn_;
+  int block_size_;
+  ACMRandom rnd_;
+
+  DECLARE_ALIGNED(16, uint8_t, above_data_[16 + 2 * kMaxBlockSize]);
+  uint8_t *above_;
+  DECLARE_ALIGNED(16, uint8_t, left_[kMaxBlockSize]);
+  DECLARE_ALIGNED(16, uint8_t, dst_[kDstSize]);
+  DECLARE_ALIGNED(16, uint8_t, ref_dst_[kDstSize]);
+};
+
+TEST_P(VP9IntraPredTest, MatchesReference) {
+  for (int n = 0; n < kNumTests; ++n) {
+    FillEdges(n);
+    // Compare the whole buffer so that writes outside the block are caught.
+    for (int i = 0; i < kDstSize; ++i)
+      dst_[i] = ref_dst_[i] = rnd_.Rand8();
+
+    ref_fn_(ref_dst_ + kStride, kStride, above_, left_);
+    REGISTER_STATE_CHECK(pred_fn_(dst_ + kStride, kStride, above_, left_));
+
+    for (int i = 0; i < kDstSize; ++i)
+      ASSERT_EQ(ref_dst_[i], dst_[i])
+          << "block size " << block_size_ << ", row " << i / kStride - 1
+          << ", col " << i % kStride << ", iteration " << n;
+  }
+}
+
+using std::tr1::make_tuple;
+
+#define VP9_INTRA_PRED_ALL_SIZES(type, opt) \
+    make_tuple(&vp9_##type##_predictor_4x4_##opt, \
+               &vp9_##type##_predictor_4x4_c, 4), \
+    make_tuple(&vp9_##type##_predictor_8x8_##opt, \
+               &vp9_##type##_predictor_8x8_c, 8), \
+    make_tuple(&vp9_##type##_predictor_16x16_##opt, \
+               &vp9_##type##_predictor_16x16_c, 16), \
+    make_tuple(&vp9_##type##_predictor_32x32_##opt, \
+               &vp9_##type##_predictor_32x32_c, 32)
+
+INSTANTIATE_TEST_CASE_P(
+    C, VP9IntraPredTest,
+    ::testing::Values(
+        VP9_INTRA_PRED_ALL_SIZES(d117, c),
+        VP9_INTRA_PRED_ALL_SIZES(d135, c),
+        VP9_INTRA_PRED_ALL_SIZES(d153, c),
+        VP9_INTRA_PRED_ALL_SIZES(dc_top, c),
+        VP9_INTRA_PRED_ALL_SIZES(dc_left, c),
+        VP9_INTRA_PRED_ALL_SIZES(dc_128, c)));
+
+#if HAVE_SSSE3
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, VP9IntraPredTest,
+    ::testing::Values(
+        VP9_INTRA_PRED_ALL_SIZES(d117, ssse3),
+        VP9_INTRA_PRED_ALL_SIZES(d135, ssse3),
+        make_tuple(&vp9_d153_predictor_32x32_ssse3,
+                   &vp9_d153_predictor_32x32_c, 32),
+        VP9_INTRA_PRED_ALL_SIZES(dc_top, ssse3),
+        VP9_INTRA_PRED_ALL_SIZES(dc_left, ssse3),
+        VP9_INTRA_PRED_ALL_SIZES(dc_128, ssse3)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, VP9IntraPredTest,
+    ::testing::Values(
+        make_tuple(&vp9_d117_predictor_32x32_avx2,
+                   &vp9_d117_predictor_32x32_c, 32),
+        make_tuple(&vp9_d135_predictor_32x32_avx2,
+                   &vp9_d135_predictor_32x32_c, 32),
+        make_tuple(&vp9_d153_predictor_32x32_avx2,
+                   &vp9_d153_predictor_32x32_c, 32),
+        make_tuple(&vp9_dc_top_predictor_32x32_avx2,
+                   &vp9_dc_top_predictor_32x32_c, 32),
+        make_tuple(&vp9_dc_left_predictor_32x32_avx2,
+                   &vp9_dc_left_predictor_32x32_c, 32),
+        make_tuple(&vp9_dc_128_predictor_32x32_avx2,
+                   &vp9_dc_128_predictor_32x32_c, 32)));
+#endif
+#endif  // CONFIG_VP9
 
 }  // namespace
@@ -199,4 +199,28 @@ INSTANTIATE_TEST_CASE_P(
                    &vp9_idct8x8_12_add_ssse3,
                    TX_8X8, 12)));
 #endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, PartialIDctTest,
+    ::testing::Values(
+        make_tuple(&vp9_idct32x32_1024_add_c,
+                   &vp9_idct32x32_1024_add_avx2,
+                   TX_32X32, 1024),
+        make_tuple(&vp9_idct32x32_1024_add_c,
+                   &vp9_idct32x32_34_add_avx2,
+                   TX_32X32, 34),
+        make_tuple(&vp9_idct32x32_1024_add_c,
+                   &vp9_idct32x32_1_add_avx2,
+                   TX_32X32, 1),
+        make_tuple(&vp9_idct16x16_256_add_c,
+                   &vp9_idct16x16_256_add_avx2,
+                   TX_16X16, 256),
+        make_tuple(&vp9_idct16x16_256_add_c,
+                   &vp9_idct16x16_10_add_avx2,
+                   TX_16X16, 10),
+        make_tuple(&vp9_idct16x16_256_add_c,
+                   &vp9_idct16x16_1_add_avx2,
+                   TX_16X16, 1)));
+#endif
 }  // namespace
@@ -44,6 +44,23 @@ typedef void (*sad_n_by_n_by_4_fn_t)(const uint8_t *src_ptr,
 typedef std::tr1::tuple<int, int, sad_n_by_n_by_4_fn_t>
         sad_n_by_n_by_4_test_param_t;
 
+typedef unsigned int (*sad_m_by_n_avg_fn_t)(const uint8_t *src_ptr,
+                                            int src_stride,
+                                            const uint8_t *ref_ptr,
+                                            int ref_stride,
+                                            const uint8_t *second_pred,
+                                            unsigned int max_sad);
+typedef std::tr1::tuple<int, int, sad_m_by_n_avg_fn_t>
+        sad_m_by_n_avg_test_param_t;
+
+typedef void (*sad_m_by_n_by_k_fn_t)(const uint8_t *src_ptr,
+                                     int src_stride,
+                                     const uint8_t *ref_ptr,
+                                     int ref_stride,
+                                     unsigned int *sad_array);
+typedef std::tr1::tuple<int, int, int, sad_m_by_n_by_k_fn_t>
+        sad_m_by_n_by_k_test_param_t;
+
 using libvpx_test::ACMRandom;
 
 namespace {
@@ -56,6 +73,8 @@ class SADTestBase : public ::testing::Test {
         vpx_memalign(kDataAlignment, kDataBlockSize));
     reference_data_ = reinterpret_cast<uint8_t*>(
         vpx_memalign(kDataAlignment, kDataBufferSize));
+    second_pred_ = reinterpret_cast<uint8_t*>(
+        vpx_memalign(kDataAlignment, 64 * 64));
   }
 
   static void TearDownTestCase() {
@@ -63,6 +82,8 @@ class SADTestBase : public ::testing::Test {
     source_data_ = NULL;
     vpx_free(reference_data_);
     reference_data_ = NULL;
+    vpx_free(second_pred_);
+    second_pred_ = NULL;
   }
 
   virtual void TearDown() {
@@ -88,13 +109,21 @@ class SADTestBase : public ::testing::Test {
   // Sum of Absolute Differences. Given two blocks, calculate the absolute
   // difference between two pixels in the same relative location; accumulate.
   unsigned int ReferenceSAD(unsigned int max_sad, int block_idx = 0) {
+    return ReferenceSADAt(max_sad, GetReference(block_idx), NULL);
+  }
+
+  // Same as ReferenceSAD() for an arbitrary reference pointer. When
+  // second_pred is given, the reference is first averaged with it.
+  unsigned int ReferenceSADAt(unsigned int max_sad, const uint8_t *reference,
+                              const uint8_t *second_pred) {
     unsigned int sad = 0;
-    const uint8_t* const reference = GetReference(block_idx);
 
     for (int h = 0; h < height_; ++h) {
       for (int w = 0; w < width_; ++w) {
-        sad += abs(source_data_[h * source_stride_ + w]
-               - reference[h * reference_stride_ + w]);
+        int ref = reference[h * reference_stride_ + w];
+        if (second_pred != NULL)
+          ref = (ref + second_pred[h * width_ + w] + 1) >> 1;
+        sad += abs(source_data_[h * source_stride_ + w] - ref);
       }
       if (sad > max_sad) {
         break;
@@ -124,6 +153,7 @@ class SADTestBase : public ::testing::Test {
   int source_stride_;
   static uint8_t* reference_data_;
   int reference_stride_;
+  static uint8_t* second_pred_;
 
   ACMRandom rnd_;
 };
@@ -186,8 +216,47 @@ class SADx4Test : public SADTestBase,
   }
 };
 
+class SADavgTest : public SADTestBase,
+    public ::testing::WithParamInterface<sad_m_by_n_avg_test_param_t> {
+ public:
+  SADavgTest() : SADTestBase(GET_PARAM(0), GET_PARAM(1)) {}
+
+ protected:
+  void CheckSad() {
+    unsigned int ret;
+
+    REGISTER_STATE_CHECK(ret = GET_PARAM(2)(source_data_, source_stride_,
+                                            reference_data_, reference_stride_,
+                                            second_pred_, UINT_MAX));
+    ASSERT_EQ(ReferenceSADAt(UINT_MAX, reference_data_, second_pred_), ret);
+  }
+};
+
+// The x3 and x8 functions compute the SADs at K consecutive horizontal
+// offsets of the reference.
+class SADxKTest : public SADTestBase,
+    public ::testing::WithParamInterface<sad_m_by_n_by_k_test_param_t> {
+ public:
+  SADxKTest() : SADTestBase(GET_PARAM(0), GET_PARAM(1)) {}
+
+ protected:
+  void CheckSADs() {
+    const int k = GET_PARAM(2);
+    unsigned int exp_sad[8];
+
+    REGISTER_STATE_CHECK(GET_PARAM(3)(source_data_, source_stride_,
+                                      reference_data_, reference_stride_,
+                                      exp_sad));
+    for (int i = 0; i < k; ++i) {
+      EXPECT_EQ(ReferenceSADAt(UINT_MAX, reference_data_ + i, NULL),
+                exp_sad[i]) << "offset " << i;
+    }
+  }
+};
+
 uint8_t* SADTestBase::source_data_ = NULL;
 uint8_t* SADTestBase::reference_data_ = NULL;
+uint8_t* SADTestBase::second_pred_ = NULL;
 
 TEST_P(SADTest, MaxRef) {
   FillConstant(source_data_, source_stride_, 0);
@@ -294,6 +363,43 @@ TEST_P(SADTest, MaxSAD) {
   CheckSad(128);
 }
 
+TEST_P(SADavgTest, MaxRef) {
+  FillConstant(source_data_, source_stride_, 0);
+  FillConstant(reference_data_, reference_stride_, 255);
+  FillConstant(second_pred_, width_, 255);
+  CheckSad();
+}
+
+TEST_P(SADavgTest, Random) {
+  FillRandom(source_data_, source_stride_);
+  FillRandom(reference_data_, reference_stride_);
+  FillRandom(second_pred_, width_);
+  CheckSad();
+}
+
+TEST_P(SADavgTest, UnalignedRef) {
+  int tmp_stride = reference_stride_;
+  reference_stride_ -= 1;
+  FillRandom(source_data_, source_stride_);
+  FillRandom(reference_data_, reference_stride_);
+  FillRandom(second_pred_, width_);
+  CheckSad();
+  reference_stride_ = tmp_stride;
+}
+
+TEST_P(SADxKTest, MaxSrc) {
+  FillConstant(source_data_, source_stride_, 255);
+  memset(reference_data_, 0, kDataBufferSize);
+  CheckSADs();
+}
+
+TEST_P(SADxKTest, Random) {
+  FillRandom(source_data_, source_stride_);
+  for (int i = 0; i < kDataBufferSize; ++i)
+    reference_data_[i] = rnd_.Rand8();
+  CheckSADs();
+}
+
 using std::tr1::make_tuple;
 
 //------------------------------------------------------------------------------
@@ -366,6 +472,68 @@ INSTANTIATE_TEST_CASE_P(C, SADx4Test, ::testing::Values(
                         make_tuple(8, 4, sad_8x4x4d_c),
                         make_tuple(4, 8, sad_4x8x4d_c),
                         make_tuple(4, 4, sad_4x4x4d_c)));
+
+const sad_m_by_n_avg_fn_t sad_64x64_avg_c = vp9_sad64x64_avg_c;
+const sad_m_by_n_avg_fn_t sad_64x32_avg_c = vp9_sad64x32_avg_c;
+const sad_m_by_n_avg_fn_t sad_32x64_avg_c = vp9_sad32x64_avg_c;
+const sad_m_by_n_avg_fn_t sad_32x32_avg_c = vp9_sad32x32_avg_c;
+const sad_m_by_n_avg_fn_t sad_32x16_avg_c = vp9_sad32x16_avg_c;
+const sad_m_by_n_avg_fn_t sad_16x32_avg_c = vp9_sad16x32_avg_c;
+const sad_m_by_n_avg_fn_t sad_16x16_avg_c = vp9_sad16x16_avg_c;
+const sad_m_by_n_avg_fn_t sad_16x8_avg_c = vp9_sad16x8_avg_c;
+const sad_m_by_n_avg_fn_t sad_8x16_avg_c = vp9_sad8x16_avg_c;
+const sad_m_by_n_avg_fn_t sad_8x8_avg_c = vp9_sad8x8_avg_c;
+const sad_m_by_n_avg_fn_t sad_8x4_avg_c = vp9_sad8x4_avg_c;
+const sad_m_by_n_avg_fn_t sad_4x8_avg_c = vp9_sad4x8_avg_c;
+const sad_m_by_n_avg_fn_t sad_4x4_avg_c = vp9_sad4x4_avg_c;
+INSTANTIATE_TEST_CASE_P(C, SADavgTest, ::testing::Values(
+                        make_tuple(64, 64, sad_64x64_avg_c),
+                        make_tuple(64, 32, sad_64x32_avg_c),
+                        make_tuple(32, 64, sad_32x64_avg_c),
+                        make_tuple(32, 32, sad_32x32_avg_c),
+                        make_tuple(32, 16, sad_32x16_avg_c),
+                        make_tuple(16, 32, sad_16x32_avg_c),
+                        make_tuple(16, 16, sad_16x16_avg_c),
+                        make_tuple(16, 8, sad_16x8_avg_c),
+                        make_tuple(8, 16, sad_8x16_avg_c),
+                        make_tuple(8, 8, sad_8x8_avg_c),
+                        make_tuple(8, 4, sad_8x4_avg_c),
+                        make_tuple(4, 8, sad_4x8_avg_c),
+                        make_tuple(4, 4, sad_4x4_avg_c)));
+
+const sad_m_by_n_by_k_fn_t sad_64x64x3_c = vp9_sad64x64x3_c;
+const sad_m_by_n_by_k_fn_t sad_32x32x3_c = vp9_sad32x32x3_c;
+const sad_m_by_n_by_k_fn_t sad_16x16x3_c = vp9_sad16x16x3_c;
+const sad_m_by_n_by_k_fn_t sad_16x8x3_c = vp9_sad16x8x3_c;
+const sad_m_by_n_by_k_fn_t sad_8x16x3_c = vp9_sad8x16x3_c;
+const sad_m_by_n_by_k_fn_t sad_8x8x3_c = vp9_sad8x8x3_c;
+const sad_m_by_n_by_k_fn_t sad_4x4x3_c = vp9_sad4x4x3_c;
+const sad_m_by_n_by_k_fn_t sad_64x64x8_c = vp9_sad64x64x8_c;
+const sad_m_by_n_by_k_fn_t sad_32x32x8_c = vp9_sad32x32x8_c;
+const sad_m_by_n_by_k_fn_t sad_16x16x8_c = vp9_sad16x16x8_c;
+const sad_m_by_n_by_k_fn_t sad_16x8x8_c = vp9_sad16x8x8_c;
+const sad_m_by_n_by_k_fn_t sad_8x16x8_c = vp9_sad8x16x8_c;
+const sad_m_by_n_by_k_fn_t sad_8x8x8_c = vp9_sad8x8x8_c;
+const sad_m_by_n_by_k_fn_t sad_8x4x8_c = vp9_sad8x4x8_c;
+const sad_m_by_n_by_k_fn_t sad_4x8x8_c = vp9_sad4x8x8_c;
+const sad_m_by_n_by_k_fn_t sad_4x4x8_c = vp9_sad4x4x8_c;
+INSTANTIATE_TEST_CASE_P(C, SADxKTest, ::testing::Values(
+                        make_tuple(64, 64, 3, sad_64x64x3_c),
+                        make_tuple(32, 32, 3, sad_32x32x3_c),
+                        make_tuple(16, 16, 3, sad_16x16x3_c),
+                        make_tuple(16, 8, 3, sad_16x8x3_c),
+                        make_tuple(8, 16, 3, sad_8x16x3_c),
+                        make_tuple(8, 8, 3, sad_8x8x3_c),
+                        make_tuple(4, 4, 3, sad_4x4x3_c),
+                        make_tuple(64, 64, 8, sad_64x64x8_c),
+                        make_tuple(32, 32, 8, sad_32x32x8_c),
+                        make_tuple(16, 16, 8, sad_16x16x8_c),
+                        make_tuple(16, 8, 8, sad_16x8x8_c),
+                        make_tuple(8, 16, 8, sad_8x16x8_c),
+                        make_tuple(8, 8, 8, sad_8x8x8_c),
+                        make_tuple(8, 4, 8, sad_8x4x8_c),
+                        make_tuple(4, 8, 8, sad_4x8x8_c),
+                        make_tuple(4, 4, 8, sad_4x4x8_c)));
 #endif  // CONFIG_VP9_ENCODER
 
 //------------------------------------------------------------------------------
@@ -553,4 +721,126 @@ INSTANTIATE_TEST_CASE_P(SSE3, SADTest, ::testing::Values(
 #endif
 #endif
 
+#if HAVE_AVX2
+#if CONFIG_VP9_ENCODER
+const sad_m_by_n_fn_t sad_64x64_avx2_vp9 = vp9_sad64x64_avx2;
+const sad_m_by_n_fn_t sad_64x32_avx2_vp9 = vp9_sad64x32_avx2;
+const sad_m_by_n_fn_t sad_32x64_avx2_vp9 = vp9_sad32x64_avx2;
+const sad_m_by_n_fn_t sad_32x32_avx2_vp9 = vp9_sad32x32_avx2;
+const sad_m_by_n_fn_t sad_32x16_avx2_vp9 = vp9_sad32x16_avx2;
+const sad_m_by_n_fn_t sad_16x32_avx2_vp9 = vp9_sad16x32_avx2;
+const sad_m_by_n_fn_t sad_16x16_avx2_vp9 = vp9_sad16x16_avx2;
+const sad_m_by_n_fn_t sad_16x8_avx2_vp9 = vp9_sad16x8_avx2;
+const sad_m_by_n_fn_t sad_8x16_avx2_vp9 = vp9_sad8x16_avx2;
+const sad_m_by_n_fn_t sad_8x8_avx2_vp9 = vp9_sad8x8_avx2;
+const sad_m_by_n_fn_t sad_8x4_avx2_vp9 = vp9_sad8x4_avx2;
+const sad_m_by_n_fn_t sad_4x8_avx2_vp9 = vp9_sad4x8_avx2;
+const sad_m_by_n_fn_t sad_4x4_avx2_vp9 = vp9_sad4x4_avx2;
+INSTANTIATE_TEST_CASE_P(AVX2, SADTest, ::testing::Values(
+                        make_tuple(64, 64, sad_64x64_avx2_vp9),
+                        make_tuple(64, 32, sad_64x32_avx2_vp9),
+                        make_tuple(32, 64, sad_32x64_avx2_vp9),
+                        make_tuple(32, 32, sad_32x32_avx2_vp9),
+                        make_tuple(32, 16, sad_32x16_avx2_vp9),
+                        make_tuple(16, 32, sad_16x32_avx2_vp9),
+                        make_tuple(16, 16, sad_16x16_avx2_vp9),
+                        make_tuple(16, 8, sad_16x8_avx2_vp9),
+                        make_tuple(8, 16, sad_8x16_avx2_vp9),
+                        make_tuple(8, 8, sad_8x8_avx2_vp9),
+                        make_tuple(8, 4, sad_8x4_avx2_vp9),
+                        make_tuple(4, 8, sad_4x8_avx2_vp9),
+                        make_tuple(4, 4, sad_4x4_avx2_vp9)));
+
+const sad_n_by_n_by_4_fn_t sad_64x64x4d_avx2 = vp9_sad64x64x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_64x32x4d_avx2 = vp9_sad64x32x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_32x64x4d_avx2 = vp9_sad32x64x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_32x32x4d_avx2 = vp9_sad32x32x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_32x16x4d_avx2 = vp9_sad32x16x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_16x32x4d_avx2 = vp9_sad16x32x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_16x16x4d_avx2 = vp9_sad16x16x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_16x8x4d_avx2 = vp9_sad16x8x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_8x16x4d_avx2 = vp9_sad8x16x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_8x8x4d_avx2 = vp9_sad8x8x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_8x4x4d_avx2 = vp9_sad8x4x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_4x8x4d_avx2 = vp9_sad4x8x4d_avx2;
+const sad_n_by_n_by_4_fn_t sad_4x4x4d_avx2 = vp9_sad4x4x4d_avx2;
+INSTANTIATE_TEST_CASE_P(AVX2, SADx4Test, ::testing::Values(
+                        make_tuple(64, 64, sad_64x64x4d_avx2),
+                        make_tuple(64, 32, sad_64x32x4d_avx2),
+                        make_tuple(32, 64, sad_32x64x4d_avx2),
+                        make_tuple(32, 32, sad_32x32x4d_avx2),
+                        make_tuple(32, 16, sad_32x16x4d_avx2),
+                        make_tuple(16, 32, sad_16x32x4d_avx2),
+                        make_tuple(16, 16, sad_16x16x4d_avx2),
+                        make_tuple(16, 8, sad_16x8x4d_avx2),
+                        make_tuple(8, 16, sad_8x16x4d_avx2),
+                        make_tuple(8, 8, sad_8x8x4d_avx2),
+                        make_tuple(8, 4, sad_8x4x4d_avx2),
+                        make_tuple(4, 8, sad_4x8x4d_avx2),
+                        make_tuple(4, 4, sad_4x4x4d_avx2)));
+
+const sad_m_by_n_avg_fn_t sad_64x64_avg_avx2 = vp9_sad64x64_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_64x32_avg_avx2 = vp9_sad64x32_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_32x64_avg_avx2 = vp9_sad32x64_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_32x32_avg_avx2 = vp9_sad32x32_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_32x16_avg_avx2 = vp9_sad32x16_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_16x32_avg_avx2 = vp9_sad16x32_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_16x16_avg_avx2 = vp9_sad16x16_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_16x8_avg_avx2 = vp9_sad16x8_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_8x16_avg_avx2 = vp9_sad8x16_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_8x8_avg_avx2 = vp9_sad8x8_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_8x4_avg_avx2 = vp9_sad8x4_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_4x8_avg_avx2 = vp9_sad4x8_avg_avx2;
+const sad_m_by_n_avg_fn_t sad_4x4_avg_avx2 = vp9_sad4x4_avg_avx2;
+INSTANTIATE_TEST_CASE_P(AVX2, SADavgTest, ::testing::Values(
+                        make_tuple(64, 64, sad_64x64_avg_avx2),
+                        make_tuple(64, 32, sad_64x32_avg_avx2),
+                        make_tuple(32, 64, sad_32x64_avg_avx2),
+                        make_tuple(32, 32, sad_32x32_avg_avx2),
+                        make_tuple(32, 16, sad_32x16_avg_avx2),
+                        make_tuple(16, 32, sad_16x32_avg_avx2),
+                        make_tuple(16, 16, sad_16x16_avg_avx2),
+                        make_tuple(16, 8, sad_16x8_avg_avx2),
+                        make_tuple(8, 16, sad_8x16_avg_avx2),
+                        make_tuple(8, 8, sad_8x8_avg_avx2),
+                        make_tuple(8, 4, sad_8x4_avg_avx2),
+                        make_tuple(4, 8, sad_4x8_avg_avx2),
+                        make_tuple(4, 4, sad_4x4_avg_avx2)));
+
+const sad_m_by_n_by_k_fn_t sad_64x64x3_avx2 = vp9_sad64x64x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_32x32x3_avx2 = vp9_sad32x32x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_16x16x3_avx2 = vp9_sad16x16x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_16x8x3_avx2 = vp9_sad16x8x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_8x16x3_avx2 = vp9_sad8x16x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_8x8x3_avx2 = vp9_sad8x8x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_4x4x3_avx2 = vp9_sad4x4x3_avx2;
+const sad_m_by_n_by_k_fn_t sad_64x64x8_avx2 = vp9_sad64x64x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_32x32x8_avx2 = vp9_sad32x32x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_16x16x8_avx2 = vp9_sad16x16x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_16x8x8_avx2 = vp9_sad16x8x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_8x16x8_avx2 = vp9_sad8x16x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_8x8x8_avx2 = vp9_sad8x8x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_8x4x8_avx2 = vp9_sad8x4x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_4x8x8_avx2 = vp9_sad4x8x8_avx2;
+const sad_m_by_n_by_k_fn_t sad_4x4x8_avx2 = vp9_sad4x4x8_avx2;
+INSTANTIATE_TEST_CASE_P(AVX2, SADxKTest, ::testing::Values(
+                        make_tuple(64, 64, 3, sad_64x64x3_avx2),
+                        make_tuple(32, 32, 3, sad_32x32x3_avx2),
+                        make_tuple(16, 16, 3, sad_16x16x3_avx2),
+                        make_tuple(16, 8, 3, sad_16x8x3_avx2),
+                        make_tuple(8, 16, 3, sad_8x16x3_avx2),
+                        make_tuple(8, 8, 3, sad_8x8x3_avx2),
+                        make_tuple(4, 4, 3, sad_4x4x3_avx2),
+                        make_tuple(64, 64, 8, sad_64x64x8_avx2),
+                        make_tuple(32, 32, 8, sad_32x32x8_avx2),
+                        make_tuple(16, 16, 8, sad_16x16x8_avx2),
+                        make_tuple(16, 8, 8, sad_16x8x8_avx2),
+                        make_tuple(8, 16, 8, sad_8x16x8_avx2),
+                        make_tuple(8, 8, 8, sad_8x8x8_avx2),
+                        make_tuple(8, 4, 8, sad_8x4x8_avx2),
+                        make_tuple(4, 8, 8, sad_4x8x8_avx2),
+                        make_tuple(4, 4, 8, sad_4x4x8_avx2)));
+#endif  // CONFIG_VP9_ENCODER
+#endif  // HAVE_AVX2
+
 }  // namespace
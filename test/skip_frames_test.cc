@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/decode_test_driver.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+
+namespace {
+
+const int kFrames = 12;
+const int kKeyFrame = 6;
+
+// Every third frame is not a reference. Not the frame after a key frame,
+// which VP8 encoders send loop filter deltas with.
+bool IsNotReference(int frame) {
+  return frame % 3 == 2;
+}
+
+// Encodes a stream with a second key frame, in which the IsNotReference()
+// frames refresh no reference buffer. The first parameter sets whether the
+// stream is error resilient, which VP8 refreshes the segmentation map of on
+// every frame. The second sets whether the decoder may drop those frames:
+// VP8 can, while VP9 frames still reset or update state that later frames
+// depend on, even in error resilient streams.
+class SkipFramesTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<int, int> {
+ protected:
+  SkipFramesTest() : EncoderTest(GET_PARAM(0)), drops_(GET_PARAM(2)) {}
+  virtual ~SkipFramesTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.g_error_resilient = GET_PARAM(1);
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 300;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1)
+      encoder->Control(VP8E_SET_CPUUSED, 5);
+    frame_flags_ = IsNotReference(video->frame()) ?
+        VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF |
+        VP8_EFLAG_NO_UPD_ENTROPY : 0;
+    if (video->frame() == kKeyFrame)
+      frame_flags_ |= VPX_EFLAG_FORCE_KF;
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  void Encode() {
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                         352, 288, 30, 1, 0, kFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Decodes packets [first, last) with the given skip mode. Returns the MD5 of
+  // each decoded frame, and optionally whether each packet was droppable.
+  std::vector<std::string> Decode(int first, int last, int skip_frames,
+                                  std::vector<int> *droppable) {
+    const vpx_codec_dec_cfg_t cfg = {0};
+    ::libvpx_test::Decoder *const decoder = codec_->CreateDecoder(cfg, 0);
+    std::vector<std::string> md5s;
+
+    decoder->Control(VPXD_SET_SKIP_FRAMES, skip_frames);
+    for (int i = first; i < last; ++i) {
+      EXPECT_EQ(VPX_CODEC_OK,
+                decoder->DecodeFrame(&packets_[i][0], packets_[i].size()))
+          << decoder->DecodeError();
+      if (droppable != NULL) {
+        int frame_droppable = -1;
+        decoder->Control(VPXD_GET_FRAME_DROPPABLE, &frame_droppable);
+        droppable->push_back(frame_droppable);
+      }
+
+      ::libvpx_test::DxDataIterator dec_iter = decoder->GetDxData();
+      const vpx_image_t *img;
+      while ((img = dec_iter.Next()) != NULL) {
+        ::libvpx_test::MD5 md5;
+        md5.Add(img);
+        md5s.push_back(md5.Get());
+      }
+    }
+    delete decoder;
+    return md5s;
+  }
+
+  bool IsDroppable(int frame) const {
+    return drops_ && IsNotReference(frame);
+  }
+
+  int drops_;
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+TEST_P(SkipFramesTest, ReportsDroppableFrames) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  std::vector<int> droppable;
+  const std::vector<std::string> md5s = Decode(0, kFrames, 0, &droppable);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), md5s.size());
+  for (int i = 0; i < kFrames; ++i)
+    EXPECT_EQ(IsDroppable(i), droppable[i] == 1) << "Frame " << i;
+}
+
+// Skipping the droppable frames leaves the other frames as they were.
+TEST_P(SkipFramesTest, SkipDroppableFrames) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> all = Decode(0, kFrames, 0, NULL);
+  const std::vector<std::string> kept = Decode(0, kFrames, 1, NULL);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), all.size());
+  std::vector<std::string> expected;
+  for (int i = 0; i < kFrames; ++i) {
+    if (!IsDroppable(i))
+      expected.push_back(all[i]);
+  }
+  EXPECT_TRUE(expected == kept);
+}
+
+TEST_P(SkipFramesTest, KeyFramesOnly) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> all = Decode(0, kFrames, 0, NULL);
+  // Starting after the first key frame, as a seek would.
+  const std::vector<std::string> key = Decode(1, kFrames, 2, NULL);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), all.size());
+  ASSERT_EQ(1u, key.size());
+  EXPECT_EQ(all[kKeyFrame], key[0]);
+}
+
+// Seeks to the last frame: decodes the frames it depends on from the key
+// frame before it, then the frame itself.
+TEST_P(SkipFramesTest, SeekToFrame) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> all = Decode(0, kFrames, 0, NULL);
+  const vpx_codec_dec_cfg_t cfg = {0};
+  ::libvpx_test::Decoder *const decoder = codec_->CreateDecoder(cfg, 0);
+
+  decoder->Control(VPXD_SET_SKIP_FRAMES, 1);
+  for (int i = kKeyFrame; i < kFrames - 1; ++i)
+    ASSERT_EQ(VPX_CODEC_OK,
+              decoder->DecodeFrame(&packets_[i][0], packets_[i].size()));
+  decoder->Control(VPXD_SET_SKIP_FRAMES, 0);
+  ASSERT_EQ(VPX_CODEC_OK,
+            decoder->DecodeFrame(&packets_[kFrames - 1][0],
+                                 packets_[kFrames - 1].size()));
+
+  ::libvpx_test::DxDataIterator dec_iter = decoder->GetDxData();
+  const vpx_image_t *const img = dec_iter.Next();
+  ASSERT_TRUE(img != NULL);
+  ::libvpx_test::MD5 md5;
+  md5.Add(img);
+  EXPECT_EQ(all[kFrames - 1], md5.Get());
+  delete decoder;
+}
+
+VP8_INSTANTIATE_TEST_CASE(SkipFramesTest, ::testing::Values(0),
+                          ::testing::Values(1));
+VP9_INSTANTIATE_TEST_CASE(SkipFramesTest, ::testing::Values(1),
+                          ::testing::Values(0));
+}  // namespace
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/i420_video_source.h"
+#include "./vpx_config.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 10;
+// An ABR ladder: the same input at three bitrates.
+const int kEncoders = 3;
+const unsigned int kBitrates[kEncoders] = { 800, 400, 200 };
+
+class VP8SharedThreadsTest : public ::testing::TestWithParam<int> {
+ protected:
+  void InitEncoder(vpx_codec_ctx_t *encoder, unsigned int bitrate,
+                   vpx_codec_flags_t flags) {
+    vpx_codec_enc_cfg_t cfg;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp8_cx_algo, &cfg, 0));
+    cfg.g_w = kWidth;
+    cfg.g_h = kHeight;
+    cfg.g_threads = GetParam();
+    cfg.g_lag_in_frames = 0;
+    cfg.rc_end_usage = VPX_CBR;
+    cfg.rc_target_bitrate = bitrate;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(encoder, &vpx_codec_vp8_cx_algo, &cfg, flags));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(encoder, VP8E_SET_CPUUSED, -6));
+  }
+
+  static void GetOutput(vpx_codec_ctx_t *encoder, std::string *out) {
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+
+    while ((pkt = vpx_codec_get_cx_data(encoder, &iter)) != NULL) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
+        out->append(static_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz);
+    }
+  }
+
+  // Encodes each frame with every encoder in turn.
+  void Encode(vpx_codec_flags_t flags, std::string *out) {
+    vpx_codec_ctx_t encoders[kEncoders];
+
+    for (int i = 0; i < kEncoders; ++i)
+      InitEncoder(&encoders[i], kBitrates[i], flags);
+
+    libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                       kWidth, kHeight, 30, 1, 0, kFrames);
+    for (video.Begin(); video.img() != NULL; video.Next()) {
+      for (int i = 0; i < kEncoders; ++i) {
+        EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&encoders[i], video.img(),
+                                                 video.pts(), 1, 0,
+                                                 VPX_DL_REALTIME));
+        GetOutput(&encoders[i], &out[i]);
+      }
+    }
+
+    for (int i = 0; i < kEncoders; ++i)
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&encoders[i]));
+  }
+};
+
+TEST_P(VP8SharedThreadsTest, MatchesOwnThreads) {
+  std::string own[kEncoders];
+  std::string shared[kEncoders];
+
+  Encode(0, own);
+  Encode(VPX_CODEC_USE_SHARED_THREADS, shared);
+
+  for (int i = 0; i < kEncoders; ++i) {
+    ASSERT_FALSE(own[i].empty());
+    EXPECT_TRUE(own[i] == shared[i])
+        << "Output of encoder " << i << " differs on shared threads";
+  }
+}
+
+#if CONFIG_VP9_ENCODER
+TEST(VP8SharedThreadsTest, VP9Incapable) {
+  vpx_codec_ctx_t encoder;
+  vpx_codec_enc_cfg_t cfg;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_INCAPABLE,
+            vpx_codec_enc_init(&encoder, &vpx_codec_vp9_cx_algo, &cfg,
+                               VPX_CODEC_USE_SHARED_THREADS));
+}
+#endif
+
+// Threads per encoder: none, and more than some machines have cores.
+INSTANTIATE_TEST_CASE_P(VP8, VP8SharedThreadsTest, ::testing::Values(1, 4, 8));
+}  // namespace
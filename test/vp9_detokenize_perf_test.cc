@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#include "vpx_ports/vpx_timer.h"
+#include "./vpx_version.h"
+
+namespace {
+
+const double kUsecsInSec = 1000000.0;
+const int kFrames = 30;
+const int kDecodeRuns = 10;
+
+/*
+ Times the decoding of a stream coded at a low fixed quantizer, so that the
+ decode time is dominated by the coefficient tokens. Like the other perf
+ tests, it *DOES NOT* check the output: run it alongside the correctness
+ tests.
+ */
+class VP9DetokenizePerfTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9DetokenizePerfTest() : EncoderTest(GET_PARAM(0)), q_(GET_PARAM(1)) {}
+  virtual ~VP9DetokenizePerfTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_Q;
+    cfg_.rc_min_quantizer = q_;
+    cfg_.rc_max_quantizer = q_;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP8E_SET_CPUUSED, 5);
+      encoder->Control(VP8E_SET_CQ_LEVEL, q_);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  int q_;
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+TEST_P(VP9DetokenizePerfTest, PerfTest) {
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                       352, 288, 30, 1, 0, kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+  size_t stream_size = 0;
+  for (size_t i = 0; i < packets_.size(); ++i)
+    stream_size += packets_[i].size();
+
+  vpx_codec_ctx_t decoder;
+  vpx_codec_dec_cfg_t cfg = {0};
+  vpx_usec_timer t;
+  vpx_usec_timer_start(&t);
+
+  for (int run = 0; run < kDecodeRuns; ++run) {
+    vpx_codec_dec_init(&decoder, vpx_codec_vp9_dx(), &cfg, 0);
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      vpx_codec_decode(&decoder, &packets_[i][0],
+                       static_cast<unsigned int>(packets_[i].size()), NULL, 0);
+      vpx_codec_iter_t iter = NULL;
+      while (vpx_codec_get_frame(&decoder, &iter) != NULL) {
+      }
+    }
+    vpx_codec_destroy(&decoder);
+  }
+
+  vpx_usec_timer_mark(&t);
+  const double elapsed_secs = double(vpx_usec_timer_elapsed(&t))
+                              / kUsecsInSec;
+  const unsigned frames = static_cast<unsigned>(packets_.size() * kDecodeRuns);
+  const double fps = double(frames) / elapsed_secs;
+
+  printf("{\n");
+  printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+  printf("\t\"videoName\" : \"hantro_collage_w352h288.yuv\",\n");
+  printf("\t\"quantizer\" : %d,\n", q_);
+  printf("\t\"streamBytes\" : %u,\n", static_cast<unsigned>(stream_size));
+  printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
+  printf("\t\"totalFrames\" : %u,\n", frames);
+  printf("\t\"framesPerSecond\" : %f\n", fps);
+  printf("}\n");
+}
+
+// Low quantizers, at which the tokens make up most of the stream.
+VP9_INSTANTIATE_TEST_CASE(VP9DetokenizePerfTest, ::testing::Values(0, 4, 16));
+}  // namespace
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+class VP9EncoderThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  VP9EncoderThreadTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        set_cpu_used_(GET_PARAM(2)), row_mt_(0), tile_cols_(0),
+        tile_rows_(0) {}
+  virtual ~VP9EncoderThreadTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+
+    if (encoding_mode_ != ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 3;
+      cfg_.rc_end_usage = VPX_VBR;
+      cfg_.rc_2pass_vbr_minsection_pct = 5;
+      cfg_.rc_2pass_vbr_maxsection_pct = 2000;
+    } else {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+      cfg_.g_error_resilient = 1;
+    }
+    cfg_.rc_max_quantizer = 56;
+    cfg_.rc_min_quantizer = 0;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    md5_ = ::libvpx_test::MD5();
+    stream_.clear();
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP8E_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(VP9E_SET_ROW_MT, row_mt_);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, tile_cols_);
+      encoder->Control(VP9E_SET_TILE_ROWS, tile_rows_);
+      if (encoding_mode_ != ::libvpx_test::kRealTime) {
+        encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+        encoder->Control(VP8E_SET_ARNR_MAXFRAMES, 7);
+        encoder->Control(VP8E_SET_ARNR_STRENGTH, 5);
+        encoder->Control(VP8E_SET_ARNR_TYPE, 3);
+      } else {
+        encoder->Control(VP9E_SET_AQ_MODE, 3);
+      }
+    }
+  }
+
+  virtual void DecompressedFrameHook(const vpx_image_t &img,
+                                     vpx_codec_pts_t /*pts*/) {
+    md5_.Add(&img);
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    stream_.append(static_cast<const char *>(pkt->data.frame.buf),
+                   pkt->data.frame.sz);
+  }
+
+  std::string EncodeWithThreads(int threads) {
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                         352, 288, 30, 1, 0, 10);
+    cfg_.g_threads = threads;
+    init_flags_ = VPX_CODEC_USE_PSNR;
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return md5_.Get();
+  }
+
+  // Returns the compressed stream of frames with two tile columns and two
+  // tile rows.
+  std::string EncodeTilesWithThreads(int threads) {
+    ::libvpx_test::RandomVideoSource video;
+    video.SetSize(640, 240);
+    video.set_limit(10);
+    cfg_.g_threads = threads;
+    tile_cols_ = 1;
+    tile_rows_ = 1;
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return stream_;
+  }
+
+  // Returns the first pass statistics of the last two pass encode.
+  std::string FirstPassStats() {
+    const vpx_fixed_buf_t buf = stats_.buf();
+    return std::string(static_cast<const char *>(buf.buf), buf.sz);
+  }
+
+  ::libvpx_test::TestMode encoding_mode_;
+  int set_cpu_used_;
+  int row_mt_;
+  int tile_cols_;
+  int tile_rows_;
+  ::libvpx_test::MD5 md5_;
+  std::string stream_;
+};
+
+// Row based multi-threading must produce the same output regardless of the
+// number of threads used.
+TEST_P(VP9EncoderThreadTest, RowMTEncoderResultMatch) {
+  row_mt_ = 1;
+  const std::string single_thread_md5 = EncodeWithThreads(1);
+  const std::string multi_thread_md5 = EncodeWithThreads(4);
+  ASSERT_EQ(single_thread_md5, multi_thread_md5);
+}
+
+// Each tile column is encoded by one thread, after the tile columns it
+// encoded before, rather than in tile row order.
+TEST_P(VP9EncoderThreadTest, TileColumnsMatch) {
+  const std::string single_thread_stream = EncodeTilesWithThreads(1);
+  const std::string multi_thread_stream = EncodeTilesWithThreads(4);
+  ASSERT_FALSE(single_thread_stream.empty());
+  ASSERT_TRUE(single_thread_stream == multi_thread_stream);
+}
+
+// The rows of each tile column are spread over the threads, so every thread
+// encodes rows that follow rows other threads encoded.
+TEST_P(VP9EncoderThreadTest, RowMTTilesMatch) {
+  row_mt_ = 1;
+  const std::string single_thread_stream = EncodeTilesWithThreads(1);
+  const std::string multi_thread_stream = EncodeTilesWithThreads(2);
+  ASSERT_FALSE(single_thread_stream.empty());
+  ASSERT_TRUE(single_thread_stream == multi_thread_stream);
+}
+
+// Tile columns packed in parallel must come out as they do one after another.
+// Row based multi-threading encodes the tiles the same on any number of
+// threads, so any difference comes from the packing.
+TEST_P(VP9EncoderThreadTest, PackedTilesMatch) {
+  row_mt_ = 1;
+  const std::string single_thread_stream = EncodeTilesWithThreads(1);
+  const std::string multi_thread_stream = EncodeTilesWithThreads(4);
+  ASSERT_FALSE(single_thread_stream.empty());
+  ASSERT_TRUE(single_thread_stream == multi_thread_stream);
+}
+
+// The first pass statistics must not depend on the number of threads used.
+TEST_P(VP9EncoderThreadTest, FirstPassStatsMatch) {
+  if (encoding_mode_ != ::libvpx_test::kTwoPassGood)
+    return;
+  EncodeWithThreads(1);
+  const std::string single_thread_stats = FirstPassStats();
+  EncodeWithThreads(4);
+  ASSERT_EQ(single_thread_stats, FirstPassStats());
+}
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9EncoderThreadTest,
+    ::testing::Values(::libvpx_test::kTwoPassGood, ::libvpx_test::kOnePassGood,
+                      ::libvpx_test::kRealTime),
+    ::testing::Values(2, 5, 7));
+}  // namespace
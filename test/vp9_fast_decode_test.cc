@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kFrames = 10;
+
+// Encodes a stream in which every odd frame is not a reference, then decodes
+// it with the decode-time shortcuts.
+class VP9FastDecodeTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9FastDecodeTest() : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)) {}
+  virtual ~VP9FastDecodeTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 300;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1)
+      encoder->Control(VP8E_SET_CPUUSED, 5);
+    frame_flags_ = (video->frame() & 1) ?
+        VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF : 0;
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  void Encode() {
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                         352, 288, 30, 1, 0, kFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    ASSERT_EQ(static_cast<size_t>(kFrames), packets_.size());
+  }
+
+  // Returns the MD5 of each decoded frame.
+  std::vector<std::string> Decode(int skip_loop_filter,
+                                  int bilinear_prediction) {
+    vpx_codec_ctx_t decoder;
+    vpx_codec_dec_cfg_t cfg = {0};
+    std::vector<std::string> md5s;
+
+    cfg.threads = threads_;
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&decoder, vpx_codec_vp9_dx(),
+                                               &cfg, 0));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&decoder,
+                                              VP9D_SET_SKIP_LOOP_FILTER,
+                                              skip_loop_filter));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&decoder,
+                                              VP9D_SET_BILINEAR_PREDICTION,
+                                              bilinear_prediction));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      const unsigned int size = static_cast<unsigned int>(packets_[i].size());
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(&decoder, &packets_[i][0], size, NULL, 0))
+          << vpx_codec_error_detail(&decoder);
+
+      vpx_codec_iter_t iter = NULL;
+      const vpx_image_t *img;
+      while ((img = vpx_codec_get_frame(&decoder, &iter)) != NULL) {
+        ::libvpx_test::MD5 md5;
+        md5.Add(img);
+        md5s.push_back(md5.Get());
+      }
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&decoder));
+    return md5s;
+  }
+
+  int threads_;
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+// Skipping the loop filter of the frames no other frame references leaves
+// the reference frames intact.
+TEST_P(VP9FastDecodeTest, SkipNonReferenceLoopFilter) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> exact = Decode(0, 0);
+  const std::vector<std::string> fast = Decode(1, 0);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), exact.size());
+  ASSERT_EQ(exact.size(), fast.size());
+  int changed = 0;
+  for (int i = 0; i < kFrames; ++i) {
+    if (i & 1)
+      changed += exact[i] != fast[i];
+    else
+      EXPECT_EQ(exact[i], fast[i]) << "Reference frame " << i << " differs";
+  }
+  EXPECT_GT(changed, 0);
+}
+
+TEST_P(VP9FastDecodeTest, SkipAllLoopFilter) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> exact = Decode(0, 0);
+  const std::vector<std::string> fast = Decode(2, 0);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), fast.size());
+  // The first reference frame to change changes the frames that follow.
+  int i = 0;
+  while (i < kFrames && exact[i] == fast[i])
+    ++i;
+  ASSERT_LT(i, kFrames);
+  for (; i < kFrames; ++i)
+    EXPECT_NE(exact[i], fast[i]) << "Frame " << i << " unchanged";
+}
+
+// The key frame has no inter prediction to change.
+TEST_P(VP9FastDecodeTest, BilinearPrediction) {
+  ASSERT_NO_FATAL_FAILURE(Encode());
+  const std::vector<std::string> exact = Decode(0, 0);
+  const std::vector<std::string> fast = Decode(0, 1);
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), fast.size());
+  EXPECT_EQ(exact[0], fast[0]);
+  EXPECT_NE(exact[kFrames - 1], fast[kFrames - 1]);
+}
+
+TEST_P(VP9FastDecodeTest, RejectsInvalidSkipLoopFilter) {
+  vpx_codec_ctx_t decoder;
+  vpx_codec_dec_cfg_t cfg = {0};
+
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&decoder, vpx_codec_vp9_dx(),
+                                             &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&decoder, VP9D_SET_SKIP_LOOP_FILTER, 3));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&decoder, VP9D_SET_SKIP_LOOP_FILTER, -1));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&decoder));
+}
+
+VP9_INSTANTIATE_TEST_CASE(VP9FastDecodeTest, ::testing::Values(1, 2));
+}  // namespace
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kFrames = 20;
+
+class VP9FrameParallelTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  VP9FrameParallelTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        frame_parallel_decoding_mode_(GET_PARAM(2)) {}
+  virtual ~VP9FrameParallelTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+
+    if (encoding_mode_ != ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 10;
+      cfg_.rc_end_usage = VPX_VBR;
+    } else {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+    }
+    cfg_.rc_target_bitrate = 400;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP9E_SET_FRAME_PARALLEL_DECODING,
+                       frame_parallel_decoding_mode_);
+      if (encoding_mode_ != ::libvpx_test::kRealTime) {
+        encoder->Control(VP8E_SET_CPUUSED, 4);
+        encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+      } else {
+        // Cyclic refresh uses the segmentation map on every frame.
+        encoder->Control(VP8E_SET_CPUUSED, 5);
+        encoder->Control(VP9E_SET_AQ_MODE, 3);
+      }
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  void Encode() {
+    ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                         352, 288, 30, 1, 0, kFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  }
+
+  // Decodes the encoded packets, returning the md5 of the output frames.
+  std::string Decode(int threads, vpx_codec_flags_t flags, int *frames) {
+    vpx_codec_ctx_t decoder;
+    vpx_codec_dec_cfg_t cfg = {0};
+    ::libvpx_test::MD5 md5;
+
+    cfg.threads = threads;
+    *frames = 0;
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&decoder, vpx_codec_vp9_dx(),
+                                               &cfg, flags));
+    for (size_t i = 0; i <= packets_.size(); ++i) {
+      // In frame parallel mode, a final call without data flushes the
+      // decoder.
+      if (i < packets_.size()) {
+        const unsigned int size = static_cast<unsigned int>(packets_[i].size());
+        EXPECT_EQ(VPX_CODEC_OK,
+                  vpx_codec_decode(&decoder, &packets_[i][0], size, NULL, 0))
+            << vpx_codec_error_detail(&decoder);
+      } else if (flags & VPX_CODEC_USE_FRAME_THREADING) {
+        EXPECT_EQ(VPX_CODEC_OK, vpx_codec_decode(&decoder, NULL, 0, NULL, 0));
+      }
+
+      vpx_codec_iter_t iter = NULL;
+      const vpx_image_t *img;
+      while ((img = vpx_codec_get_frame(&decoder, &iter)) != NULL) {
+        md5.Add(img);
+        ++*frames;
+      }
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&decoder));
+    return md5.Get();
+  }
+
+  ::libvpx_test::TestMode encoding_mode_;
+  int frame_parallel_decoding_mode_;
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+// Frame parallel decoding must produce the same frames as serial decoding,
+// whether or not the stream uses backward adaptation.
+TEST_P(VP9FrameParallelTest, DecoderResultMatch) {
+  int frames;
+  Encode();
+  const std::string serial_md5 = Decode(1, 0, &frames);
+  ASSERT_EQ(kFrames, frames);
+
+  for (int threads = 2; threads <= 4; ++threads) {
+    const std::string frame_parallel_md5 =
+        Decode(threads, VPX_CODEC_USE_FRAME_THREADING, &frames);
+    EXPECT_EQ(kFrames, frames) << "threads: " << threads;
+    EXPECT_EQ(serial_md5, frame_parallel_md5) << "threads: " << threads;
+  }
+}
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9FrameParallelTest,
+    ::testing::Values(::libvpx_test::kTwoPassGood, ::libvpx_test::kRealTime),
+    ::testing::Values(0, 1));
+}  // namespace
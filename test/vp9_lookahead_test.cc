@@ -0,0 +1,198 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/util.h"
+#include "./vpx_config.h"
+#include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_extend.h"
+#include "vp9/encoder/vp9_lookahead.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_scale/yv12config.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+// Not a multiple of 16, so that the last macroblocks are partial.
+const int kWidth = 167;
+const int kHeight = 93;
+const int kMbCols = (kWidth + 15) >> 4;
+const int kMbRows = (kHeight + 15) >> 4;
+const int kStride = kMbCols * 16;
+const int kDepth = 3;
+const int kFrames = 20;
+// The least any plane is extended by, in luma pixels.
+const int kMinExtension = 16;
+
+// <chroma subsampling x, chroma subsampling y>
+typedef std::tr1::tuple<int, int> subsampling_t;
+
+class VP9LookaheadTest : public ::testing::TestWithParam<subsampling_t> {
+ protected:
+  virtual void SetUp() {
+    ss_x_ = GET_PARAM(0);
+    ss_y_ = GET_PARAM(1);
+    rnd_.Reset(ACMRandom::DeterministicSeed());
+    // Full size chroma planes have room for any subsampling.
+    for (int plane = 0; plane < 3; ++plane)
+      planes_[plane].assign(kStride * kHeight, 0);
+
+    // Describe the image the way the encoder interface does.
+    memset(&src_, 0, sizeof(src_));
+    src_.y_width = src_.y_crop_width = kWidth;
+    src_.y_height = src_.y_crop_height = kHeight;
+    src_.uv_width = src_.uv_crop_width = (kWidth + ss_x_) >> ss_x_;
+    src_.uv_height = src_.uv_crop_height = (kHeight + ss_y_) >> ss_y_;
+    src_.y_stride = kStride;
+    src_.uv_stride = kStride;
+    src_.y_buffer = &planes_[0][0];
+    src_.u_buffer = &planes_[1][0];
+    src_.v_buffer = &planes_[2][0];
+#if CONFIG_ALPHA
+    src_.alpha_width = kWidth;
+    src_.alpha_height = kHeight;
+    src_.alpha_stride = kStride;
+    src_.alpha_buffer = &planes_[0][0];
+#endif
+
+    memset(&ref_, 0, sizeof(ref_));
+    ASSERT_EQ(0, vp9_alloc_frame_buffer(&ref_, kWidth, kHeight, ss_x_, ss_y_,
+                                        VP9_ENC_BORDER_IN_PIXELS));
+    lookahead_ = vp9_lookahead_init(kWidth, kHeight, ss_x_, ss_y_, kDepth);
+    ASSERT_TRUE(lookahead_ != NULL);
+  }
+
+  virtual void TearDown() {
+    vp9_lookahead_destroy(lookahead_);
+    vp9_free_frame_buffer(&ref_);
+  }
+
+  // Writes random pixels to the part of each plane under the macroblock.
+  void ChangeMacroblock(int mb_row, int mb_col) {
+    for (int plane = 0; plane < 3; ++plane) {
+      const int sx = plane ? ss_x_ : 0;
+      const int sy = plane ? ss_y_ : 0;
+      const int w = (kWidth + sx) >> sx;
+      const int h = (kHeight + sy) >> sy;
+      for (int y = (mb_row * 16) >> sy; y < ((mb_row + 1) * 16) >> sy; ++y) {
+        for (int x = (mb_col * 16) >> sx; x < ((mb_col + 1) * 16) >> sx;
+             ++x) {
+          if (x < w && y < h)
+            planes_[plane][y * kStride + x] = rnd_.Rand8();
+        }
+      }
+    }
+  }
+
+  void CheckPlane(const uint8_t *buf, int stride, const uint8_t *ref_buf,
+                  int ref_stride, int w, int h, int ext_x, int ext_y) {
+    for (int y = -ext_y; y < h + ext_y; ++y) {
+      for (int x = -ext_x; x < w + ext_x; ++x) {
+        ASSERT_EQ(ref_buf[y * ref_stride + x], buf[y * stride + x])
+            << "x = " << x << ", y = " << y;
+      }
+    }
+  }
+
+  // Checks the newest frame in the queue against a full copy of the source,
+  // in the image and the part of the border a full copy extends into.
+  void CheckNewestFrame() {
+    const struct lookahead_entry *const entry =
+        vp9_lookahead_peek(lookahead_, vp9_lookahead_depth(lookahead_) - 1);
+    ASSERT_TRUE(entry != NULL);
+    vp9_copy_and_extend_frame(&src_, &ref_);
+
+    CheckPlane(entry->img.y_buffer, entry->img.y_stride, ref_.y_buffer,
+               ref_.y_stride, src_.y_width, src_.y_height,
+               kMinExtension, kMinExtension);
+    CheckPlane(entry->img.u_buffer, entry->img.uv_stride, ref_.u_buffer,
+               ref_.uv_stride, src_.uv_width, src_.uv_height,
+               kMinExtension >> ss_x_, kMinExtension >> ss_y_);
+    CheckPlane(entry->img.v_buffer, entry->img.uv_stride, ref_.v_buffer,
+               ref_.uv_stride, src_.uv_width, src_.uv_height,
+               kMinExtension >> ss_x_, kMinExtension >> ss_y_);
+  }
+
+  void Push(const unsigned char *active_map, int64_t pts,
+            unsigned int flags = 0) {
+    ASSERT_EQ(0, vp9_lookahead_push(lookahead_, &src_, pts, pts + 1, flags,
+                                    active_map, NULL, NULL));
+    CheckNewestFrame();
+    // Make room for the next frame, as the encoder would.
+    vp9_lookahead_pop(lookahead_, 0);
+  }
+
+  int ss_x_;
+  int ss_y_;
+  ACMRandom rnd_;
+  std::vector<uint8_t> planes_[3];
+  YV12_BUFFER_CONFIG src_;
+  YV12_BUFFER_CONFIG ref_;
+  struct lookahead_ctx *lookahead_;
+};
+
+TEST_P(VP9LookaheadTest, ActiveMapCopiesChanges) {
+  std::vector<unsigned char> active_map(kMbRows * kMbCols);
+
+  for (int mb_row = 0; mb_row < kMbRows; ++mb_row) {
+    for (int mb_col = 0; mb_col < kMbCols; ++mb_col)
+      ChangeMacroblock(mb_row, mb_col);
+  }
+  Push(NULL, 0);
+
+  for (int frame = 1; frame < kFrames; ++frame) {
+    // Change a few macroblocks, favoring the edges of the frame, and now and
+    // then push without a map.
+    for (int i = 0; i < kMbRows * kMbCols; ++i)
+      active_map[i] = rnd_(8) == 0;
+    for (int i = 0; i < 2; ++i) {
+      active_map[rnd_(kMbCols)] = 1;
+      active_map[(kMbRows - 1) * kMbCols + rnd_(kMbCols)] = 1;
+      active_map[rnd_(kMbRows) * kMbCols] = 1;
+      active_map[rnd_(kMbRows) * kMbCols + kMbCols - 1] = 1;
+    }
+    for (int mb_row = 0; mb_row < kMbRows; ++mb_row) {
+      for (int mb_col = 0; mb_col < kMbCols; ++mb_col) {
+        if (active_map[mb_row * kMbCols + mb_col])
+          ChangeMacroblock(mb_row, mb_col);
+      }
+    }
+    Push(frame % 7 ? &active_map[0] : NULL, frame);
+    if (HasFatalFailure())
+      return;
+  }
+}
+
+// Key frames are copied whole, even where the active map says nothing
+// changed.
+TEST_P(VP9LookaheadTest, KeyFramesIgnoreActiveMap) {
+  const std::vector<unsigned char> active_map(kMbRows * kMbCols, 0);
+
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int i = 0; i < 4; ++i)
+      ChangeMacroblock(rnd_(kMbRows), rnd_(kMbCols));
+    Push(&active_map[0], frame, FRAMEFLAGS_KEY);
+    if (HasFatalFailure())
+      return;
+  }
+}
+
+using std::tr1::make_tuple;
+
+INSTANTIATE_TEST_CASE_P(VP9, VP9LookaheadTest,
+                        ::testing::Values(make_tuple(1, 1), make_tuple(1, 0),
+                                          make_tuple(0, 0)));
+}  // namespace
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/i420_video_source.h"
+#include "test/video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kFrames = 10;
+// Enough frames of RandomVideoSource for the first alt-ref to go out.
+const int kNoiseFrames = 30;
+const unsigned int kPadBefore = 7;
+const unsigned int kPadAfter = 5;
+const unsigned char kPadValue = 0xa5;
+
+// Big enough for every call to encode into it directly, even for frames
+// bigger than the uncompressed image.
+const size_t kLargeBufferSize = kWidth * kHeight * 3 / 2 * 8;
+// Too small to hold a worst case frame, so the encoder uses its own buffer.
+const size_t kSmallBufferSize = 64 * 1024;
+
+class VP9OutputBufferTest : public ::testing::TestWithParam<int> {
+ protected:
+  VP9OutputBufferTest() : lossless_(false) {}
+
+  void InitEncoder(vpx_codec_ctx_t *encoder) {
+    vpx_codec_enc_cfg_t cfg;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+    cfg.g_w = kWidth;
+    cfg.g_h = kHeight;
+    cfg.g_lag_in_frames = GetParam();
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(encoder, &vpx_codec_vp9_cx_algo, &cfg, 0));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(encoder, VP8E_SET_CPUUSED, 4));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder, VP8E_SET_ENABLEAUTOALTREF, 1));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder, VP9E_SET_LOSSLESS, lossless_));
+  }
+
+  // Hands the encoder the start of buffer_, filled with kPadValue.
+  void ResetOutputBuffer(vpx_codec_ctx_t *encoder) {
+    vpx_fixed_buf_t buf;
+    memset(&buffer_[0], kPadValue, buffer_.size());
+    buf.buf = &buffer_[0];
+    buf.sz = buffer_.size();
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_set_cx_data_buf(encoder, &buf, kPadBefore, kPadAfter));
+  }
+
+  // Appends the compressed frames to out and returns whether there were any.
+  bool GetOutput(vpx_codec_ctx_t *encoder, std::string *out) {
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    const char *expected_buf = buffer_.empty() ? NULL : &buffer_[0];
+    bool got_data = false;
+
+    while ((pkt = vpx_codec_get_cx_data(encoder, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT)
+        continue;
+      const char *data = static_cast<const char *>(pkt->data.frame.buf);
+      size_t sz = pkt->data.frame.sz;
+      got_data = true;
+      if (!buffer_.empty()) {
+        // Either way, packets follow one another in the application's
+        // buffer with their padding intact.
+        EXPECT_EQ(expected_buf, data);
+        EXPECT_GT(sz, kPadBefore + kPadAfter);
+        if (data != expected_buf || sz <= kPadBefore + kPadAfter)
+          return false;
+        for (unsigned int i = 0; i < kPadBefore; ++i)
+          EXPECT_EQ(kPadValue, static_cast<unsigned char>(data[i]));
+        for (unsigned int i = 0; i < kPadAfter; ++i)
+          EXPECT_EQ(kPadValue, static_cast<unsigned char>(data[sz - 1 - i]));
+        expected_buf += sz;
+        data += kPadBefore;
+        sz -= kPadBefore + kPadAfter;
+      }
+      out->append(data, sz);
+    }
+    return got_data;
+  }
+
+  std::string Encode(size_t buffer_size) {
+    libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                       kWidth, kHeight, 30, 1, 0, kFrames);
+    return EncodeSource(&video, buffer_size);
+  }
+
+  std::string EncodeSource(libvpx_test::VideoSource *video,
+                           size_t buffer_size) {
+    vpx_codec_ctx_t encoder;
+    std::string out;
+
+    buffer_.resize(buffer_size);
+    InitEncoder(&encoder);
+
+    for (video->Begin(); video->img() != NULL; video->Next()) {
+      if (!buffer_.empty())
+        ResetOutputBuffer(&encoder);
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&encoder, video->img(),
+                                               video->pts(), 1, 0,
+                                               VPX_DL_GOOD_QUALITY))
+          << vpx_codec_error_detail(&encoder);
+      GetOutput(&encoder, &out);
+    }
+
+    bool got_data;
+    do {
+      if (!buffer_.empty())
+        ResetOutputBuffer(&encoder);
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&encoder, NULL, 0, 0, 0,
+                                               VPX_DL_GOOD_QUALITY));
+      got_data = GetOutput(&encoder, &out);
+    } while (got_data);
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&encoder));
+    return out;
+  }
+
+  bool lossless_;
+  std::vector<char> buffer_;
+};
+
+TEST_P(VP9OutputBufferTest, LargeBufferMatchesInternalBuffer) {
+  const std::string internal = Encode(0);
+  const std::string external = Encode(kLargeBufferSize);
+
+  ASSERT_FALSE(internal.empty());
+  EXPECT_TRUE(internal == external) << "Output differs with caller's buffer";
+}
+
+TEST_P(VP9OutputBufferTest, SmallBufferMatchesInternalBuffer) {
+  const std::string internal = Encode(0);
+  const std::string external = Encode(kSmallBufferSize);
+
+  ASSERT_FALSE(internal.empty());
+  EXPECT_TRUE(internal == external) << "Output differs with caller's buffer";
+}
+
+// Lossless frames of noise come out bigger than the uncompressed image, and
+// alt-refs wait in the buffer for the frame after them.
+TEST_P(VP9OutputBufferTest, LosslessNoiseMatchesInternalBuffer) {
+  libvpx_test::RandomVideoSource video;
+  video.SetSize(kWidth, kHeight);
+  video.set_limit(kNoiseFrames);
+  lossless_ = true;
+  const std::string internal = EncodeSource(&video, 0);
+  const std::string external = EncodeSource(&video, kLargeBufferSize);
+
+  ASSERT_GT(internal.size(), static_cast<size_t>(kWidth * kHeight));
+  EXPECT_TRUE(internal == external) << "Output differs with caller's buffer";
+}
+
+// Lag in frames: none, and enough for alt-refs, which go out in superframes.
+INSTANTIATE_TEST_CASE_P(VP9, VP9OutputBufferTest, ::testing::Values(0, 25));
+}  // namespace
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+
+namespace {
+
+const int kFrames = 10;
+
+class VP9PutSliceTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9PutSliceTest()
+      : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)), rows_(0),
+        slices_(0) {}
+  virtual ~VP9PutSliceTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = 400;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP8E_SET_CPUUSED, 5);
+      // Lets the decoder filter frames wide enough for two tile columns on
+      // the tile threads.
+      encoder->Control(VP9E_SET_TILE_COLUMNS, 1);
+      encoder->Control(VP9E_SET_FRAME_PARALLEL_DECODING, 1);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  static void PutSlice(void *user_priv, const vpx_image_t *img,
+                       const vpx_image_rect_t *valid,
+                       const vpx_image_rect_t *update) {
+    static_cast<VP9PutSliceTest *>(user_priv)->OnSlice(*img, *valid, *update);
+  }
+
+  // Copies the new rows, so that they can be compared with the frame once it
+  // is decoded.
+  void OnSlice(const vpx_image_t &img, const vpx_image_rect_t &valid,
+               const vpx_image_rect_t &update) {
+    EXPECT_EQ(0u, valid.x);
+    EXPECT_EQ(0u, valid.y);
+    EXPECT_EQ(img.d_w, valid.w);
+    EXPECT_EQ(0u, update.x);
+    EXPECT_EQ(img.d_w, update.w);
+    EXPECT_EQ(rows_, update.y);
+    EXPECT_GT(update.h, 0u);
+    EXPECT_EQ(update.y + update.h, valid.h);
+    EXPECT_LE(valid.h, img.d_h);
+    if (planes_[0].empty()) {
+      for (int plane = 0; plane < 3; ++plane)
+        planes_[plane].resize(img.d_w * img.d_h);
+    }
+
+    for (int plane = 0; plane < 3; ++plane) {
+      const int ss_x = plane ? img.x_chroma_shift : 0;
+      const int ss_y = plane ? img.y_chroma_shift : 0;
+      const int w = (img.d_w + ss_x) >> ss_x;
+      for (unsigned int y = (update.y + ss_y) >> ss_y;
+           y < (valid.h + ss_y) >> ss_y; ++y)
+        memcpy(&planes_[plane][y * w], img.planes[plane] + y * img.stride[plane],
+               w);
+    }
+    rows_ = valid.h;
+    ++slices_;
+  }
+
+  void CheckFrame(const vpx_image_t &img) {
+    ASSERT_EQ(img.d_h, rows_) << "Frame not fully reported";
+    for (int plane = 0; plane < 3; ++plane) {
+      const int ss_x = plane ? img.x_chroma_shift : 0;
+      const int ss_y = plane ? img.y_chroma_shift : 0;
+      const int w = (img.d_w + ss_x) >> ss_x;
+      const int h = (img.d_h + ss_y) >> ss_y;
+      for (int y = 0; y < h; ++y) {
+        ASSERT_EQ(0, memcmp(&planes_[plane][y * w],
+                            img.planes[plane] + y * img.stride[plane], w))
+            << "Row " << y << " of plane " << plane
+            << " changed after it was reported";
+      }
+    }
+  }
+
+  // Decodes the encoded packets, checking each frame against its slices.
+  // Returns the number of frames.
+  int Decode() {
+    vpx_codec_ctx_t decoder;
+    vpx_codec_dec_cfg_t cfg = {0};
+    int frames = 0;
+
+    cfg.threads = threads_;
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&decoder, vpx_codec_vp9_dx(),
+                                               &cfg, 0));
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_register_put_slice_cb(&decoder, PutSlice, this));
+    for (size_t i = 0; i < packets_.size(); ++i) {
+      const unsigned int size = static_cast<unsigned int>(packets_[i].size());
+      rows_ = 0;
+      EXPECT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(&decoder, &packets_[i][0], size, NULL, 0))
+          << vpx_codec_error_detail(&decoder);
+
+      vpx_codec_iter_t iter = NULL;
+      const vpx_image_t *img;
+      while ((img = vpx_codec_get_frame(&decoder, &iter)) != NULL) {
+        CheckFrame(*img);
+        ++frames;
+      }
+    }
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&decoder));
+    return frames;
+  }
+
+  int threads_;
+  unsigned int rows_;
+  int slices_;
+  std::vector<uint8_t> planes_[3];
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+// The rows of each frame are handed out in order, in more than one slice,
+// and never change once they are.
+TEST_P(VP9PutSliceTest, SlicesMatchFrame) {
+  ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                       352, 288, 30, 1, 0, kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(kFrames, Decode());
+  EXPECT_GT(slices_, kFrames);
+}
+
+// As above, for frames with two tile columns, which the tile threads filter.
+TEST_P(VP9PutSliceTest, SlicesMatchFrameWithTiles) {
+  ::libvpx_test::RandomVideoSource video;
+  video.SetSize(640, 240);
+  video.set_limit(kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  EXPECT_EQ(kFrames, Decode());
+}
+
+VP9_INSTANTIATE_TEST_CASE(VP9PutSliceTest, ::testing::Values(1, 2, 4));
+}  // namespace
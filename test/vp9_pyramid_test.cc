@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/util.h"
+#include "vp9/encoder/vp9_lookahead.h"
+#include "vp9/encoder/vp9_pyramid.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_scale/yv12config.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+const int kMbCols = kWidth >> 4;
+const int kMbRows = kHeight >> 4;
+// Room around the frames in the canvas they are cut from.
+const int kMargin = 48;
+const int kCanvasWidth = kWidth + 2 * kMargin;
+const int kCanvasHeight = kHeight + 2 * kMargin;
+// Spacing of the random samples that the canvas interpolates.
+const int kGrid = 8;
+
+// <row, col> of the motion from the first frame to the second, in pixels
+typedef std::tr1::tuple<int, int> motion_t;
+
+class VP9PyramidTest : public ::testing::TestWithParam<motion_t> {
+ protected:
+  virtual void SetUp() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const int grid_cols = kCanvasWidth / kGrid + 1;
+    const int grid_rows = kCanvasHeight / kGrid + 1;
+    std::vector<int> grid(grid_rows * grid_cols);
+
+    // Like natural video, detail on top of shapes that are still there at
+    // the downscaled levels.
+    for (size_t i = 0; i < grid.size(); ++i)
+      grid[i] = rnd(224);
+    canvas_.resize(kCanvasWidth * kCanvasHeight);
+    for (int y = 0; y < kCanvasHeight; ++y) {
+      for (int x = 0; x < kCanvasWidth; ++x) {
+        const int *const g = &grid[(y / kGrid) * grid_cols + x / kGrid];
+        const int fy = y % kGrid;
+        const int fx = x % kGrid;
+        const int top = g[0] * (kGrid - fx) + g[1] * fx;
+        const int bottom = g[grid_cols] * (kGrid - fx) + g[grid_cols + 1] * fx;
+        canvas_[y * kCanvasWidth + x] =
+            (top * (kGrid - fy) + bottom * fy) / (kGrid * kGrid) + rnd(32);
+      }
+    }
+
+    planes_[0].assign(kWidth * kHeight, 0);
+    planes_[1].assign((kWidth >> 1) * (kHeight >> 1), 128);
+    memset(&src_, 0, sizeof(src_));
+    src_.y_width = src_.y_crop_width = kWidth;
+    src_.y_height = src_.y_crop_height = kHeight;
+    src_.uv_width = src_.uv_crop_width = kWidth >> 1;
+    src_.uv_height = src_.uv_crop_height = kHeight >> 1;
+    src_.y_stride = kWidth;
+    src_.uv_stride = kWidth >> 1;
+    src_.y_buffer = &planes_[0][0];
+    src_.u_buffer = &planes_[1][0];
+    src_.v_buffer = &planes_[1][0];
+
+    lookahead_ = vp9_lookahead_init(kWidth, kHeight, 1, 1, 1);
+    ASSERT_TRUE(lookahead_ != NULL);
+  }
+
+  virtual void TearDown() {
+    vp9_lookahead_destroy(lookahead_);
+  }
+
+  // Queues the part of the canvas at (row, col) from the margin, and returns
+  // its entry.
+  struct lookahead_entry *Push(int row, int col, int64_t pts) {
+    for (int y = 0; y < kHeight; ++y) {
+      memcpy(&planes_[0][y * kWidth],
+             &canvas_[(kMargin + row + y) * kCanvasWidth + kMargin + col],
+             kWidth);
+    }
+    EXPECT_EQ(0, vp9_lookahead_push(lookahead_, &src_, pts, pts + 1, 0,
+                                    NULL, NULL, NULL));
+    return vp9_lookahead_pop(lookahead_, 1);
+  }
+
+  std::vector<uint8_t> canvas_;
+  std::vector<uint8_t> planes_[2];
+  YV12_BUFFER_CONFIG src_;
+  struct lookahead_ctx *lookahead_;
+};
+
+TEST_P(VP9PyramidTest, FindsTranslation) {
+  const int row = GET_PARAM(0);
+  const int col = GET_PARAM(1);
+  struct lookahead_entry *const ref = Push(0, 0, 0);
+  ASSERT_TRUE(ref != NULL);
+  ASSERT_EQ(0, vp9_pyramid_build(ref));
+  // The second frame shows what the first showed at (row, col).
+  struct lookahead_entry *const src = Push(row, col, 1);
+  ASSERT_TRUE(src != NULL);
+  ASSERT_EQ(0, vp9_pyramid_build(src));
+
+  vp9_pyramid_motion_search(src, ref);
+  const PYRAMID *const pyr = &src->pyramid;
+  ASSERT_TRUE(pyr->mvs_valid);
+  ASSERT_EQ(kMbRows, pyr->mb_rows);
+  ASSERT_EQ(kMbCols, pyr->mb_cols);
+
+  // Macroblocks that move out of the frame match the extended border only.
+  for (int mb_row = 0; mb_row < kMbRows; ++mb_row) {
+    for (int mb_col = 0; mb_col < kMbCols; ++mb_col) {
+      const int y = mb_row * 16 + row;
+      const int x = mb_col * 16 + col;
+      if (y < 0 || y + 16 > kHeight || x < 0 || x + 16 > kWidth)
+        continue;
+      const MV *const mv = &pyr->mvs[mb_row * kMbCols + mb_col];
+      EXPECT_EQ(row * 8, mv->row) << "mb_row " << mb_row << " mb_col "
+                                  << mb_col;
+      EXPECT_EQ(col * 8, mv->col) << "mb_row " << mb_row << " mb_col "
+                                  << mb_col;
+    }
+  }
+}
+
+using std::tr1::make_tuple;
+
+INSTANTIATE_TEST_CASE_P(VP9, VP9PyramidTest,
+                        ::testing::Values(make_tuple(0, 0), make_tuple(4, -8),
+                                          make_tuple(13, -6),
+                                          make_tuple(-20, 28),
+                                          make_tuple(-31, 33)));
+}  // namespace
@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+#include "./vpx_config.h"
+#include "./vp9_rtcd.h"
+#include "vp9/common/vp9_quant_common.h"
+#include "vp9/common/vp9_scan.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+#include "vpx_ports/vpx_timer.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+typedef void (*quantize_fn_t)(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                              int skip_block, const int16_t *zbin_ptr,
+                              const int16_t *round_ptr,
+                              const int16_t *quant_ptr,
+                              const int16_t *quant_shift_ptr,
+                              int16_t *qcoeff_ptr, int16_t *dqcoeff_ptr,
+                              const int16_t *dequant_ptr, int zbin_oq_value,
+                              uint16_t *eob_ptr, const int16_t *scan,
+                              const int16_t *iscan);
+
+// <optimized function, reference function, transform size, fast path>
+typedef std::tr1::tuple<quantize_fn_t, quantize_fn_t, TX_SIZE, int>
+    quantize_param_t;
+
+const int kNumTests = 1000;
+
+class VP9QuantizeTest : public ::testing::TestWithParam<quantize_param_t> {
+ public:
+  virtual void SetUp() {
+    quantize_ = GET_PARAM(0);
+    ref_quantize_ = GET_PARAM(1);
+    tx_size_ = GET_PARAM(2);
+    fast_path_ = GET_PARAM(3);
+    n_coeffs_ = 16 << (2 * tx_size_);
+    rnd_.Reset(ACMRandom::DeterministicSeed());
+  }
+
+  virtual void TearDown() { libvpx_test::ClearSystemState(); }
+
+ protected:
+  // Sets up the quantizer tables the same way vp9_init_quantizer() does for
+  // the given qindex.
+  void InitQuantizer(int qindex) {
+    const int zbin_factor =
+        qindex == 0 ? 64 : (vp9_dc_quant(qindex, 0) < 148 ? 84 : 80);
+    const int round_factor = qindex == 0 ? 64 : 48;
+
+    for (int i = 0; i < 2; ++i) {
+      const int quant = i == 0 ? vp9_dc_quant(qindex, 0)
+                               : vp9_ac_quant(qindex, 0);
+      if (fast_path_) {
+        quant_[i] = (1 << 16) / quant;
+        quant_shift_[i] = 0;
+      } else {
+        unsigned int t = quant;
+        int l;
+        for (l = 0; t > 1; l++)
+          t >>= 1;
+        t = 1 + (1 << (16 + l)) / quant;
+        quant_[i] = static_cast<int16_t>(t - (1 << 16));
+        quant_shift_[i] = 1 << (16 - l);
+      }
+      zbin_[i] = ROUND_POWER_OF_TWO(zbin_factor * quant, 7);
+      round_[i] = (round_factor * quant) >> 7;
+      dequant_[i] = quant;
+    }
+  }
+
+  void Quantize(quantize_fn_t fn, int skip_block, int zbin_oq_value,
+                int16_t *qcoeff, int16_t *dqcoeff, uint16_t *eob) {
+    const scan_order *const so = &vp9_default_scan_orders[tx_size_];
+    fn(coeff_, n_coeffs_, skip_block, zbin_, round_, quant_, quant_shift_,
+       qcoeff, dqcoeff, dequant_, zbin_oq_value, eob, so->scan, so->iscan);
+  }
+
+  void CheckQuantize(int skip_block, int zbin_oq_value) {
+    uint16_t eob = 0, ref_eob = 0;
+
+    Quantize(ref_quantize_, skip_block, zbin_oq_value, ref_qcoeff_,
+             ref_dqcoeff_, &ref_eob);
+    REGISTER_STATE_CHECK(Quantize(quantize_, skip_block, zbin_oq_value,
+                                  qcoeff_, dqcoeff_, &eob));
+
+    ASSERT_EQ(ref_eob, eob);
+    for (int i = 0; i < n_coeffs_; ++i) {
+      ASSERT_EQ(ref_qcoeff_[i], qcoeff_[i]) << "i = " << i;
+      ASSERT_EQ(ref_dqcoeff_[i], dqcoeff_[i]) << "i = " << i;
+    }
+  }
+
+  quantize_fn_t quantize_;
+  quantize_fn_t ref_quantize_;
+  TX_SIZE tx_size_;
+  int fast_path_;
+  int n_coeffs_;
+  ACMRandom rnd_;
+
+  DECLARE_ALIGNED(16, int16_t, coeff_[1024]);
+  DECLARE_ALIGNED(16, int16_t, qcoeff_[1024]);
+  DECLARE_ALIGNED(16, int16_t, dqcoeff_[1024]);
+  DECLARE_ALIGNED(16, int16_t, ref_qcoeff_[1024]);
+  DECLARE_ALIGNED(16, int16_t, ref_dqcoeff_[1024]);
+  int16_t zbin_[2];
+  int16_t round_[2];
+  int16_t quant_[2];
+  int16_t quant_shift_[2];
+  int16_t dequant_[2];
+};
+
+TEST_P(VP9QuantizeTest, OperationCheck) {
+  for (int n = 0; n < kNumTests; ++n) {
+    InitQuantizer(rnd_(QINDEX_RANGE));
+    for (int i = 0; i < n_coeffs_; ++i)
+      coeff_[i] = static_cast<int16_t>(rnd_.Rand16());
+    CheckQuantize(rnd_(50) == 0, fast_path_ ? 0 : rnd_(32));
+  }
+}
+
+TEST_P(VP9QuantizeTest, EOBCheck) {
+  // Mostly zero blocks with a few large coefficients, so that the end of
+  // block falls anywhere in the scan.
+  for (int n = 0; n < kNumTests; ++n) {
+    InitQuantizer(rnd_(QINDEX_RANGE));
+    memset(coeff_, 0, sizeof(coeff_));
+    for (int i = 0; i < 2; ++i)
+      coeff_[rnd_(n_coeffs_)] = static_cast<int16_t>(rnd_(4096) - 2048);
+    CheckQuantize(0, fast_path_ ? 0 : rnd_(32));
+  }
+}
+
+TEST_P(VP9QuantizeTest, ExtremeValues) {
+  for (int n = 0; n < 100; ++n) {
+    InitQuantizer(rnd_(QINDEX_RANGE));
+    for (int i = 0; i < n_coeffs_; ++i)
+      coeff_[i] = rnd_(2) ? INT16_MAX : INT16_MIN;
+    CheckQuantize(0, 0);
+  }
+}
+
+// Perf test, run explicitly with --gtest_also_run_disabled_tests.
+TEST_P(VP9QuantizeTest, DISABLED_Speed) {
+  const int kNumIterations = 1000000 >> (2 * tx_size_);
+  vpx_usec_timer timer, ref_timer;
+  uint16_t eob;
+
+  InitQuantizer(100);
+  for (int i = 0; i < n_coeffs_; ++i)
+    coeff_[i] = static_cast<int16_t>(rnd_(1024) - 512);
+
+  vpx_usec_timer_start(&ref_timer);
+  for (int n = 0; n < kNumIterations; ++n)
+    Quantize(ref_quantize_, 0, 0, ref_qcoeff_, ref_dqcoeff_, &eob);
+  vpx_usec_timer_mark(&ref_timer);
+
+  vpx_usec_timer_start(&timer);
+  for (int n = 0; n < kNumIterations; ++n)
+    Quantize(quantize_, 0, 0, qcoeff_, dqcoeff_, &eob);
+  vpx_usec_timer_mark(&timer);
+
+  printf("%d coefficients%s: reference %d us, optimized %d us\n", n_coeffs_,
+         fast_path_ ? " (fast path)" : "",
+         static_cast<int>(vpx_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(vpx_usec_timer_elapsed(&timer)));
+}
+
+using std::tr1::make_tuple;
+
+INSTANTIATE_TEST_CASE_P(
+    C, VP9QuantizeTest,
+    ::testing::Values(
+        make_tuple(&vp9_quantize_b_c, &vp9_quantize_b_c, TX_4X4, 0),
+        make_tuple(&vp9_quantize_b_32x32_c, &vp9_quantize_b_32x32_c,
+                   TX_32X32, 0),
+        make_tuple(&vp9_quantize_fp_c, &vp9_quantize_fp_c, TX_16X16, 1),
+        make_tuple(&vp9_quantize_fp_32x32_c, &vp9_quantize_fp_32x32_c,
+                   TX_32X32, 1)));
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, VP9QuantizeTest,
+    ::testing::Values(
+        make_tuple(&vp9_quantize_b_avx2, &vp9_quantize_b_c, TX_4X4, 0),
+        make_tuple(&vp9_quantize_b_avx2, &vp9_quantize_b_c, TX_8X8, 0),
+        make_tuple(&vp9_quantize_b_avx2, &vp9_quantize_b_c, TX_16X16, 0),
+        make_tuple(&vp9_quantize_b_32x32_avx2, &vp9_quantize_b_32x32_c,
+                   TX_32X32, 0),
+        make_tuple(&vp9_quantize_fp_avx2, &vp9_quantize_fp_c, TX_4X4, 1),
+        make_tuple(&vp9_quantize_fp_avx2, &vp9_quantize_fp_c, TX_8X8, 1),
+        make_tuple(&vp9_quantize_fp_avx2, &vp9_quantize_fp_c, TX_16X16, 1),
+        make_tuple(&vp9_quantize_fp_32x32_avx2, &vp9_quantize_fp_32x32_c,
+                   TX_32X32, 1)));
+#endif
+}  // namespace
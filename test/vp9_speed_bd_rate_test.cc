@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+#include "vpx/vp8cx.h"
+#include "vpx_ports/vpx_timer.h"
+#include "./vpx_version.h"
+
+namespace {
+
+const double kUsecsInSec = 1000000.0;
+const int kFrames = 30;
+const int kFramerate = 30;
+const int kRatePoints = 4;
+const unsigned int kBitrates[kRatePoints] = { 200, 400, 800, 1600 };
+const int kReferenceSpeed = 2;
+
+struct RatePoint {
+  double kbps;
+  double psnr;
+  double secs;
+};
+
+// Returns the integral over [lo, hi] of the cubic through the four points.
+double IntegrateCubic(const double *x, const double *y, double lo, double hi) {
+  // Solves the Vandermonde system for the coefficients of the cubic.
+  double m[4][5];
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j)
+      m[i][j] = pow(x[i], j);
+    m[i][4] = y[i];
+  }
+  for (int col = 0; col < 4; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < 4; ++row) {
+      if (fabs(m[row][col]) > fabs(m[pivot][col]))
+        pivot = row;
+    }
+    for (int j = 0; j < 5; ++j) {
+      const double tmp = m[col][j];
+      m[col][j] = m[pivot][j];
+      m[pivot][j] = tmp;
+    }
+    for (int row = 0; row < 4; ++row) {
+      if (row != col) {
+        const double f = m[row][col] / m[col][col];
+        for (int j = col; j < 5; ++j)
+          m[row][j] -= f * m[col][j];
+      }
+    }
+  }
+
+  double integral = 0;
+  for (int j = 0; j < 4; ++j) {
+    const double c = m[j][4] / m[j][j];
+    integral += c * (pow(hi, j + 1) - pow(lo, j + 1)) / (j + 1);
+  }
+  return integral;
+}
+
+// Returns the Bjontegaard rate difference of the test curve against the
+// reference curve, in percent: the average change in bitrate at the same
+// PSNR, over the PSNR range both curves cover.
+double BdRate(const RatePoint *ref, const RatePoint *test) {
+  double ref_psnr[kRatePoints], ref_log_rate[kRatePoints];
+  double test_psnr[kRatePoints], test_log_rate[kRatePoints];
+
+  for (int i = 0; i < kRatePoints; ++i) {
+    ref_psnr[i] = ref[i].psnr;
+    ref_log_rate[i] = log(ref[i].kbps);
+    test_psnr[i] = test[i].psnr;
+    test_log_rate[i] = log(test[i].kbps);
+  }
+  const double lo =
+      std::max(std::min(ref_psnr[0], ref_psnr[kRatePoints - 1]),
+               std::min(test_psnr[0], test_psnr[kRatePoints - 1]));
+  const double hi =
+      std::min(std::max(ref_psnr[0], ref_psnr[kRatePoints - 1]),
+               std::max(test_psnr[0], test_psnr[kRatePoints - 1]));
+  if (hi <= lo)
+    return 0;
+
+  const double ref_int = IntegrateCubic(ref_psnr, ref_log_rate, lo, hi);
+  const double test_int = IntegrateCubic(test_psnr, test_log_rate, lo, hi);
+  return (exp((test_int - ref_int) / (hi - lo)) - 1) * 100;
+}
+
+/*
+ Encodes the same clip at a ladder of bitrates with each real-time speed, and
+ reports the encode time of each speed with its BD-rate against the reference
+ speed. Like the other perf tests, it *DOES NOT* check the results.
+ */
+class VP9SpeedBdRateTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9SpeedBdRateTest() : EncoderTest(GET_PARAM(0)), speed_(0), bits_(0),
+                         psnr_(0), frames_(0) {}
+  virtual ~VP9SpeedBdRateTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = VPX_CBR;
+    init_flags_ = VPX_CODEC_USE_PSNR;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    bits_ = 0;
+    psnr_ = 0;
+    frames_ = 0;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1)
+      encoder->Control(VP8E_SET_CPUUSED, speed_);
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    bits_ += pkt->data.frame.sz * 8;
+  }
+
+  virtual void PSNRPktHook(const vpx_codec_cx_pkt_t *pkt) {
+    psnr_ += pkt->data.psnr.psnr[0];
+    ++frames_;
+  }
+
+  void EncodeLadder(int speed, RatePoint *points) {
+    speed_ = speed;
+    for (int i = 0; i < kRatePoints; ++i) {
+      ::libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                           352, 288, kFramerate, 1, 0,
+                                           kFrames);
+      vpx_usec_timer t;
+      cfg_.rc_target_bitrate = kBitrates[i];
+      vpx_usec_timer_start(&t);
+      ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+      vpx_usec_timer_mark(&t);
+      points[i].kbps = bits_ * kFramerate / 1000.0 / kFrames;
+      points[i].psnr = psnr_ / frames_;
+      points[i].secs = double(vpx_usec_timer_elapsed(&t)) / kUsecsInSec;
+    }
+  }
+
+  int speed_;
+  size_t bits_;
+  double psnr_;
+  int frames_;
+};
+
+TEST_P(VP9SpeedBdRateTest, PerfTest) {
+  const int speed = GET_PARAM(1);
+  RatePoint ref[kRatePoints];
+  RatePoint test[kRatePoints];
+  double ref_secs = 0, test_secs = 0;
+
+  ASSERT_NO_FATAL_FAILURE(EncodeLadder(kReferenceSpeed, ref));
+  ASSERT_NO_FATAL_FAILURE(EncodeLadder(speed, test));
+  for (int i = 0; i < kRatePoints; ++i) {
+    ref_secs += ref[i].secs;
+    test_secs += test[i].secs;
+  }
+
+  printf("{\n");
+  printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+  printf("\t\"videoName\" : \"hantro_collage_w352h288.yuv\",\n");
+  printf("\t\"referenceSpeed\" : %d,\n", kReferenceSpeed);
+  printf("\t\"speed\" : %d,\n", speed);
+  printf("\t\"encodeTimeSecs\" : %f,\n", test_secs);
+  printf("\t\"speedup\" : %f,\n", ref_secs / test_secs);
+  printf("\t\"bdRatePercent\" : %f\n", BdRate(ref, test));
+  printf("}\n");
+}
+
+VP9_INSTANTIATE_TEST_CASE(VP9SpeedBdRateTest, ::testing::Values(3, 4, 5));
+}  // namespace
@@ -9,6 +9,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "third_party/googletest/src/include/gtest/gtest.h"
 #include "./vpx_config.h"
@@ -18,7 +19,8 @@
 #if CONFIG_WEBM_IO
 #include "test/webm_video_source.h"
 #endif
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
+#include "vpx/vp8dx.h"
 
 namespace {
 
@@ -97,6 +99,98 @@ TEST_P(VP9WorkerThreadTest, HookFailure) {
   EXPECT_FALSE(worker_.had_error);
 }
 
+// -----------------------------------------------------------------------------
+// Worker pool tests
+
+const int kNumPooledWorkers = 16;
+
+class VP9WorkerPoolTest : public ::testing::TestWithParam<int> {
+ protected:
+  virtual void SetUp() {
+    pool_ = vp9_worker_pool_create(GetParam());
+    ASSERT_TRUE(pool_ != NULL);
+    for (int i = 0; i < kNumPooledWorkers; ++i) {
+      vp9_worker_init(&workers_[i]);
+      workers_[i].pool = pool_;
+    }
+  }
+
+  virtual void TearDown() {
+    for (int i = 0; i < kNumPooledWorkers; ++i)
+      vp9_worker_end(&workers_[i]);
+    vp9_worker_pool_destroy(pool_);
+  }
+
+  VP9WorkerPool *pool_;
+  VP9Worker workers_[kNumPooledWorkers];
+};
+
+int CountHook(void* data, void* return_value) {
+  ++*reinterpret_cast<int*>(data);
+  return *reinterpret_cast<int*>(return_value);
+}
+
+TEST_P(VP9WorkerPoolTest, RunsJobsOfAllWorkers) {
+  int counts[kNumPooledWorkers] = { 0 };
+  int return_values[kNumPooledWorkers];
+
+  for (int i = 0; i < kNumPooledWorkers; ++i) {
+    EXPECT_NE(vp9_worker_reset(&workers_[i]), 0);
+    return_values[i] = i % 3 != 0;
+    workers_[i].hook = CountHook;
+    workers_[i].data1 = &counts[i];
+    workers_[i].data2 = &return_values[i];
+  }
+
+  for (int round = 1; round <= 3; ++round) {
+    // More jobs than threads, so that some wait in the queue.
+    for (int i = 0; i < kNumPooledWorkers; ++i)
+      vp9_worker_launch(&workers_[i]);
+    for (int i = 0; i < kNumPooledWorkers; ++i) {
+      EXPECT_EQ(return_values[i], vp9_worker_sync(&workers_[i]));
+      EXPECT_EQ(round, counts[i]);
+    }
+  }
+}
+
+#if CONFIG_MULTITHREAD
+int WaitHook(void* data, void*) {
+  volatile int* const go = reinterpret_cast<volatile int*>(data);
+  while (!*go) {}
+  return 1;
+}
+
+// Syncing a worker whose job is still queued runs the job on the calling
+// thread, so that it does not wait behind the jobs of other workers.
+TEST_P(VP9WorkerPoolTest, SyncRunsQueuedJob) {
+  volatile int go = 0;
+  int count = 0;
+  int return_value = 1;
+
+  // Keep every thread of the pool busy until the queued job is done.
+  for (int i = 0; i < GetParam(); ++i) {
+    EXPECT_NE(vp9_worker_reset(&workers_[i]), 0);
+    workers_[i].hook = WaitHook;
+    workers_[i].data1 = const_cast<int*>(&go);
+    vp9_worker_launch(&workers_[i]);
+  }
+  VP9Worker* const queued = &workers_[GetParam()];
+  EXPECT_NE(vp9_worker_reset(queued), 0);
+  queued->hook = CountHook;
+  queued->data1 = &count;
+  queued->data2 = &return_value;
+  vp9_worker_launch(queued);
+  EXPECT_NE(vp9_worker_sync(queued), 0);
+  EXPECT_EQ(1, count);
+
+  go = 1;
+  for (int i = 0; i < GetParam(); ++i)
+    EXPECT_NE(vp9_worker_sync(&workers_[i]), 0);
+}
+#endif  // CONFIG_MULTITHREAD
+
+INSTANTIATE_TEST_CASE_P(VP9, VP9WorkerPoolTest, ::testing::Values(1, 2, 4));
+
 // -----------------------------------------------------------------------------
 // Multi-threaded decode tests
 
@@ -130,6 +224,53 @@ string DecodeFile(const string& filename, int num_threads) {
   return string(md5.Get());
 }
 
+// Decodes |filename| with |num_decoders| decoders of |num_threads| each, in
+// lockstep, on a pool of |pool_threads| threads. Returns the md5 of the frames
+// of each decoder.
+std::vector<string> DecodeFileWithPool(const string& filename,
+                                       int num_decoders, int num_threads,
+                                       int pool_threads) {
+  vp9d_worker_pool_t *const pool = vp9d_worker_pool_create(pool_threads);
+  std::vector<libvpx_test::WebMVideoSource *> videos;
+  std::vector<libvpx_test::VP9Decoder *> decoders;
+  std::vector<libvpx_test::MD5> md5s(num_decoders);
+  vpx_codec_dec_cfg_t cfg = {0};
+  cfg.threads = num_threads;
+
+  EXPECT_TRUE(pool != NULL);
+  for (int i = 0; i < num_decoders; ++i) {
+    videos.push_back(new libvpx_test::WebMVideoSource(filename));
+    videos[i]->Init();
+    videos[i]->Begin();
+    decoders.push_back(new libvpx_test::VP9Decoder(cfg, 0));
+    decoders[i]->Control(VP9D_SET_WORKER_POOL, pool);
+  }
+
+  while (videos[0]->cxdata() != NULL) {
+    for (int i = 0; i < num_decoders; ++i) {
+      const vpx_codec_err_t res =
+          decoders[i]->DecodeFrame(videos[i]->cxdata(),
+                                   videos[i]->frame_size());
+      EXPECT_EQ(VPX_CODEC_OK, res) << decoders[i]->DecodeError();
+
+      libvpx_test::DxDataIterator dec_iter = decoders[i]->GetDxData();
+      const vpx_image_t *img = NULL;
+      while ((img = dec_iter.Next()))
+        md5s[i].Add(img);
+      videos[i]->Next();
+    }
+  }
+
+  std::vector<string> results;
+  for (int i = 0; i < num_decoders; ++i) {
+    results.push_back(md5s[i].Get());
+    delete decoders[i];
+    delete videos[i];
+  }
+  vp9d_worker_pool_destroy(pool);
+  return results;
+}
+
 TEST(VP9DecodeMTTest, MTDecode) {
   // no tiles or frame parallel; this exercises loop filter threading.
   EXPECT_STREQ("b35a1b707b28e82be025d960aba039bc",
@@ -216,6 +357,19 @@ TEST(VP9DecodeMTTest, MTDecode3) {
     }
   }
 }
+
+// Several decoders sharing fewer threads than they would each create.
+TEST(VP9DecodeMTTest, MTDecodeWithPool) {
+  static const char kFile[] = "vp90-2-08-tile_1x4_frame_parallel.webm";
+  static const char kExpectedMd5[] = "368ebc6ebf3a5e478d85b2c3149b2848";
+
+  for (int pool_threads = 1; pool_threads <= 3; ++pool_threads) {
+    const std::vector<string> md5s =
+        DecodeFileWithPool(kFile, 3, 4, pool_threads);
+    for (size_t i = 0; i < md5s.size(); ++i)
+      EXPECT_EQ(kExpectedMd5, md5s[i]) << "pool threads = " << pool_threads;
+  }
+}
 #endif  // CONFIG_WEBM_IO
 
 INSTANTIATE_TEST_CASE_P(Synchronous, VP9WorkerThreadTest, ::testing::Bool());
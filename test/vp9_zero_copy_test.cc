@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <set>
+#include <string>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/i420_video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+namespace {
+
+// Not a multiple of 8, so that the encoder pads the referenced images.
+const int kWidth = 351;
+const int kHeight = 287;
+const int kFrames = 10;
+
+class VP9ZeroCopyInputTest : public ::testing::TestWithParam<int> {
+ protected:
+  VP9ZeroCopyInputTest() : released_(0) {}
+
+  static void ReleaseInput(void *cb_priv, void *user_priv) {
+    VP9ZeroCopyInputTest *const test =
+        static_cast<VP9ZeroCopyInputTest *>(cb_priv);
+    vpx_image_t *const img = static_cast<vpx_image_t *>(user_priv);
+
+    EXPECT_EQ(1u, test->retained_.erase(img)) << "Released twice";
+    // Wipe the image, so that any later use changes the output.
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? 1 : 0;
+      for (int y = 0; y < (kHeight + shift) >> shift; ++y)
+        memset(img->planes[plane] + y * img->stride[plane], 0,
+               (kWidth + shift) >> shift);
+    }
+    vpx_img_free(img);
+    ++test->released_;
+  }
+
+  // Returns an image with room for the border the encoder extends into.
+  static vpx_image_t *AllocBorderedImage() {
+    const int border = VP9_ZERO_COPY_INPUT_BORDER;
+    vpx_image_t *const img = vpx_img_alloc(NULL, VPX_IMG_FMT_I420,
+                                           kWidth + 2 * border,
+                                           kHeight + 2 * border, 32);
+    vpx_img_set_rect(img, border, border, kWidth, kHeight);
+    return img;
+  }
+
+  static void CopyFrame(const vpx_image_t &src, vpx_image_t *dst) {
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? 1 : 0;
+      for (int y = 0; y < (kHeight + shift) >> shift; ++y)
+        memcpy(dst->planes[plane] + y * dst->stride[plane],
+               src.planes[plane] + y * src.stride[plane],
+               (kWidth + shift) >> shift);
+    }
+  }
+
+  void InitEncoder(vpx_codec_ctx_t *encoder) {
+    vpx_codec_enc_cfg_t cfg;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_config_default(&vpx_codec_vp9_cx_algo, &cfg, 0));
+    cfg.g_w = kWidth;
+    cfg.g_h = kHeight;
+    cfg.g_lag_in_frames = GetParam();
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(encoder, &vpx_codec_vp9_cx_algo, &cfg, 0));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(encoder, VP8E_SET_CPUUSED, 4));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(encoder, VP8E_SET_ENABLEAUTOALTREF, 1));
+  }
+
+  // Appends the compressed frames to out and returns whether there were any.
+  static bool GetOutput(vpx_codec_ctx_t *encoder, std::string *out) {
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    bool got_data = false;
+
+    while ((pkt = vpx_codec_get_cx_data(encoder, &iter)) != NULL) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+        out->append(static_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz);
+        got_data = true;
+      }
+    }
+    return got_data;
+  }
+
+  std::string Encode(bool zero_copy) {
+    vpx_codec_ctx_t encoder;
+    std::string out;
+
+    InitEncoder(&encoder);
+    if (zero_copy) {
+      vpx_zero_copy_input_t input = { ReleaseInput, this };
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&encoder,
+                                                VP9E_SET_ZERO_COPY_INPUT,
+                                                &input));
+    }
+
+    libvpx_test::I420VideoSource video("hantro_collage_w352h288.yuv",
+                                       352, 288, 30, 1, 0, kFrames);
+    for (video.Begin(); video.img() != NULL; video.Next()) {
+      vpx_image_t *const img = zero_copy ?
+          AllocBorderedImage() :
+          vpx_img_alloc(NULL, VPX_IMG_FMT_I420, kWidth, kHeight, 32);
+      CopyFrame(*video.img(), img);
+      img->user_priv = img;
+      if (zero_copy)
+        retained_.insert(img);
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&encoder, img, video.pts(), 1,
+                                               0, VPX_DL_GOOD_QUALITY));
+      if (!zero_copy)
+        vpx_img_free(img);
+      GetOutput(&encoder, &out);
+    }
+
+    do {
+      EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&encoder, NULL, 0, 0, 0,
+                                               VPX_DL_GOOD_QUALITY));
+    } while (GetOutput(&encoder, &out));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&encoder));
+    return out;
+  }
+
+  std::set<vpx_image_t *> retained_;
+  int released_;
+};
+
+TEST_P(VP9ZeroCopyInputTest, MatchesCopiedInput) {
+  const std::string copied = Encode(false);
+  const std::string referenced = Encode(true);
+
+  ASSERT_FALSE(copied.empty());
+  EXPECT_TRUE(copied == referenced) << "Output differs from copied input";
+  EXPECT_EQ(kFrames, released_);
+  EXPECT_TRUE(retained_.empty());
+}
+
+TEST_P(VP9ZeroCopyInputTest, RejectsImagesWithoutBorder) {
+  vpx_codec_ctx_t encoder;
+  vpx_zero_copy_input_t input = { ReleaseInput, this };
+
+  InitEncoder(&encoder);
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&encoder, VP9E_SET_ZERO_COPY_INPUT, &input));
+  vpx_image_t *const img =
+      vpx_img_alloc(NULL, VPX_IMG_FMT_I420, kWidth, kHeight, 32);
+  memset(img->img_data, 0, img->stride[VPX_PLANE_Y] * img->h * 3 / 2);
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_encode(&encoder, img, 0, 1, 0, VPX_DL_GOOD_QUALITY));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&encoder));
+  vpx_img_free(img);
+  EXPECT_EQ(0, released_);
+}
+
+// Lag in frames: none, and enough to hold every frame with an alt-ref.
+INSTANTIATE_TEST_CASE_P(VP9, VP9ZeroCopyInputTest, ::testing::Values(0, 25));
+}  // namespace
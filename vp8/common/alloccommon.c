@@ -17,11 +17,41 @@
 #include "entropymode.h"
 #include "systemdependent.h"
 
+void vp8_release_frame_buffer(VP8_COMMON *oci, int idx)
+{
+    vpx_codec_frame_buffer_t *const fb = &oci->raw_fb[idx];
+
+    if (fb->data != NULL)
+    {
+        oci->release_fb_cb(oci->cb_priv, fb);
+        vpx_memset(fb, 0, sizeof(*fb));
+    }
+}
+
+int vp8_get_frame_buffer(VP8_COMMON *oci, int idx, int width, int height)
+{
+    YV12_BUFFER_CONFIG *const ybf = &oci->yv12_fb[idx];
+
+    if (oci->get_fb_cb == NULL)
+        return vp8_yv12_realloc_frame_buffer(ybf, width, height,
+                                             VP8BORDERINPIXELS);
+
+    vp8_release_frame_buffer(oci, idx);
+    return vp8_yv12_realloc_external_frame_buffer(ybf, width, height,
+                                                  VP8BORDERINPIXELS,
+                                                  &oci->raw_fb[idx],
+                                                  oci->get_fb_cb,
+                                                  oci->cb_priv);
+}
+
 void vp8_de_alloc_frame_buffers(VP8_COMMON *oci)
 {
     int i;
     for (i = 0; i < NUM_YV12_BUFFERS; i++)
+    {
         vp8_yv12_de_alloc_frame_buffer(&oci->yv12_fb[i]);
+        vp8_release_frame_buffer(oci, i);
+    }
 
     vp8_yv12_de_alloc_frame_buffer(&oci->temp_scale_frame);
 #if CONFIG_POSTPROC
@@ -62,7 +92,7 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     {
         oci->fb_idx_ref_cnt[i] = 0;
         oci->yv12_fb[i].flags = 0;
-        if (vp8_yv12_alloc_frame_buffer(&oci->yv12_fb[i], width, height, VP8BORDERINPIXELS) < 0)
+        if (vp8_get_frame_buffer(oci, i, width, height) < 0)
             goto allocation_fail;
     }
 
@@ -22,6 +22,15 @@ void vp8_create_common(VP8_COMMON *oci);
 void vp8_remove_common(VP8_COMMON *oci);
 void vp8_de_alloc_frame_buffers(VP8_COMMON *oci);
 int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height);
+/* Gives frame buffer idx new memory for a frame of the given size, from the
+ * application if it supplies the frame buffers, after handing back what the
+ * buffer held. Returns < 0 on failure.
+ */
+int vp8_get_frame_buffer(VP8_COMMON *oci, int idx, int width, int height);
+/* Hands the memory of frame buffer idx back to the application, if it came
+ * from there.
+ */
+void vp8_release_frame_buffer(VP8_COMMON *oci, int idx);
 void vp8_setup_version(VP8_COMMON *oci);
 
 #ifdef __cplusplus
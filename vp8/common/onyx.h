@@ -198,6 +198,7 @@ extern "C"
 
 
         int multi_threaded;   /* how many threads to run the encoder on */
+        int shared_threads;   /* run them on the threads shared by encoders */
         int token_partitions; /* how many token partitions to create */
 
         /* early breakout threshold: for video conf recommend 800 */
@@ -84,6 +84,14 @@ typedef struct VP8Common
     int fb_idx_ref_cnt[NUM_YV12_BUFFERS];
     int new_fb_idx, lst_fb_idx, gld_fb_idx, alt_fb_idx;
 
+    /* Memory of yv12_fb when the application supplies the frame buffers,
+     * in which case get_fb_cb is set.
+     */
+    vpx_codec_frame_buffer_t raw_fb[NUM_YV12_BUFFERS];
+    vpx_get_frame_buffer_cb_fn_t get_fb_cb;
+    vpx_release_frame_buffer_cb_fn_t release_fb_cb;
+    void *cb_priv;
+
     YV12_BUFFER_CONFIG temp_scale_frame;
 
 #if CONFIG_POSTPROC
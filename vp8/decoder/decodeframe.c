@@ -977,6 +977,75 @@ static void init_frame(VP8D_COMP *pbi)
 
 }
 
+int vp8_frame_is_droppable(const unsigned char *data, unsigned int data_sz,
+                           vpx_decrypt_cb decrypt_cb, void *decrypt_state)
+{
+    BOOL_DECODER bc;
+    unsigned char clear_buffer[3];
+    const unsigned char *clear = data;
+    unsigned int first_partition_length_in_bytes;
+    int i;
+
+    if (data_sz < 3)
+        return 0;
+
+    if (decrypt_cb)
+    {
+        decrypt_cb(decrypt_state, data, clear_buffer, 3);
+        clear = clear_buffer;
+    }
+
+    /* Key frames refresh every buffer. */
+    if (!(clear[0] & 1))
+        return 0;
+
+    first_partition_length_in_bytes =
+        (clear[0] | (clear[1] << 8) | (clear[2] << 16)) >> 5;
+    if (first_partition_length_in_bytes > data_sz - 3)
+        return 0;
+
+    if (vp8dx_start_decode(&bc, data + 3, first_partition_length_in_bytes,
+                           decrypt_cb, decrypt_state))
+        return 0;
+
+    /* Read the header as vp8_decode_frame() does, up to the refresh flags.
+     * Segmentation and loop filter delta updates last until the next update,
+     * so frames that have them are not droppable either.
+     */
+    if (vp8_read_bit(&bc))
+    {
+        if (vp8_read_bit(&bc) || vp8_read_bit(&bc))
+            return 0;
+    }
+
+    (void)vp8_read_literal(&bc, 1 + 6 + 3);  /* filter type, level, sharpness */
+
+    if (vp8_read_bit(&bc) && vp8_read_bit(&bc))
+        return 0;
+
+    (void)vp8_read_literal(&bc, 2);  /* token partitions */
+    (void)vp8_read_literal(&bc, 7);  /* base q index */
+    for (i = 0; i < 5; i++)
+    {
+        if (vp8_read_bit(&bc))
+            (void)vp8_read_literal(&bc, 4 + 1);  /* q delta and sign */
+    }
+
+    /* Golden and altref refresh, then the copies to them. */
+    if (vp8_read_bit(&bc) || vp8_read_bit(&bc))
+        return 0;
+    if (vp8_read_literal(&bc, 2) || vp8_read_literal(&bc, 2))
+        return 0;
+
+    (void)vp8_read_literal(&bc, 2);  /* sign bias */
+
+    /* Entropy probability and last frame refresh. */
+    if (vp8_read_bit(&bc) || vp8_read_bit(&bc))
+        return 0;
+
+    return !vp8dx_bool_error(&bc);
+}
+
 int vp8_decode_frame(VP8D_COMP *pbi)
 {
     vp8_reader *const bc = &pbi->mbc[8];
@@ -166,6 +166,8 @@ vpx_codec_err_t vp8dx_set_reference(VP8D_COMP *pbi, enum vpx_ref_frame_type ref_
     else{
         /* Find an empty frame buffer. */
         free_fb = get_free_fb(cm);
+        if (free_fb < 0)
+            return pbi->common.error.error_code;
         /* Decrease fb_idx_ref_cnt since it will be increased again in
          * ref_cnt_fb() below. */
         cm->fb_idx_ref_cnt[free_fb]--;
@@ -186,6 +188,20 @@ static int get_free_fb (VP8_COMMON *cm)
             break;
 
     assert(i < NUM_YV12_BUFFERS);
+
+    /* Frame buffers supplied by the application are handed back only when
+     * they are reused, so that the frame last shown stays valid until the
+     * next decode call.
+     */
+    if (cm->get_fb_cb != NULL &&
+        vp8_get_frame_buffer(cm, i, cm->yv12_fb[i].y_width,
+                             cm->yv12_fb[i].y_height) < 0)
+    {
+        vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                           "Failed to get frame buffer");
+        return -1;
+    }
+
     cm->fb_idx_ref_cnt[i] = 1;
     return i;
 }
@@ -275,8 +291,11 @@ int check_fragments_for_errors(VP8D_COMP *pbi)
              * corrupt, otherwise we will make multiple buffers corrupt.
              */
             const int prev_idx = cm->lst_fb_idx;
+            const int free_fb = get_free_fb(cm);
+            if (free_fb < 0)
+                return -1;
             cm->fb_idx_ref_cnt[prev_idx]--;
-            cm->lst_fb_idx = get_free_fb(cm);
+            cm->lst_fb_idx = free_fb;
             vp8_yv12_copy_frame(&cm->yv12_fb[prev_idx],
                                     &cm->yv12_fb[cm->lst_fb_idx]);
         }
@@ -303,6 +322,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, size_t size,
 {
     VP8_COMMON *cm = &pbi->common;
     int retcode = -1;
+    int free_fb;
 
     pbi->common.error.error_code = VPX_CODEC_OK;
 
@@ -310,7 +330,10 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, size_t size,
     if(retcode <= 0)
         return retcode;
 
-    cm->new_fb_idx = get_free_fb (cm);
+    free_fb = get_free_fb (cm);
+    if (free_fb < 0)
+        return -1;
+    cm->new_fb_idx = free_fb;
 
     /* setup reference frames for vp8_decode_frame */
     pbi->dec_fb_ref[INTRA_FRAME]  = &cm->yv12_fb[cm->new_fb_idx];
@@ -132,6 +132,12 @@ typedef struct VP8D_COMP
 
 int vp8_decode_frame(VP8D_COMP *cpi);
 
+/* Returns 1 if the frame updates no reference buffer and no other state that
+ * later frames depend on, from its first partition.
+ */
+int vp8_frame_is_droppable(const unsigned char *data, unsigned int data_sz,
+                           vpx_decrypt_cb decrypt_cb, void *decrypt_state);
+
 int vp8_create_decoder_instances(struct frame_buffers *fb, VP8D_CONFIG *oxcf);
 int vp8_remove_decoder_instances(struct frame_buffers *fb);
 
@@ -667,6 +667,11 @@ void vp8_decoder_create_threads(VP8D_COMP *pbi)
         pbi->b_multithreaded_rd = 1;
         pbi->decoding_thread_count = core_count - 1;
 
+        /* TODO: run these on a vp9d_worker_pool_t when the application
+         * provides one, as VP9 decoders do. Each row thread waits on its
+         * own semaphore between frames, so it cannot give up a pool thread
+         * yet.
+         */
         CALLOC_ARRAY(pbi->h_decoding_thread, pbi->decoding_thread_count);
         CALLOC_ARRAY(pbi->h_event_start_decoding, pbi->decoding_thread_count);
         CALLOC_ARRAY_ALIGNED(pbi->mb_row_di, pbi->decoding_thread_count, 32);
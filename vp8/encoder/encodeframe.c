@@ -47,6 +47,8 @@ extern void vp8cx_init_mbrthread_data(VP8_COMP *cpi,
                                       MACROBLOCK *x,
                                       MB_ROW_COMP *mbr_ei,
                                       int count);
+extern void vp8cx_start_encoding_threads(VP8_COMP *cpi);
+extern void vp8cx_wait_encoding_threads(VP8_COMP *cpi);
 static void adjust_act_zbin( VP8_COMP *cpi, MACROBLOCK *x );
 
 #ifdef MODE_STATS
@@ -811,10 +813,7 @@ void vp8_encode_frame(VP8_COMP *cpi)
             for (i = 0; i < cm->mb_rows; i++)
                 cpi->mt_current_mb_col[i] = -1;
 
-            for (i = 0; i < cpi->encoding_thread_count; i++)
-            {
-                sem_post(&cpi->h_event_start_encoding[i]);
-            }
+            vp8cx_start_encoding_threads(cpi);
 
             for (mb_row = 0; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
             {
@@ -843,7 +842,7 @@ void vp8_encode_frame(VP8_COMP *cpi)
                 }
             }
 
-            sem_wait(&cpi->h_event_end_encoding); /* wait for other threads to finish */
+            vp8cx_wait_encoding_threads(cpi); /* wait for other threads to finish */
 
             for (mb_row = 0; mb_row < cm->mb_rows; mb_row ++)
             {
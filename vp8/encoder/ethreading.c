@@ -12,6 +12,7 @@
 #include "vp8/common/threading.h"
 #include "vp8/common/common.h"
 #include "vp8/common/extend.h"
+#include "vpx_ports/vpx_once.h"
 #include "bitstream.h"
 #include "encodeframe.h"
 
@@ -21,10 +22,18 @@ extern void vp8cx_mb_init_quantizer(VP8_COMP *cpi, MACROBLOCK *x, int ok_to_skip
 
 extern void vp8_loopfilter_frame(VP8_COMP *cpi, VP8_COMMON *cm);
 
+static void loopfilter_frame(void *p_data)
+{
+    VP8_COMP *cpi = (VP8_COMP *)(((LPFTHREAD_DATA *)p_data)->ptr1);
+
+    vp8_loopfilter_frame(cpi, &cpi->common);
+
+    sem_post(&cpi->h_event_end_lpf);
+}
+
 static THREAD_FUNCTION thread_loopfilter(void *p_data)
 {
     VP8_COMP *cpi = (VP8_COMP *)(((LPFTHREAD_DATA *)p_data)->ptr1);
-    VP8_COMMON *cm = &cpi->common;
 
     while (1)
     {
@@ -36,268 +45,276 @@ static THREAD_FUNCTION thread_loopfilter(void *p_data)
             if (cpi->b_multi_threaded == 0) /* we're shutting down */
                 break;
 
-            vp8_loopfilter_frame(cpi, cm);
-
-            sem_post(&cpi->h_event_end_lpf);
+            loopfilter_frame(p_data);
         }
     }
 
     return 0;
 }
 
-static
-THREAD_FUNCTION thread_encoding_proc(void *p_data)
+/* Encodes the rows of the frame that fall to thread ithread: every
+ * (encoding_thread_count + 1)th row, starting with row ithread + 1.
+ */
+static void encode_thread_rows(void *p_data)
 {
     int ithread = ((ENCODETHREAD_DATA *)p_data)->ithread;
     VP8_COMP *cpi = (VP8_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr1);
     MB_ROW_COMP *mbri = (MB_ROW_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr2);
     ENTROPY_CONTEXT_PLANES mb_row_left_context;
-
-    while (1)
-    {
-        if (cpi->b_multi_threaded == 0)
-            break;
-
-        if (sem_wait(&cpi->h_event_start_encoding[ithread]) == 0)
-        {
-            const int nsync = cpi->mt_sync_range;
-            VP8_COMMON *cm = &cpi->common;
-            int mb_row;
-            MACROBLOCK *x = &mbri->mb;
-            MACROBLOCKD *xd = &x->e_mbd;
-            TOKENEXTRA *tp ;
+    const int nsync = cpi->mt_sync_range;
+    VP8_COMMON *cm = &cpi->common;
+    int mb_row;
+    MACROBLOCK *x = &mbri->mb;
+    MACROBLOCKD *xd = &x->e_mbd;
+    TOKENEXTRA *tp ;
 #if CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING
-            TOKENEXTRA *tp_start = cpi->tok + (1 + ithread) * (16 * 24);
-            const int num_part = (1 << cm->multi_token_partition);
+    TOKENEXTRA *tp_start = cpi->tok + (1 + ithread) * (16 * 24);
+    const int num_part = (1 << cm->multi_token_partition);
 #endif
 
-            int *segment_counts = mbri->segment_counts;
-            int *totalrate = &mbri->totalrate;
-
-            if (cpi->b_multi_threaded == 0) /* we're shutting down */
-                break;
+    int *segment_counts = mbri->segment_counts;
+    int *totalrate = &mbri->totalrate;
 
-            for (mb_row = ithread + 1; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
-            {
+    for (mb_row = ithread + 1; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
+    {
 
-                int recon_yoffset, recon_uvoffset;
-                int mb_col;
-                int ref_fb_idx = cm->lst_fb_idx;
-                int dst_fb_idx = cm->new_fb_idx;
-                int recon_y_stride = cm->yv12_fb[ref_fb_idx].y_stride;
-                int recon_uv_stride = cm->yv12_fb[ref_fb_idx].uv_stride;
-                int map_index = (mb_row * cm->mb_cols);
-                volatile const int *last_row_current_mb_col;
-                volatile int *current_mb_col = &cpi->mt_current_mb_col[mb_row];
+        int recon_yoffset, recon_uvoffset;
+        int mb_col;
+        int ref_fb_idx = cm->lst_fb_idx;
+        int dst_fb_idx = cm->new_fb_idx;
+        int recon_y_stride = cm->yv12_fb[ref_fb_idx].y_stride;
+        int recon_uv_stride = cm->yv12_fb[ref_fb_idx].uv_stride;
+        int map_index = (mb_row * cm->mb_cols);
+        volatile const int *last_row_current_mb_col;
+        volatile int *current_mb_col = &cpi->mt_current_mb_col[mb_row];
 
 #if  (CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING)
-                vp8_writer *w = &cpi->bc[1 + (mb_row % num_part)];
+        vp8_writer *w = &cpi->bc[1 + (mb_row % num_part)];
 #else
-                tp = cpi->tok + (mb_row * (cm->mb_cols * 16 * 24));
-                cpi->tplist[mb_row].start = tp;
+        tp = cpi->tok + (mb_row * (cm->mb_cols * 16 * 24));
+        cpi->tplist[mb_row].start = tp;
 #endif
 
-                last_row_current_mb_col = &cpi->mt_current_mb_col[mb_row - 1];
+        last_row_current_mb_col = &cpi->mt_current_mb_col[mb_row - 1];
 
-                /* reset above block coeffs */
-                xd->above_context = cm->above_context;
-                xd->left_context = &mb_row_left_context;
+        /* reset above block coeffs */
+        xd->above_context = cm->above_context;
+        xd->left_context = &mb_row_left_context;
 
-                vp8_zero(mb_row_left_context);
+        vp8_zero(mb_row_left_context);
 
-                xd->up_available = (mb_row != 0);
-                recon_yoffset = (mb_row * recon_y_stride * 16);
-                recon_uvoffset = (mb_row * recon_uv_stride * 8);
+        xd->up_available = (mb_row != 0);
+        recon_yoffset = (mb_row * recon_y_stride * 16);
+        recon_uvoffset = (mb_row * recon_uv_stride * 8);
 
-                /* Set the mb activity pointer to the start of the row. */
-                x->mb_activity_ptr = &cpi->mb_activity_map[map_index];
+        /* Set the mb activity pointer to the start of the row. */
+        x->mb_activity_ptr = &cpi->mb_activity_map[map_index];
 
-                /* for each macroblock col in image */
-                for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
-                {
-                    *current_mb_col = mb_col - 1;
+        /* for each macroblock col in image */
+        for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
+        {
+            *current_mb_col = mb_col - 1;
 
-                    if ((mb_col & (nsync - 1)) == 0)
-                    {
-                        while (mb_col > (*last_row_current_mb_col - nsync))
-                        {
-                            x86_pause_hint();
-                            thread_sleep(0);
-                        }
-                    }
+            if ((mb_col & (nsync - 1)) == 0)
+            {
+                while (mb_col > (*last_row_current_mb_col - nsync))
+                {
+                    x86_pause_hint();
+                    thread_sleep(0);
+                }
+            }
 
 #if CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING
-                    tp = tp_start;
+            tp = tp_start;
 #endif
 
-                    /* Distance of Mb to the various image edges.
-                     * These specified to 8th pel as they are always compared
-                     * to values that are in 1/8th pel units
-                     */
-                    xd->mb_to_left_edge = -((mb_col * 16) << 3);
-                    xd->mb_to_right_edge = ((cm->mb_cols - 1 - mb_col) * 16) << 3;
-                    xd->mb_to_top_edge = -((mb_row * 16) << 3);
-                    xd->mb_to_bottom_edge = ((cm->mb_rows - 1 - mb_row) * 16) << 3;
-
-                    /* Set up limit values for motion vectors used to prevent
-                     * them extending outside the UMV borders
-                     */
-                    x->mv_col_min = -((mb_col * 16) + (VP8BORDERINPIXELS - 16));
-                    x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + (VP8BORDERINPIXELS - 16);
-                    x->mv_row_min = -((mb_row * 16) + (VP8BORDERINPIXELS - 16));
-                    x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16) + (VP8BORDERINPIXELS - 16);
+            /* Distance of Mb to the various image edges.
+             * These specified to 8th pel as they are always compared
+             * to values that are in 1/8th pel units
+             */
+            xd->mb_to_left_edge = -((mb_col * 16) << 3);
+            xd->mb_to_right_edge = ((cm->mb_cols - 1 - mb_col) * 16) << 3;
+            xd->mb_to_top_edge = -((mb_row * 16) << 3);
+            xd->mb_to_bottom_edge = ((cm->mb_rows - 1 - mb_row) * 16) << 3;
+
+            /* Set up limit values for motion vectors used to prevent
+             * them extending outside the UMV borders
+             */
+            x->mv_col_min = -((mb_col * 16) + (VP8BORDERINPIXELS - 16));
+            x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + (VP8BORDERINPIXELS - 16);
+            x->mv_row_min = -((mb_row * 16) + (VP8BORDERINPIXELS - 16));
+            x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16) + (VP8BORDERINPIXELS - 16);
+
+            xd->dst.y_buffer = cm->yv12_fb[dst_fb_idx].y_buffer + recon_yoffset;
+            xd->dst.u_buffer = cm->yv12_fb[dst_fb_idx].u_buffer + recon_uvoffset;
+            xd->dst.v_buffer = cm->yv12_fb[dst_fb_idx].v_buffer + recon_uvoffset;
+            xd->left_available = (mb_col != 0);
+
+            x->rddiv = cpi->RDDIV;
+            x->rdmult = cpi->RDMULT;
+
+            /* Copy current mb to a buffer */
+            vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
+
+            if (cpi->oxcf.tuning == VP8_TUNE_SSIM)
+                vp8_activity_masking(cpi, x);
+
+            /* Is segmentation enabled */
+            /* MB level adjustment to quantizer */
+            if (xd->segmentation_enabled)
+            {
+                /* Code to set segment id in xd->mbmi.segment_id for
+                 * current MB (with range checking)
+                 */
+                if (cpi->segmentation_map[map_index + mb_col] <= 3)
+                    xd->mode_info_context->mbmi.segment_id = cpi->segmentation_map[map_index + mb_col];
+                else
+                    xd->mode_info_context->mbmi.segment_id = 0;
+
+                vp8cx_mb_init_quantizer(cpi, x, 1);
+            }
+            else
+                /* Set to Segment 0 by default */
+                xd->mode_info_context->mbmi.segment_id = 0;
 
-                    xd->dst.y_buffer = cm->yv12_fb[dst_fb_idx].y_buffer + recon_yoffset;
-                    xd->dst.u_buffer = cm->yv12_fb[dst_fb_idx].u_buffer + recon_uvoffset;
-                    xd->dst.v_buffer = cm->yv12_fb[dst_fb_idx].v_buffer + recon_uvoffset;
-                    xd->left_available = (mb_col != 0);
+            x->active_ptr = cpi->active_map + map_index + mb_col;
 
-                    x->rddiv = cpi->RDDIV;
-                    x->rdmult = cpi->RDMULT;
+            if (cm->frame_type == KEY_FRAME)
+            {
+                *totalrate += vp8cx_encode_intra_macroblock(cpi, x, &tp);
+#ifdef MODE_STATS
+                y_modes[xd->mbmi.mode] ++;
+#endif
+            }
+            else
+            {
+                *totalrate += vp8cx_encode_inter_macroblock(cpi, x, &tp, recon_yoffset, recon_uvoffset, mb_row, mb_col);
 
-                    /* Copy current mb to a buffer */
-                    vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
+#ifdef MODE_STATS
+                inter_y_modes[xd->mbmi.mode] ++;
 
-                    if (cpi->oxcf.tuning == VP8_TUNE_SSIM)
-                        vp8_activity_masking(cpi, x);
+                if (xd->mbmi.mode == SPLITMV)
+                {
+                    int b;
 
-                    /* Is segmentation enabled */
-                    /* MB level adjustment to quantizer */
-                    if (xd->segmentation_enabled)
+                    for (b = 0; b < xd->mbmi.partition_count; b++)
                     {
-                        /* Code to set segment id in xd->mbmi.segment_id for
-                         * current MB (with range checking)
-                         */
-                        if (cpi->segmentation_map[map_index + mb_col] <= 3)
-                            xd->mode_info_context->mbmi.segment_id = cpi->segmentation_map[map_index + mb_col];
-                        else
-                            xd->mode_info_context->mbmi.segment_id = 0;
-
-                        vp8cx_mb_init_quantizer(cpi, x, 1);
+                        inter_b_modes[x->partition->bmi[b].mode] ++;
                     }
-                    else
-                        /* Set to Segment 0 by default */
-                        xd->mode_info_context->mbmi.segment_id = 0;
+                }
 
-                    x->active_ptr = cpi->active_map + map_index + mb_col;
+#endif
 
-                    if (cm->frame_type == KEY_FRAME)
+                /* Special case code for cyclic refresh
+                 * If cyclic update enabled then copy
+                 * xd->mbmi.segment_id; (which may have been updated
+                 * based on mode during
+                 * vp8cx_encode_inter_macroblock()) back into the
+                 * global segmentation map
+                 */
+                if ((cpi->current_layer == 0) &&
+                    (cpi->cyclic_refresh_mode_enabled &&
+                     xd->segmentation_enabled))
+                {
+                    const MB_MODE_INFO * mbmi = &xd->mode_info_context->mbmi;
+                    cpi->segmentation_map[map_index + mb_col] = mbmi->segment_id;
+
+                    /* If the block has been refreshed mark it as clean
+                     * (the magnitude of the -ve influences how long it
+                     * will be before we consider another refresh):
+                     * Else if it was coded (last frame 0,0) and has
+                     * not already been refreshed then mark it as a
+                     * candidate for cleanup next time (marked 0) else
+                     * mark it as dirty (1).
+                     */
+                    if (mbmi->segment_id)
+                        cpi->cyclic_refresh_map[map_index + mb_col] = -1;
+                    else if ((mbmi->mode == ZEROMV) && (mbmi->ref_frame == LAST_FRAME))
                     {
-                        *totalrate += vp8cx_encode_intra_macroblock(cpi, x, &tp);
-#ifdef MODE_STATS
-                        y_modes[xd->mbmi.mode] ++;
-#endif
+                        if (cpi->cyclic_refresh_map[map_index + mb_col] == 1)
+                            cpi->cyclic_refresh_map[map_index + mb_col] = 0;
                     }
                     else
-                    {
-                        *totalrate += vp8cx_encode_inter_macroblock(cpi, x, &tp, recon_yoffset, recon_uvoffset, mb_row, mb_col);
+                        cpi->cyclic_refresh_map[map_index + mb_col] = 1;
 
-#ifdef MODE_STATS
-                        inter_y_modes[xd->mbmi.mode] ++;
+                }
+            }
 
-                        if (xd->mbmi.mode == SPLITMV)
-                        {
-                            int b;
+#if CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING
+            /* pack tokens for this MB */
+            {
+                int tok_count = tp - tp_start;
+                pack_tokens(w, tp_start, tok_count);
+            }
+#else
+            cpi->tplist[mb_row].stop = tp;
+#endif
+            /* Increment pointer into gf usage flags structure. */
+            x->gf_active_ptr++;
 
-                            for (b = 0; b < xd->mbmi.partition_count; b++)
-                            {
-                                inter_b_modes[x->partition->bmi[b].mode] ++;
-                            }
-                        }
+            /* Increment the activity mask pointers. */
+            x->mb_activity_ptr++;
 
-#endif
+            /* adjust to the next column of macroblocks */
+            x->src.y_buffer += 16;
+            x->src.u_buffer += 8;
+            x->src.v_buffer += 8;
 
-                        /* Special case code for cyclic refresh
-                         * If cyclic update enabled then copy
-                         * xd->mbmi.segment_id; (which may have been updated
-                         * based on mode during
-                         * vp8cx_encode_inter_macroblock()) back into the
-                         * global segmentation map
-                         */
-                        if ((cpi->current_layer == 0) &&
-                            (cpi->cyclic_refresh_mode_enabled &&
-                             xd->segmentation_enabled))
-                        {
-                            const MB_MODE_INFO * mbmi = &xd->mode_info_context->mbmi;
-                            cpi->segmentation_map[map_index + mb_col] = mbmi->segment_id;
-
-                            /* If the block has been refreshed mark it as clean
-                             * (the magnitude of the -ve influences how long it
-                             * will be before we consider another refresh):
-                             * Else if it was coded (last frame 0,0) and has
-                             * not already been refreshed then mark it as a
-                             * candidate for cleanup next time (marked 0) else
-                             * mark it as dirty (1).
-                             */
-                            if (mbmi->segment_id)
-                                cpi->cyclic_refresh_map[map_index + mb_col] = -1;
-                            else if ((mbmi->mode == ZEROMV) && (mbmi->ref_frame == LAST_FRAME))
-                            {
-                                if (cpi->cyclic_refresh_map[map_index + mb_col] == 1)
-                                    cpi->cyclic_refresh_map[map_index + mb_col] = 0;
-                            }
-                            else
-                                cpi->cyclic_refresh_map[map_index + mb_col] = 1;
-
-                        }
-                    }
+            recon_yoffset += 16;
+            recon_uvoffset += 8;
 
-#if CONFIG_REALTIME_ONLY & CONFIG_ONTHEFLY_BITPACKING
-                    /* pack tokens for this MB */
-                    {
-                        int tok_count = tp - tp_start;
-                        pack_tokens(w, tp_start, tok_count);
-                    }
-#else
-                    cpi->tplist[mb_row].stop = tp;
-#endif
-                    /* Increment pointer into gf usage flags structure. */
-                    x->gf_active_ptr++;
+            /* Keep track of segment usage */
+            segment_counts[xd->mode_info_context->mbmi.segment_id]++;
 
-                    /* Increment the activity mask pointers. */
-                    x->mb_activity_ptr++;
+            /* skip to next mb */
+            xd->mode_info_context++;
+            x->partition_info++;
+            xd->above_context++;
+        }
 
-                    /* adjust to the next column of macroblocks */
-                    x->src.y_buffer += 16;
-                    x->src.u_buffer += 8;
-                    x->src.v_buffer += 8;
+        vp8_extend_mb_row( &cm->yv12_fb[dst_fb_idx],
+                            xd->dst.y_buffer + 16,
+                            xd->dst.u_buffer + 8,
+                            xd->dst.v_buffer + 8);
 
-                    recon_yoffset += 16;
-                    recon_uvoffset += 8;
+        *current_mb_col = mb_col + nsync;
 
-                    /* Keep track of segment usage */
-                    segment_counts[xd->mode_info_context->mbmi.segment_id]++;
+        /* this is to account for the border */
+        xd->mode_info_context++;
+        x->partition_info++;
 
-                    /* skip to next mb */
-                    xd->mode_info_context++;
-                    x->partition_info++;
-                    xd->above_context++;
-                }
+        x->src.y_buffer += 16 * x->src.y_stride * (cpi->encoding_thread_count + 1) - 16 * cm->mb_cols;
+        x->src.u_buffer += 8 * x->src.uv_stride * (cpi->encoding_thread_count + 1) - 8 * cm->mb_cols;
+        x->src.v_buffer += 8 * x->src.uv_stride * (cpi->encoding_thread_count + 1) - 8 * cm->mb_cols;
 
-                vp8_extend_mb_row( &cm->yv12_fb[dst_fb_idx],
-                                    xd->dst.y_buffer + 16,
-                                    xd->dst.u_buffer + 8,
-                                    xd->dst.v_buffer + 8);
+        xd->mode_info_context += xd->mode_info_stride * cpi->encoding_thread_count;
+        x->partition_info += xd->mode_info_stride * cpi->encoding_thread_count;
+        x->gf_active_ptr   += cm->mb_cols * cpi->encoding_thread_count;
 
-                *current_mb_col = mb_col + nsync;
+        if (mb_row == cm->mb_rows - 1)
+        {
+            sem_post(&cpi->h_event_end_encoding); /* signal frame encoding end */
+        }
+    }
+}
 
-                /* this is to account for the border */
-                xd->mode_info_context++;
-                x->partition_info++;
+static
+THREAD_FUNCTION thread_encoding_proc(void *p_data)
+{
+    int ithread = ((ENCODETHREAD_DATA *)p_data)->ithread;
+    VP8_COMP *cpi = (VP8_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr1);
 
-                x->src.y_buffer += 16 * x->src.y_stride * (cpi->encoding_thread_count + 1) - 16 * cm->mb_cols;
-                x->src.u_buffer += 8 * x->src.uv_stride * (cpi->encoding_thread_count + 1) - 8 * cm->mb_cols;
-                x->src.v_buffer += 8 * x->src.uv_stride * (cpi->encoding_thread_count + 1) - 8 * cm->mb_cols;
+    while (1)
+    {
+        if (cpi->b_multi_threaded == 0)
+            break;
 
-                xd->mode_info_context += xd->mode_info_stride * cpi->encoding_thread_count;
-                x->partition_info += xd->mode_info_stride * cpi->encoding_thread_count;
-                x->gf_active_ptr   += cm->mb_cols * cpi->encoding_thread_count;
+        if (sem_wait(&cpi->h_event_start_encoding[ithread]) == 0)
+        {
+            if (cpi->b_multi_threaded == 0) /* we're shutting down */
+                break;
 
-                if (mb_row == cm->mb_rows - 1)
-                {
-                    sem_post(&cpi->h_event_end_encoding); /* signal frame encoding end */
-                }
-            }
+            encode_thread_rows(p_data);
         }
     }
 
@@ -305,6 +322,229 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
     return 0;
 }
 
+/* The threads shared by all the encoders created with
+ * VPX_CODEC_USE_SHARED_THREADS, one fewer than there are cores. Encoders take
+ * all the threads they need for a frame at once, since its rows wait on one
+ * another and have to run side by side; they only ever wait for threads
+ * running jobs that finish on their own.
+ */
+typedef struct
+{
+    pthread_t thread;
+    sem_t h_event_start;
+    void (*job)(void *data);
+    void *data;
+    int next_idle;
+} POOLTHREAD_DATA;
+
+static struct
+{
+    sem_t take_lock;    /* held while taking threads, attaching, detaching */
+    sem_t idle_lock;    /* guards idle and next_idle */
+    sem_t h_event_idle; /* counts the idle threads */
+    int thread_count;
+    int users;
+    int idle;
+    int shutdown;
+    POOLTHREAD_DATA *threads;
+} shared_pool;
+
+static void init_shared_pool(void)
+{
+    /* Semaphores start at 0 on every platform. */
+    sem_init(&shared_pool.take_lock, 0, 0);
+    sem_init(&shared_pool.idle_lock, 0, 0);
+    sem_init(&shared_pool.h_event_idle, 0, 0);
+    sem_post(&shared_pool.take_lock);
+    sem_post(&shared_pool.idle_lock);
+}
+
+static THREAD_FUNCTION thread_pool_proc(void *p_data)
+{
+    POOLTHREAD_DATA *thread = (POOLTHREAD_DATA *)p_data;
+
+    while (1)
+    {
+        if (sem_wait(&thread->h_event_start) == 0)
+        {
+            if (shared_pool.shutdown)
+                break;
+
+            thread->job(thread->data);
+
+            sem_wait(&shared_pool.idle_lock);
+            thread->next_idle = shared_pool.idle;
+            shared_pool.idle = (int)(thread - shared_pool.threads);
+            sem_post(&shared_pool.idle_lock);
+            sem_post(&shared_pool.h_event_idle);
+        }
+    }
+
+    return 0;
+}
+
+/* Waits until every thread is idle, then stops them. Called with take_lock
+ * held.
+ */
+static void stop_shared_threads(int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        sem_wait(&shared_pool.h_event_idle);
+
+    shared_pool.shutdown = 1;
+    for (i = 0; i < count; i++)
+    {
+        sem_post(&shared_pool.threads[i].h_event_start);
+        pthread_join(shared_pool.threads[i].thread, 0);
+        sem_destroy(&shared_pool.threads[i].h_event_start);
+    }
+
+    vpx_free(shared_pool.threads);
+    shared_pool.threads = NULL;
+    shared_pool.thread_count = 0;
+    shared_pool.shutdown = 0;
+}
+
+/* Returns the number of threads in the pool, starting them if this is the
+ * first encoder to use them, or 0 if they could not be started.
+ */
+static int attach_shared_pool(int core_count)
+{
+    int thread_count;
+
+    once(init_shared_pool);
+    sem_wait(&shared_pool.take_lock);
+
+    if (shared_pool.users == 0)
+    {
+        int i;
+
+        shared_pool.threads = vpx_calloc(core_count - 1,
+                                         sizeof(*shared_pool.threads));
+
+        for (i = 0; shared_pool.threads && i < core_count - 1; i++)
+        {
+            POOLTHREAD_DATA *thread = &shared_pool.threads[i];
+
+            sem_init(&thread->h_event_start, 0, 0);
+            thread->next_idle = i - 1;
+
+            if (pthread_create(&thread->thread, 0, thread_pool_proc, thread))
+            {
+                sem_destroy(&thread->h_event_start);
+                break;
+            }
+            sem_post(&shared_pool.h_event_idle);
+        }
+
+        if (shared_pool.threads && i < core_count - 1)
+            stop_shared_threads(i);
+        else if (shared_pool.threads)
+        {
+            shared_pool.thread_count = i;
+            shared_pool.idle = i - 1;
+        }
+    }
+
+    thread_count = shared_pool.thread_count;
+    if (thread_count)
+        shared_pool.users++;
+
+    sem_post(&shared_pool.take_lock);
+    return thread_count;
+}
+
+static void detach_shared_pool(void)
+{
+    sem_wait(&shared_pool.take_lock);
+
+    if (--shared_pool.users == 0)
+        stop_shared_threads(shared_pool.thread_count);
+
+    sem_post(&shared_pool.take_lock);
+}
+
+/* Runs job on count idle threads of the pool, handing the i-th one
+ * data + i * size, once that many are idle.
+ */
+static void run_on_shared_threads(void (*job)(void *data), void *data,
+                                  size_t size, int count)
+{
+    int i;
+
+    sem_wait(&shared_pool.take_lock);
+
+    for (i = 0; i < count; i++)
+        sem_wait(&shared_pool.h_event_idle);
+
+    sem_wait(&shared_pool.idle_lock);
+    for (i = 0; i < count; i++)
+    {
+        POOLTHREAD_DATA *thread = &shared_pool.threads[shared_pool.idle];
+
+        shared_pool.idle = thread->next_idle;
+        thread->job = job;
+        thread->data = (char *)data + i * size;
+        sem_post(&thread->h_event_start);
+    }
+    sem_post(&shared_pool.idle_lock);
+
+    sem_post(&shared_pool.take_lock);
+}
+
+/* Signals the end of the job as well, as a thread of the pool may still be
+ * stepping past its last row when the frame's last row is done.
+ */
+static void encode_thread_rows_job(void *p_data)
+{
+    VP8_COMP *cpi = (VP8_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr1);
+
+    encode_thread_rows(p_data);
+
+    sem_post(&cpi->h_event_end_encoding);
+}
+
+void vp8cx_start_encoding_threads(VP8_COMP *cpi)
+{
+    int i;
+
+    if (cpi->b_shared_threads)
+    {
+        run_on_shared_threads(encode_thread_rows_job, cpi->en_thread_data,
+                              sizeof(*cpi->en_thread_data),
+                              cpi->encoding_thread_count);
+        return;
+    }
+
+    for (i = 0; i < cpi->encoding_thread_count; i++)
+        sem_post(&cpi->h_event_start_encoding[i]);
+}
+
+void vp8cx_wait_encoding_threads(VP8_COMP *cpi)
+{
+    int i;
+
+    /* Once for the last row of the frame, then once per job on the pool. */
+    sem_wait(&cpi->h_event_end_encoding);
+
+    if (cpi->b_shared_threads)
+    {
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            sem_wait(&cpi->h_event_end_encoding);
+    }
+}
+
+void vp8cx_start_loopfilter_thread(VP8_COMP *cpi)
+{
+    if (cpi->b_shared_threads)
+        run_on_shared_threads(loopfilter_frame, &cpi->lpf_thread_data,
+                              sizeof(cpi->lpf_thread_data), 1);
+    else
+        sem_post(&cpi->h_event_start_lpf);
+}
+
 static void setup_mbby_copy(MACROBLOCK *mbdst, MACROBLOCK *mbsrc)
 {
 
@@ -494,11 +734,54 @@ void vp8cx_init_mbrthread_data(VP8_COMP *cpi,
     }
 }
 
+static int create_shared_encoder_threads(VP8_COMP *cpi, int th_count)
+{
+    const int pool_count =
+        attach_shared_pool(cpi->common.processor_core_count);
+    int ithread;
+
+    if (pool_count == 0)
+        return -1;
+
+    if (th_count > pool_count)
+        th_count = pool_count;
+
+    sem_init(&cpi->h_event_end_encoding, 0, 0);
+    sem_init(&cpi->h_event_end_lpf, 0, 0);
+
+    cpi->b_multi_threaded = 1;
+    cpi->b_shared_threads = 1;
+    cpi->encoding_thread_count = th_count;
+
+    CHECK_MEM_ERROR(cpi->mb_row_ei,
+                    vpx_memalign(32, sizeof(MB_ROW_COMP) * th_count));
+    vpx_memset(cpi->mb_row_ei, 0, sizeof(MB_ROW_COMP) * th_count);
+    CHECK_MEM_ERROR(cpi->en_thread_data,
+                    vpx_malloc(sizeof(ENCODETHREAD_DATA) * th_count));
+
+    for (ithread = 0; ithread < th_count; ithread++)
+    {
+        ENCODETHREAD_DATA *ethd = &cpi->en_thread_data[ithread];
+
+        vp8_setup_block_ptrs(&cpi->mb_row_ei[ithread].mb);
+        vp8_setup_block_dptrs(&cpi->mb_row_ei[ithread].mb.e_mbd);
+
+        ethd->ithread = ithread;
+        ethd->ptr1 = (void *)cpi;
+        ethd->ptr2 = (void *)&cpi->mb_row_ei[ithread];
+    }
+
+    cpi->lpf_thread_data.ptr1 = (void *)cpi;
+
+    return 0;
+}
+
 int vp8cx_create_encoder_threads(VP8_COMP *cpi)
 {
     const VP8_COMMON * cm = &cpi->common;
 
     cpi->b_multi_threaded = 0;
+    cpi->b_shared_threads = 0;
     cpi->encoding_thread_count = 0;
     cpi->b_lpf_running = 0;
 
@@ -522,6 +805,9 @@ int vp8cx_create_encoder_threads(VP8_COMP *cpi)
         if(th_count == 0)
             return 0;
 
+        if (cpi->oxcf.shared_threads)
+            return create_shared_encoder_threads(cpi, th_count);
+
         CHECK_MEM_ERROR(cpi->h_encoding_thread,
                         vpx_malloc(sizeof(pthread_t) * th_count));
         CHECK_MEM_ERROR(cpi->h_event_start_encoding,
@@ -622,7 +908,25 @@ int vp8cx_create_encoder_threads(VP8_COMP *cpi)
 
 void vp8cx_remove_encoder_threads(VP8_COMP *cpi)
 {
-    if (cpi->b_multi_threaded)
+    if (cpi->b_multi_threaded && cpi->b_shared_threads)
+    {
+        cpi->b_multi_threaded = 0;
+
+        /* The loop filter may still be running on the pool. */
+        if (cpi->b_lpf_running)
+        {
+            sem_wait(&cpi->h_event_end_lpf);
+            cpi->b_lpf_running = 0;
+        }
+        detach_shared_pool();
+
+        sem_destroy(&cpi->h_event_end_encoding);
+        sem_destroy(&cpi->h_event_end_lpf);
+
+        vpx_free(cpi->mb_row_ei);
+        vpx_free(cpi->en_thread_data);
+    }
+    else if (cpi->b_multi_threaded)
     {
         /* shutdown other threads */
         cpi->b_multi_threaded = 0;
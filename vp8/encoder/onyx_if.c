@@ -59,6 +59,7 @@ extern unsigned int vp8_get_processor_freq();
 extern void print_tree_update_probs();
 extern int vp8cx_create_encoder_threads(VP8_COMP *cpi);
 extern void vp8cx_remove_encoder_threads(VP8_COMP *cpi);
+extern void vp8cx_start_loopfilter_thread(VP8_COMP *cpi);
 
 int vp8_estimate_entropy_savings(VP8_COMP *cpi);
 
@@ -4423,7 +4424,7 @@ static void encode_frame_to_data_rate
     if (cpi->b_multi_threaded)
     {
         /* start loopfilter in separate thread */
-        sem_post(&cpi->h_event_start_lpf);
+        vp8cx_start_loopfilter_thread(cpi);
         cpi->b_lpf_running = 1;
     }
     else
@@ -521,6 +521,7 @@ typedef struct VP8_COMP
     int * mt_current_mb_col;
     int mt_sync_range;
     int b_multi_threaded;
+    int b_shared_threads;
     int encoding_thread_count;
     int b_lpf_running;
 
@@ -641,6 +641,8 @@ static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
                              ctx->priv->alg_priv->cfg,
                              ctx->priv->alg_priv->vp8_cfg,
                              mr_cfg);
+            ctx->priv->alg_priv->oxcf.shared_threads =
+                !!(ctx->init_flags & VPX_CODEC_USE_SHARED_THREADS);
 
             optr = vp8_create_compressor(&ctx->priv->alg_priv->oxcf);
 
@@ -1286,7 +1288,7 @@ CODEC_INTERFACE(vpx_codec_vp8_cx) =
     "WebM Project VP8 Encoder" VERSION_STRING,
     VPX_CODEC_INTERNAL_ABI_VERSION,
     VPX_CODEC_CAP_ENCODER | VPX_CODEC_CAP_PSNR |
-    VPX_CODEC_CAP_OUTPUT_PARTITION,
+    VPX_CODEC_CAP_OUTPUT_PARTITION | VPX_CODEC_CAP_SHARED_THREADS,
     /* vpx_codec_caps_t          caps; */
     vp8e_init,          /* vpx_codec_init_fn_t       init; */
     vp8e_destroy,       /* vpx_codec_destroy_fn_t    destroy; */
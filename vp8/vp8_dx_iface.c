@@ -59,11 +59,18 @@ struct vpx_codec_alg_priv
 #endif
     vpx_decrypt_cb          decrypt_cb;
     void                    *decrypt_state;
+    int                     skip_frames;
+    int                     droppable;
     vpx_image_t             img;
     int                     img_setup;
     struct frame_buffers    yv12_frame_buffers;
     void                    *user_priv;
     FRAGMENT_DATA           fragments;
+
+    /* External frame buffer info to save for VP8 common. */
+    void                    *ext_priv;  /* Private data associated with the external frame buffers. */
+    vpx_get_frame_buffer_cb_fn_t get_ext_fb_cb;
+    vpx_release_frame_buffer_cb_fn_t release_ext_fb_cb;
 };
 
 static unsigned long vp8_priv_sz(const vpx_codec_dec_cfg_t *si, vpx_codec_flags_t flags)
@@ -349,6 +356,20 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
         res = VPX_CODEC_OK;
     }
 
+    ctx->droppable = !res && !ctx->si.is_kf &&
+        vp8_frame_is_droppable(ctx->fragments.ptrs[0], ctx->fragments.sizes[0],
+                               ctx->decrypt_cb, ctx->decrypt_state);
+
+    if (!res && ((ctx->skip_frames == 1 && ctx->droppable) ||
+                 (ctx->skip_frames == 2 && !ctx->si.is_kf)))
+    {
+        /* Do not return the last decoded frame again. */
+        if (ctx->decoder_init)
+            ctx->yv12_frame_buffers.pbi[0]->ready_for_new_data = 1;
+        ctx->fragments.count = 0;
+        return VPX_CODEC_OK;
+    }
+
     if(!ctx->decoder_init && !ctx->si.is_kf)
         res = VPX_CODEC_UNSUP_BITSTREAM;
 
@@ -381,6 +402,14 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
 
        res = vp8_create_decoder_instances(&ctx->yv12_frame_buffers, &oxcf);
        ctx->decoder_init = 1;
+
+       if (!res && ctx->get_ext_fb_cb != NULL)
+       {
+           VP8_COMMON *const pc = &ctx->yv12_frame_buffers.pbi[0]->common;
+           pc->get_fb_cb = ctx->get_ext_fb_cb;
+           pc->release_fb_cb = ctx->release_ext_fb_cb;
+           pc->cb_priv = ctx->ext_priv;
+       }
     }
 
     /* Set these even if already initialized.  The caller may have changed the
@@ -409,8 +438,12 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
                 if (setjmp(pbi->common.error.jmp))
                 {
                     pbi->common.error.setjmp = 0;
-                    /* same return value as used in vp8dx_receive_compressed_data */
-                    return -1;
+                    /* Set up the frame buffers again on the next key
+                     * frame, as they may be gone.
+                     */
+                    ctx->si.w = 0;
+                    ctx->si.h = 0;
+                    return update_error_state(ctx, &pbi->common.error);
                 }
 
                 pbi->common.error.setjmp = 1;
@@ -542,8 +575,22 @@ static vpx_image_t *vp8_get_frame(vpx_codec_alg_priv_t  *ctx,
         if (0 == vp8dx_get_raw_frame(ctx->yv12_frame_buffers.pbi[0], &sd,
                                      &time_stamp, &time_end_stamp, &flags))
         {
+            const VP8_COMMON *const pc =
+                &ctx->yv12_frame_buffers.pbi[0]->common;
+            int i;
+
             yuvconfig2image(&ctx->img, &sd, ctx->user_priv);
 
+            /* Tell the application which of its buffers holds the frame,
+             * unless postprocessing wrote it elsewhere.
+             */
+            ctx->img.fb_priv = NULL;
+            for (i = 0; i < NUM_YV12_BUFFERS; i++)
+            {
+                if (sd.y_buffer == pc->yv12_fb[i].y_buffer)
+                    ctx->img.fb_priv = pc->raw_fb[i].priv;
+            }
+
             img = &ctx->img;
             *iter = img;
         }
@@ -552,6 +599,29 @@ static vpx_image_t *vp8_get_frame(vpx_codec_alg_priv_t  *ctx,
     return img;
 }
 
+static vpx_codec_err_t vp8_set_fb_fn(
+    vpx_codec_alg_priv_t *ctx,
+    vpx_get_frame_buffer_cb_fn_t cb_get,
+    vpx_release_frame_buffer_cb_fn_t cb_release, void *cb_priv)
+{
+    if (cb_get == NULL || cb_release == NULL)
+    {
+        return VPX_CODEC_INVALID_PARAM;
+    }
+    else if (!ctx->decoder_init)
+    {
+        /* If the decoder has already been initialized, do not accept
+         * changes to the frame buffer functions.
+         */
+        ctx->get_ext_fb_cb = cb_get;
+        ctx->release_ext_fb_cb = cb_release;
+        ctx->ext_priv = cb_priv;
+        return VPX_CODEC_OK;
+    }
+
+    return VPX_CODEC_ERROR;
+}
+
 static vpx_codec_err_t image2yuvconfig(const vpx_image_t   *img,
                                        YV12_BUFFER_CONFIG  *yv12)
 {
@@ -724,6 +794,34 @@ static vpx_codec_err_t vp8_get_frame_corrupted(vpx_codec_alg_priv_t *ctx,
 
 }
 
+static vpx_codec_err_t vp8_set_skip_frames(vpx_codec_alg_priv_t *ctx,
+                                           int ctrl_id,
+                                           va_list args)
+{
+    const int skip_frames = va_arg(args, int);
+
+    if (skip_frames < 0 || skip_frames > 2)
+        return VPX_CODEC_INVALID_PARAM;
+
+    ctx->skip_frames = skip_frames;
+    return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t vp8_get_frame_droppable(vpx_codec_alg_priv_t *ctx,
+                                               int ctrl_id,
+                                               va_list args)
+{
+    int *droppable = va_arg(args, int *);
+
+    if (droppable)
+    {
+        *droppable = ctx->droppable;
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+}
+
 static vpx_codec_err_t vp8_set_decryptor(vpx_codec_alg_priv_t *ctx,
                                          int ctrl_id,
                                          va_list args)
@@ -756,6 +854,8 @@ vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] =
     {VP8D_GET_FRAME_CORRUPTED,      vp8_get_frame_corrupted},
     {VP8D_GET_LAST_REF_USED,        vp8_get_last_ref_frame},
     {VPXD_SET_DECRYPTOR,            vp8_set_decryptor},
+    {VPXD_SET_SKIP_FRAMES,          vp8_set_skip_frames},
+    {VPXD_GET_FRAME_DROPPABLE,      vp8_get_frame_droppable},
     { -1, NULL},
 };
 
@@ -768,7 +868,7 @@ CODEC_INTERFACE(vpx_codec_vp8_dx) =
     "WebM Project VP8 Decoder" VERSION_STRING,
     VPX_CODEC_INTERNAL_ABI_VERSION,
     VPX_CODEC_CAP_DECODER | VP8_CAP_POSTPROC | VP8_CAP_ERROR_CONCEALMENT |
-    VPX_CODEC_CAP_INPUT_FRAGMENTS,
+    VPX_CODEC_CAP_INPUT_FRAGMENTS | VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER,
     /* vpx_codec_caps_t          caps; */
     vp8_init,         /* vpx_codec_init_fn_t       init; */
     vp8_destroy,      /* vpx_codec_destroy_fn_t    destroy; */
@@ -780,7 +880,7 @@ CODEC_INTERFACE(vpx_codec_vp8_dx) =
         vp8_get_si,       /* vpx_codec_get_si_fn_t     get_si; */
         vp8_decode,       /* vpx_codec_decode_fn_t     decode; */
         vp8_get_frame,    /* vpx_codec_frame_get_fn_t  frame_get; */
-        NOT_IMPLEMENTED,
+        vp8_set_fb_fn,    /* vpx_codec_set_fb_fn_t     set_fb_fn; */
     },
     { /* encoder functions */
         NOT_IMPLEMENTED,
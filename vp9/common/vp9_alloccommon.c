@@ -86,6 +86,16 @@ static void free_mi(VP9_COMMON *cm) {
   cm->prev_mi_grid_base = NULL;
 }
 
+void vp9_free_context_buffers(VP9_COMMON *cm) {
+  free_mi(cm);
+
+  vpx_free(cm->above_context);
+  cm->above_context = NULL;
+
+  vpx_free(cm->above_seg_context);
+  cm->above_seg_context = NULL;
+}
+
 void vp9_free_frame_buffers(VP9_COMMON *cm) {
   int i;
 
@@ -101,43 +111,25 @@ void vp9_free_frame_buffers(VP9_COMMON *cm) {
 
   vp9_free_frame_buffer(&cm->post_proc_buffer);
 
-  free_mi(cm);
+  vp9_free_context_buffers(cm);
 
   vpx_free(cm->last_frame_seg_map);
   cm->last_frame_seg_map = NULL;
-
-  vpx_free(cm->above_context);
-  cm->above_context = NULL;
-
-  vpx_free(cm->above_seg_context);
-  cm->above_seg_context = NULL;
 }
 
-int vp9_resize_frame_buffers(VP9_COMMON *cm, int width, int height) {
+int vp9_alloc_context_buffers(VP9_COMMON *cm, int width, int height) {
   const int aligned_width = ALIGN_POWER_OF_TWO(width, MI_SIZE_LOG2);
   const int aligned_height = ALIGN_POWER_OF_TWO(height, MI_SIZE_LOG2);
-  const int ss_x = cm->subsampling_x;
-  const int ss_y = cm->subsampling_y;
 
-  if (vp9_realloc_frame_buffer(&cm->post_proc_buffer, width, height, ss_x, ss_y,
-                               VP9_DEC_BORDER_IN_PIXELS, NULL, NULL, NULL) < 0)
-    goto fail;
+  vp9_free_context_buffers(cm);
 
   set_mb_mi(cm, aligned_width, aligned_height);
 
-  free_mi(cm);
   if (alloc_mi(cm, cm->mi_stride * (cm->mi_rows + MI_BLOCK_SIZE)))
     goto fail;
 
   setup_mi(cm);
 
-  // Create the segmentation map structure and set to 0.
-  vpx_free(cm->last_frame_seg_map);
-  cm->last_frame_seg_map = (uint8_t *)vpx_calloc(cm->mi_rows * cm->mi_cols, 1);
-  if (!cm->last_frame_seg_map)
-    goto fail;
-
-  vpx_free(cm->above_context);
   cm->above_context =
       (ENTROPY_CONTEXT *)vpx_calloc(2 * mi_cols_aligned_to_sb(cm->mi_cols) *
                                         MAX_MB_PLANE,
@@ -145,7 +137,6 @@ int vp9_resize_frame_buffers(VP9_COMMON *cm, int width, int height) {
   if (!cm->above_context)
     goto fail;
 
-  vpx_free(cm->above_seg_context);
   cm->above_seg_context =
      (PARTITION_CONTEXT *)vpx_calloc(mi_cols_aligned_to_sb(cm->mi_cols),
                                      sizeof(*cm->above_seg_context));
@@ -154,14 +145,36 @@ int vp9_resize_frame_buffers(VP9_COMMON *cm, int width, int height) {
 
   return 0;
 
+ fail:
+  vp9_free_context_buffers(cm);
+  return 1;
+}
+
+int vp9_resize_frame_buffers(VP9_COMMON *cm, int width, int height) {
+  const int ss_x = cm->subsampling_x;
+  const int ss_y = cm->subsampling_y;
+
+  if (vp9_realloc_frame_buffer(&cm->post_proc_buffer, width, height, ss_x, ss_y,
+                               VP9_DEC_BORDER_IN_PIXELS, NULL, NULL, NULL) < 0)
+    goto fail;
+
+  if (vp9_alloc_context_buffers(cm, width, height))
+    goto fail;
+
+  // Create the segmentation map structure and set to 0.
+  vpx_free(cm->last_frame_seg_map);
+  cm->last_frame_seg_map = (uint8_t *)vpx_calloc(cm->mi_rows * cm->mi_cols, 1);
+  if (!cm->last_frame_seg_map)
+    goto fail;
+
+  return 0;
+
  fail:
   vp9_free_frame_buffers(cm);
   return 1;
 }
 
 int vp9_alloc_frame_buffers(VP9_COMMON *cm, int width, int height) {
-  const int aligned_width = ALIGN_POWER_OF_TWO(width, MI_SIZE_LOG2);
-  const int aligned_height = ALIGN_POWER_OF_TWO(height, MI_SIZE_LOG2);
   const int ss_x = cm->subsampling_x;
   const int ss_y = cm->subsampling_y;
   int i;
@@ -187,31 +200,14 @@ int vp9_alloc_frame_buffers(VP9_COMMON *cm, int width, int height) {
                              VP9_ENC_BORDER_IN_PIXELS) < 0)
     goto fail;
 
-  set_mb_mi(cm, aligned_width, aligned_height);
-
-  if (alloc_mi(cm, cm->mi_stride * (cm->mi_rows + MI_BLOCK_SIZE)))
+  if (vp9_alloc_context_buffers(cm, width, height))
     goto fail;
 
-  setup_mi(cm);
-
   // Create the segmentation map structure and set to 0.
   cm->last_frame_seg_map = (uint8_t *)vpx_calloc(cm->mi_rows * cm->mi_cols, 1);
   if (!cm->last_frame_seg_map)
     goto fail;
 
-  cm->above_context =
-      (ENTROPY_CONTEXT *)vpx_calloc(2 * mi_cols_aligned_to_sb(cm->mi_cols) *
-                                        MAX_MB_PLANE,
-                                    sizeof(*cm->above_context));
-  if (!cm->above_context)
-    goto fail;
-
-  cm->above_seg_context =
-      (PARTITION_CONTEXT *)vpx_calloc(mi_cols_aligned_to_sb(cm->mi_cols),
-                                      sizeof(*cm->above_seg_context));
-  if (!cm->above_seg_context)
-    goto fail;
-
   return 0;
 
  fail:
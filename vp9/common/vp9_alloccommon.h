@@ -26,6 +26,11 @@ int vp9_alloc_frame_buffers(struct VP9Common *cm, int width, int height);
 
 void vp9_free_frame_buffers(struct VP9Common *cm);
 
+// Allocates or frees the mode info and above context arrays used to decode a
+// frame of the given size.
+int vp9_alloc_context_buffers(struct VP9Common *cm, int width, int height);
+void vp9_free_context_buffers(struct VP9Common *cm);
+
 void vp9_update_frame_size(struct VP9Common *cm);
 
 void vp9_swap_mi_and_prev_mi(struct VP9Common *cm);
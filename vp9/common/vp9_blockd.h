@@ -227,6 +227,10 @@ typedef struct macroblockd {
   /* mc buffer */
   DECLARE_ALIGNED(16, uint8_t, mc_buf[80 * 2 * 80 * 2]);
 
+  /* Used by the decoder to predict every block, instead of the kernel of the
+   * block's filter, if set. */
+  const InterpKernel *interp_kernel;
+
   int lossless;
   /* Inverse transform function pointers. */
   void (*itxm_add)(const int16_t *input, uint8_t *dest, int stride, int eob);
@@ -17,8 +17,10 @@
 extern "C" {
 #endif
 
-#define LEFT_TOP_MARGIN ((VP9_ENC_BORDER_IN_PIXELS - VP9_INTERP_EXTEND) << 3)
-#define RIGHT_BOTTOM_MARGIN ((VP9_ENC_BORDER_IN_PIXELS -\
+// Part of the bitstream: these predate the encoder's current border size.
+#define MV_CLAMP_BORDER_IN_PIXELS 160
+#define LEFT_TOP_MARGIN ((MV_CLAMP_BORDER_IN_PIXELS - VP9_INTERP_EXTEND) << 3)
+#define RIGHT_BOTTOM_MARGIN ((MV_CLAMP_BORDER_IN_PIXELS -\
                                 VP9_INTERP_EXTEND) << 3)
 
 // TODO(jingning): this mv clamping function should be block size dependent.
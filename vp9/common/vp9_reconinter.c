@@ -173,17 +173,27 @@ static void build_inter_predictors(MACROBLOCKD *xd, int plane, int block,
                                                pd->subsampling_x,
                                                pd->subsampling_y);
 
+    const YV12_BUFFER_CONFIG *const ref_buf = xd->block_refs[ref]->buf;
     uint8_t *pre;
+    int pre_stride = pre_buf->stride;
     MV32 scaled_mv;
-    int xs, ys, subpel_x, subpel_y;
+    int xs, ys, x0, y0, x1, y1, x_pad = 0, y_pad = 0, subpel_x, subpel_y;
+
+    // Co-ordinate of the block in the reference frame to pixel precision.
+    x0 = (-xd->mb_to_left_edge >> (3 + pd->subsampling_x));
+    y0 = (-xd->mb_to_top_edge >> (3 + pd->subsampling_y));
 
     if (vp9_is_scaled(sf)) {
       pre = pre_buf->buf + scaled_buffer_offset(x, y, pre_buf->stride, sf);
+      x0 = sf->scale_value_x(x0, sf) + sf->scale_value_x(x, sf);
+      y0 = sf->scale_value_y(y0, sf) + sf->scale_value_y(y, sf);
       scaled_mv = vp9_scale_mv(&mv_q4, mi_x + x, mi_y + y, sf);
       xs = sf->x_step_q4;
       ys = sf->y_step_q4;
     } else {
       pre = pre_buf->buf + (y * pre_buf->stride + x);
+      x0 += x;
+      y0 += y;
       scaled_mv.row = mv_q4.row;
       scaled_mv.col = mv_q4.col;
       xs = ys = 16;
@@ -193,7 +203,50 @@ static void build_inter_predictors(MACROBLOCKD *xd, int plane, int block,
     pre += (scaled_mv.row >> SUBPEL_BITS) * pre_buf->stride
            + (scaled_mv.col >> SUBPEL_BITS);
 
-    inter_predictor(pre, pre_buf->stride, dst, dst_buf->stride,
+    // Get reference block top left and bottom right coordinate.
+    x0 += scaled_mv.col >> SUBPEL_BITS;
+    y0 += scaled_mv.row >> SUBPEL_BITS;
+    x1 = x0 + ((subpel_x + (w - 1) * xs) >> SUBPEL_BITS) + 1;
+    y1 = y0 + ((subpel_y + (h - 1) * ys) >> SUBPEL_BITS) + 1;
+    if (subpel_x || (sf->x_step_q4 & SUBPEL_MASK)) {
+      x0 -= VP9_INTERP_EXTEND - 1;
+      x1 += VP9_INTERP_EXTEND;
+      x_pad = 1;
+    }
+    if (subpel_y || (sf->y_step_q4 & SUBPEL_MASK)) {
+      y0 -= VP9_INTERP_EXTEND - 1;
+      y1 += VP9_INTERP_EXTEND;
+      y_pad = 1;
+    }
+
+    // The encoder's reference frames only have a small border. Blocks that
+    // read past it, at candidate mvs or from a scaled reference, are
+    // predicted with the edge emulated, as in the decoder.
+    {
+      const int border_x = ref_buf->border >> pd->subsampling_x;
+      const int border_y = ref_buf->border >> pd->subsampling_y;
+      const int buf_width = plane == 0 ? ref_buf->y_width : ref_buf->uv_width;
+      const int buf_height = plane == 0 ? ref_buf->y_height
+                                        : ref_buf->uv_height;
+
+      if (x0 < -border_x || x1 >= buf_width + border_x ||
+          y0 < -border_y || y1 >= buf_height + border_y) {
+        const int frame_width = plane == 0 ? ref_buf->y_crop_width
+                                           : ref_buf->uv_crop_width;
+        const int frame_height = plane == 0 ? ref_buf->y_crop_height
+                                            : ref_buf->uv_crop_height;
+        const uint8_t *const ref_frame = plane == 0 ? ref_buf->y_buffer :
+            plane == 1 ? ref_buf->u_buffer : ref_buf->v_buffer;
+
+        pre_stride = x1 - x0 + 1;
+        build_mc_border(ref_frame + y0 * pre_buf->stride + x0,
+                        pre_buf->stride, xd->mc_buf, pre_stride, x0, y0,
+                        pre_stride, y1 - y0 + 1, frame_width, frame_height);
+        pre = xd->mc_buf + y_pad * 3 * pre_stride + x_pad * 3;
+      }
+    }
+
+    inter_predictor(pre, pre_stride, dst, dst_buf->stride,
                     subpel_x, subpel_y, sf, w, h, ref, kernel, xs, ys);
   }
 }
@@ -250,7 +303,8 @@ static void dec_build_inter_predictors(MACROBLOCKD *xd, int plane, int block,
   struct macroblockd_plane *const pd = &xd->plane[plane];
   const MODE_INFO *mi = xd->mi[0];
   const int is_compound = has_second_ref(&mi->mbmi);
-  const InterpKernel *kernel = vp9_get_interp_kernel(mi->mbmi.interp_filter);
+  const InterpKernel *kernel = xd->interp_kernel ?
+      xd->interp_kernel : vp9_get_interp_kernel(mi->mbmi.interp_filter);
   int ref;
 
   for (ref = 0; ref < 1 + is_compound; ++ref) {
@@ -0,0 +1,309 @@
+// Copyright 2013 Google Inc. All Rights Reserved.
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the COPYING file in the root of the source
+// tree. An additional intellectual property rights grant can be found
+// in the file PATENTS. All contributing project authors may
+// be found in the AUTHORS file in the root of the source tree.
+// -----------------------------------------------------------------------------
+//
+// Multi-threaded worker
+//
+// Original source:
+//  http://git.chromium.org/webm/libwebp.git
+//  100644 blob eff8f2a8c20095aade3c292b0e9292dac6cb3587  src/utils/thread.c
+
+
+#include <assert.h>
+#include <string.h>   // for memset()
+#include "./vp9_thread.h"
+#include "vpx_mem/vpx_mem.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+struct VP9WorkerPool {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex_;
+  pthread_cond_t  condition_;   // signaled when a job is queued
+  pthread_t*      threads_;
+#endif
+  int num_threads;
+  VP9Worker* head_;             // queued jobs, oldest first
+  VP9Worker* tail_;
+  int shutdown_;
+};
+
+#if CONFIG_MULTITHREAD
+
+//------------------------------------------------------------------------------
+
+static THREADFN thread_loop(void *ptr) {    // thread loop
+  VP9Worker* const worker = (VP9Worker*)ptr;
+  int done = 0;
+  while (!done) {
+    pthread_mutex_lock(&worker->mutex_);
+    while (worker->status_ == OK) {   // wait in idling mode
+      pthread_cond_wait(&worker->condition_, &worker->mutex_);
+    }
+    if (worker->status_ == WORK) {
+      vp9_worker_execute(worker);
+      worker->status_ = OK;
+    } else if (worker->status_ == NOT_OK) {   // finish the worker
+      done = 1;
+    }
+    // signal to the main thread that we're done (for Sync())
+    pthread_cond_signal(&worker->condition_);
+    pthread_mutex_unlock(&worker->mutex_);
+  }
+  return THREAD_RETURN(NULL);    // Thread is finished
+}
+
+// main thread state control
+static void change_state(VP9Worker* const worker,
+                         VP9WorkerStatus new_status) {
+  // no-op when attempting to change state on a thread that didn't come up
+  if (worker->status_ < OK) return;
+
+  pthread_mutex_lock(&worker->mutex_);
+  // wait for the worker to finish
+  while (worker->status_ != OK) {
+    pthread_cond_wait(&worker->condition_, &worker->mutex_);
+  }
+  // assign new status and release the working thread if needed
+  if (new_status != OK) {
+    worker->status_ = new_status;
+    pthread_cond_signal(&worker->condition_);
+  }
+  pthread_mutex_unlock(&worker->mutex_);
+}
+
+//------------------------------------------------------------------------------
+// Pooled workers
+
+// Runs the job of a pooled worker and wakes up vp9_worker_sync().
+static void run_pooled_job(VP9Worker* const worker) {
+  vp9_worker_execute(worker);
+  pthread_mutex_lock(&worker->mutex_);
+  worker->status_ = OK;
+  pthread_cond_signal(&worker->condition_);
+  pthread_mutex_unlock(&worker->mutex_);
+}
+
+static THREADFN pool_thread_loop(void *ptr) {
+  VP9WorkerPool* const pool = (VP9WorkerPool*)ptr;
+  pthread_mutex_lock(&pool->mutex_);
+  for (;;) {
+    VP9Worker* worker;
+    while (pool->head_ == NULL && !pool->shutdown_) {
+      pthread_cond_wait(&pool->condition_, &pool->mutex_);
+    }
+    if (pool->head_ == NULL) break;   // shutting down
+    worker = pool->head_;
+    pool->head_ = worker->next_;
+    if (pool->head_ == NULL) pool->tail_ = NULL;
+    pthread_mutex_unlock(&pool->mutex_);
+    run_pooled_job(worker);
+    pthread_mutex_lock(&pool->mutex_);
+  }
+  pthread_mutex_unlock(&pool->mutex_);
+  return THREAD_RETURN(NULL);
+}
+
+// Takes the worker's job back from the pool's queue if no thread has started
+// it yet. Returns true if it did.
+static int unqueue_job(VP9WorkerPool* const pool, VP9Worker* const worker) {
+  VP9Worker* prev = NULL;
+  VP9Worker* job;
+  pthread_mutex_lock(&pool->mutex_);
+  for (job = pool->head_; job != NULL; prev = job, job = job->next_) {
+    if (job == worker) {
+      if (prev != NULL) prev->next_ = job->next_;
+      else pool->head_ = job->next_;
+      if (pool->tail_ == job) pool->tail_ = prev;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex_);
+  return job != NULL;
+}
+
+// Waits for the last job of a pooled worker. A job still in the queue is run
+// by the calling thread rather than waited for.
+static void sync_pooled(VP9Worker* const worker) {
+  if (worker->status_ < OK) return;
+  if (unqueue_job(worker->pool, worker)) {
+    run_pooled_job(worker);
+    return;
+  }
+  pthread_mutex_lock(&worker->mutex_);
+  while (worker->status_ != OK) {
+    pthread_cond_wait(&worker->condition_, &worker->mutex_);
+  }
+  pthread_mutex_unlock(&worker->mutex_);
+}
+
+static void launch_pooled(VP9Worker* const worker) {
+  VP9WorkerPool* const pool = worker->pool;
+  if (worker->status_ < OK) return;
+  sync_pooled(worker);
+
+  pthread_mutex_lock(&worker->mutex_);
+  worker->status_ = WORK;
+  pthread_mutex_unlock(&worker->mutex_);
+
+  pthread_mutex_lock(&pool->mutex_);
+  worker->next_ = NULL;
+  if (pool->tail_ != NULL) pool->tail_->next_ = worker;
+  else pool->head_ = worker;
+  pool->tail_ = worker;
+  pthread_cond_signal(&pool->condition_);
+  pthread_mutex_unlock(&pool->mutex_);
+}
+
+#endif  // CONFIG_MULTITHREAD
+
+//------------------------------------------------------------------------------
+
+void vp9_worker_init(VP9Worker* const worker) {
+  memset(worker, 0, sizeof(*worker));
+  worker->status_ = NOT_OK;
+}
+
+int vp9_worker_sync(VP9Worker* const worker) {
+#if CONFIG_MULTITHREAD
+  if (worker->pool != NULL)
+    sync_pooled(worker);
+  else
+    change_state(worker, OK);
+#endif
+  assert(worker->status_ <= OK);
+  return !worker->had_error;
+}
+
+int vp9_worker_reset(VP9Worker* const worker) {
+  int ok = 1;
+  worker->had_error = 0;
+  if (worker->status_ < OK) {
+#if CONFIG_MULTITHREAD
+    if (pthread_mutex_init(&worker->mutex_, NULL) ||
+        pthread_cond_init(&worker->condition_, NULL)) {
+      return 0;
+    }
+    if (worker->pool != NULL) {
+      worker->status_ = OK;
+      return 1;
+    }
+    pthread_mutex_lock(&worker->mutex_);
+    ok = !pthread_create(&worker->thread_, NULL, thread_loop, worker);
+    if (ok) worker->status_ = OK;
+    pthread_mutex_unlock(&worker->mutex_);
+#else
+    worker->status_ = OK;
+#endif
+  } else if (worker->status_ > OK) {
+    ok = vp9_worker_sync(worker);
+  }
+  assert(!ok || (worker->status_ == OK));
+  return ok;
+}
+
+void vp9_worker_execute(VP9Worker* const worker) {
+  if (worker->hook != NULL) {
+    worker->had_error |= !worker->hook(worker->data1, worker->data2);
+  }
+}
+
+void vp9_worker_launch(VP9Worker* const worker) {
+#if CONFIG_MULTITHREAD
+  if (worker->pool != NULL)
+    launch_pooled(worker);
+  else
+    change_state(worker, WORK);
+#else
+  vp9_worker_execute(worker);
+#endif
+}
+
+void vp9_worker_end(VP9Worker* const worker) {
+  if (worker->status_ >= OK) {
+#if CONFIG_MULTITHREAD
+    if (worker->pool != NULL) {
+      sync_pooled(worker);
+      worker->status_ = NOT_OK;
+    } else {
+      change_state(worker, NOT_OK);
+      pthread_join(worker->thread_, NULL);
+    }
+    pthread_mutex_destroy(&worker->mutex_);
+    pthread_cond_destroy(&worker->condition_);
+#else
+    worker->status_ = NOT_OK;
+#endif
+  }
+  assert(worker->status_ == NOT_OK);
+}
+
+VP9WorkerPool* vp9_worker_pool_create(int num_threads) {
+  VP9WorkerPool* pool;
+  if (num_threads < 1) return NULL;
+  pool = (VP9WorkerPool*)vpx_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  pool->threads_ = (pthread_t*)vpx_calloc(num_threads,
+                                          sizeof(*pool->threads_));
+  if (pool->threads_ == NULL ||
+      pthread_mutex_init(&pool->mutex_, NULL)) {
+    vpx_free(pool->threads_);
+    vpx_free(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->condition_, NULL)) {
+    pthread_mutex_destroy(&pool->mutex_);
+    vpx_free(pool->threads_);
+    vpx_free(pool);
+    return NULL;
+  }
+  for (; pool->num_threads < num_threads; ++pool->num_threads) {
+    if (pthread_create(&pool->threads_[pool->num_threads], NULL,
+                       pool_thread_loop, pool)) {
+      vp9_worker_pool_destroy(pool);
+      return NULL;
+    }
+  }
+#else
+  pool->num_threads = num_threads;
+#endif
+  return pool;
+}
+
+void vp9_worker_pool_destroy(VP9WorkerPool* const pool) {
+  if (pool != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+    assert(pool->head_ == NULL);
+    pthread_mutex_lock(&pool->mutex_);
+    pool->shutdown_ = 1;
+    // Each signal wakes up one idle thread; busy threads see shutdown_ once
+    // they are done.
+    for (i = 0; i < pool->num_threads; ++i) {
+      pthread_cond_signal(&pool->condition_);
+    }
+    pthread_mutex_unlock(&pool->mutex_);
+    for (i = 0; i < pool->num_threads; ++i) {
+      pthread_join(pool->threads_[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex_);
+    pthread_cond_destroy(&pool->condition_);
+    vpx_free(pool->threads_);
+#endif
+    vpx_free(pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}    // extern "C"
+#endif
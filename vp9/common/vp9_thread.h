@@ -14,8 +14,8 @@
 //  100644 blob 13a61a4c84194c3374080cbf03d881d3cd6af40d  src/utils/thread.h
 
 
-#ifndef VP9_DECODER_VP9_THREAD_H_
-#define VP9_DECODER_VP9_THREAD_H_
+#ifndef VP9_COMMON_VP9_THREAD_H_
+#define VP9_COMMON_VP9_THREAD_H_
 
 #include "./vpx_config.h"
 
@@ -163,8 +163,15 @@ typedef enum {
 // arguments (data1 and data2), and should return false in case of error.
 typedef int (*VP9WorkerHook)(void*, void*);
 
+// A bounded set of threads shared by any number of workers. Launching a
+// worker attached to a pool queues its job, and the pool's threads run the
+// queued jobs, from all of its workers, in the order they were launched. A job
+// may not start before vp9_worker_sync() runs it on the calling thread, so a
+// job may only wait on work that a job already running has taken on.
+typedef struct VP9WorkerPool VP9WorkerPool;
+
 // Synchronize object used to launch job in the worker thread
-typedef struct {
+typedef struct VP9Worker {
 #if CONFIG_MULTITHREAD
   pthread_mutex_t mutex_;
   pthread_cond_t  condition_;
@@ -175,6 +182,10 @@ typedef struct {
   void* data1;            // first argument passed to 'hook'
   void* data2;            // second argument passed to 'hook'
   int had_error;          // return value of the last call to 'hook'
+  // If set before vp9_worker_reset(), the worker runs its jobs on the pool's
+  // threads instead of creating a thread of its own.
+  VP9WorkerPool* pool;
+  struct VP9Worker* next_;  // next job in the pool's queue
 } VP9Worker;
 
 // Must be called first, before any other method.
@@ -198,10 +209,16 @@ void vp9_worker_execute(VP9Worker* const worker);
 // must call vp9_worker_reset() again.
 void vp9_worker_end(VP9Worker* const worker);
 
+// Creates a pool of 'num_threads' threads. Returns NULL in case of error.
+VP9WorkerPool* vp9_worker_pool_create(int num_threads);
+// Stops the pool's threads. The workers attached to the pool must have been
+// ended first.
+void vp9_worker_pool_destroy(VP9WorkerPool* const pool);
+
 //------------------------------------------------------------------------------
 
 #ifdef __cplusplus
 }    // extern "C"
 #endif
 
-#endif  // VP9_DECODER_VP9_THREAD_H_
+#endif  // VP9_COMMON_VP9_THREAD_H_
@@ -0,0 +1,349 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "./vpx_config.h"
+
+#include "vpx_mem/vpx_mem.h"
+
+#include "vp9/common/vp9_reconinter.h"
+#include "vp9/common/vp9_thread_common.h"
+
+// Upper bound on the number of workers used by the loopfilter.
+#define MAX_LF_WORKERS 64
+
+#if CONFIG_MULTITHREAD
+static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
+  const int kMaxTryLocks = 4000;
+  int locked = 0;
+  int i;
+
+  for (i = 0; i < kMaxTryLocks; ++i) {
+    if (!pthread_mutex_trylock(mutex)) {
+      locked = 1;
+      break;
+    }
+  }
+
+  if (!locked)
+    pthread_mutex_lock(mutex);
+}
+#endif  // CONFIG_MULTITHREAD
+
+static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
+#if CONFIG_MULTITHREAD
+  const int nsync = lf_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &lf_sync->mutex_[r - 1];
+    mutex_lock(mutex);
+
+    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+      pthread_cond_wait(&lf_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)lf_sync;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void sync_write(VP9LfSync *const lf_sync, int r, int c,
+                              const int sb_cols) {
+#if CONFIG_MULTITHREAD
+  const int nsync = lf_sync->sync_range;
+  int cur;
+  // Only signal when there are enough filtered SB for next row to run.
+  int sig = 1;
+
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync)
+      sig = 0;
+  } else {
+    cur = sb_cols + nsync;
+  }
+
+  if (sig) {
+    mutex_lock(&lf_sync->mutex_[r]);
+
+    lf_sync->cur_sb_col[r] = cur;
+
+    pthread_cond_signal(&lf_sync->cond_[r]);
+    pthread_mutex_unlock(&lf_sync->mutex_[r]);
+  }
+#else
+  (void)lf_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Returns the next superblock row to filter, or stop once all the rows have
+// been handed out. Rows go out in order to whichever worker asks first, so a
+// row only waits on rows that running workers have taken. A worker that a
+// pool starts late, or that vp9_worker_sync() runs once the others are done,
+// then holds up no other worker.
+static int get_next_row(VP9LfSync *const lf_sync, int stop) {
+  int r;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(lf_sync->next_row_mutex_);
+#endif  // CONFIG_MULTITHREAD
+  r = lf_sync->next_row;
+  if (r < stop)
+    ++lf_sync->next_row;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lf_sync->next_row_mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return r;
+}
+
+// Implement row loopfiltering for each thread.
+static void loop_filter_rows_mt(const YV12_BUFFER_CONFIG *const frame_buffer,
+                                VP9_COMMON *const cm,
+                                struct macroblockd_plane planes[MAX_MB_PLANE],
+                                int stop, int y_only,
+                                VP9LfSync *const lf_sync, int report_rows) {
+  const int num_planes = y_only ? 1 : MAX_MB_PLANE;
+  const int use_420 = y_only || (planes[1].subsampling_y == 1 &&
+                                 planes[1].subsampling_x == 1);
+  int r, c;  // SB row and col
+  const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
+
+  for (r = get_next_row(lf_sync, stop); r < stop;
+       r = get_next_row(lf_sync, stop)) {
+    const int mi_row = r << MI_BLOCK_SIZE_LOG2;
+    MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
+
+    for (c = 0; c < sb_cols; ++c) {
+      const int mi_col = c << MI_BLOCK_SIZE_LOG2;
+      LOOP_FILTER_MASK lfm;
+      int plane;
+
+      sync_read(lf_sync, r, c);
+
+      vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
+
+      // TODO(JBB): Make setup_mask work for non 420.
+      if (use_420)
+        vp9_setup_mask(cm, mi_row, mi_col, mi + mi_col, cm->mi_stride, &lfm);
+
+      for (plane = 0; plane < num_planes; ++plane) {
+        if (use_420)
+          vp9_filter_block_plane(cm, &planes[plane], mi_row, &lfm);
+        else
+          vp9_filter_block_plane_non420(cm, &planes[plane], mi + mi_col,
+                                        mi_row, mi_col);
+      }
+
+      sync_write(lf_sync, r, c, sb_cols);
+    }
+
+    // Once a row is filtered, so are the rows above it, but for the bottom 16
+    // luma rows, which filtering the next row may still modify for the
+    // subsampled chroma planes.
+    if (report_rows)
+      lf_sync->rows_done(lf_sync->rows_done_priv,
+                         (mi_row + MI_BLOCK_SIZE - 2) * MI_SIZE);
+  }
+}
+
+// Row-based multi-threaded loopfilter hook
+static int loop_filter_row_worker(void *arg1, void *arg2) {
+  LFWorkerData *const lf_data = (LFWorkerData*)arg1;
+  VP9LfSync *const lf_sync = lf_data->lf_sync;
+  // Progress is reported by the last worker, which runs on the calling thread.
+  const int report_rows =
+      lf_sync->rows_done != NULL &&
+      lf_data == &lf_sync->lfdata[lf_data->num_lf_workers - 1];
+  (void)arg2;
+
+  loop_filter_rows_mt(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
+                      lf_data->stop, lf_data->y_only, lf_sync, report_rows);
+  return 1;
+}
+
+void vp9_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
+                              VP9_COMMON *cm,
+                              struct macroblockd_plane planes[MAX_MB_PLANE],
+                              int frame_filter_level,
+                              int y_only, int partial_frame,
+                              VP9Worker *workers, int num_workers,
+                              VP9LfSync *lf_sync) {
+  // Number of superblock rows and cols
+  const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
+  const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
+  int start_mi_row, end_mi_row, mi_rows_to_filter;
+  int start_sb_row, end_sb_row;
+  VP9WorkerHook hooks[MAX_LF_WORKERS];
+  void *data1[MAX_LF_WORKERS];
+  void *data2[MAX_LF_WORKERS];
+  int i;
+
+  if (!frame_filter_level) return;
+
+  num_workers = MIN(num_workers, MAX_LF_WORKERS);
+
+  // Allocate memory used in thread synchronization.
+  if (lf_sync->rows != sb_rows || lf_sync->num_workers < num_workers) {
+    void (*const rows_done)(void *priv, int rows) = lf_sync->rows_done;
+    void *const rows_done_priv = lf_sync->rows_done_priv;
+    vp9_loop_filter_dealloc(lf_sync);
+    vp9_loop_filter_alloc(cm, lf_sync, sb_rows, cm->width, num_workers);
+    lf_sync->rows_done = rows_done;
+    lf_sync->rows_done_priv = rows_done_priv;
+  }
+
+  // Same rows as vp9_loop_filter_frame().
+  start_mi_row = 0;
+  mi_rows_to_filter = cm->mi_rows;
+  if (partial_frame && cm->mi_rows > 8) {
+    start_mi_row = cm->mi_rows >> 1;
+    start_mi_row &= 0xfffffff8;
+    mi_rows_to_filter = MAX(cm->mi_rows / 8, 8);
+  }
+  end_mi_row = start_mi_row + mi_rows_to_filter;
+  start_sb_row = start_mi_row >> MI_BLOCK_SIZE_LOG2;
+  end_sb_row = (end_mi_row + MI_BLOCK_SIZE - 1) >> MI_BLOCK_SIZE_LOG2;
+
+  vp9_loop_filter_frame_init(cm, frame_filter_level);
+
+  // Initialize cur_sb_col to -1 for all SB rows. The row above the first
+  // filtered row is not filtered here, so it never blocks.
+  vpx_memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  if (start_sb_row > 0)
+    lf_sync->cur_sb_col[start_sb_row - 1] = sb_cols + lf_sync->sync_range;
+  lf_sync->next_row = start_sb_row;
+
+  // Set up loopfilter thread data.
+  for (i = 0; i < num_workers; ++i) {
+    VP9Worker *const worker = &workers[i];
+    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
+
+    hooks[i] = worker->hook;
+    data1[i] = worker->data1;
+    data2[i] = worker->data2;
+
+    worker->hook = (VP9WorkerHook)loop_filter_row_worker;
+    worker->data1 = lf_data;
+    worker->data2 = NULL;
+
+    // Loopfilter data
+    lf_data->frame_buffer = frame;
+    lf_data->cm = cm;
+    vp9_copy_array(lf_data->planes, planes, MAX_MB_PLANE);
+    lf_data->start = start_sb_row;
+    lf_data->stop = end_sb_row;
+    lf_data->y_only = y_only;
+
+    lf_data->lf_sync = lf_sync;
+    lf_data->num_lf_workers = num_workers;
+
+    // Start loopfiltering
+    if (i == num_workers - 1) {
+      vp9_worker_execute(worker);
+    } else {
+      vp9_worker_launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < num_workers; ++i) {
+    vp9_worker_sync(&workers[i]);
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    workers[i].hook = hooks[i];
+    workers[i].data1 = data1[i];
+    workers[i].data2 = data2[i];
+  }
+}
+
+// Set up nsync by width.
+static int get_sync_range(int width) {
+  // nsync numbers are picked by testing. For example, for 4k
+  // video, using 4 gives best performance.
+  if (width < 640)
+    return 1;
+  else if (width <= 1280)
+    return 2;
+  else if (width <= 4096)
+    return 4;
+  else
+    return 8;
+}
+
+// Allocate memory for lf row synchronization
+void vp9_loop_filter_alloc(VP9_COMMON *cm, VP9LfSync *lf_sync, int rows,
+                           int width, int num_workers) {
+#if CONFIG_MULTITHREAD
+  int i;
+
+  CHECK_MEM_ERROR(cm, lf_sync->mutex_,
+                  vpx_malloc(sizeof(*lf_sync->mutex_) * rows));
+  for (i = 0; i < rows; ++i) {
+    pthread_mutex_init(&lf_sync->mutex_[i], NULL);
+  }
+
+  CHECK_MEM_ERROR(cm, lf_sync->cond_,
+                  vpx_malloc(sizeof(*lf_sync->cond_) * rows));
+  for (i = 0; i < rows; ++i) {
+    pthread_cond_init(&lf_sync->cond_[i], NULL);
+  }
+
+  CHECK_MEM_ERROR(cm, lf_sync->next_row_mutex_,
+                  vpx_malloc(sizeof(*lf_sync->next_row_mutex_)));
+  pthread_mutex_init(lf_sync->next_row_mutex_, NULL);
+#endif  // CONFIG_MULTITHREAD
+  lf_sync->rows = rows;
+
+  CHECK_MEM_ERROR(cm, lf_sync->lfdata,
+                  vpx_malloc(num_workers * sizeof(*lf_sync->lfdata)));
+  lf_sync->num_workers = num_workers;
+
+  CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col,
+                  vpx_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
+
+  // Set up nsync.
+  lf_sync->sync_range = get_sync_range(width);
+}
+
+// Deallocate lf synchronization related mutex and data
+void vp9_loop_filter_dealloc(VP9LfSync *lf_sync) {
+  if (lf_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (lf_sync->mutex_ != NULL) {
+      for (i = 0; i < lf_sync->rows; ++i) {
+        pthread_mutex_destroy(&lf_sync->mutex_[i]);
+      }
+      vpx_free(lf_sync->mutex_);
+    }
+    if (lf_sync->cond_ != NULL) {
+      for (i = 0; i < lf_sync->rows; ++i) {
+        pthread_cond_destroy(&lf_sync->cond_[i]);
+      }
+      vpx_free(lf_sync->cond_);
+    }
+    if (lf_sync->next_row_mutex_ != NULL) {
+      pthread_mutex_destroy(lf_sync->next_row_mutex_);
+      vpx_free(lf_sync->next_row_mutex_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    vpx_free(lf_sync->lfdata);
+    vpx_free(lf_sync->cur_sb_col);
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    vp9_zero(*lf_sync);
+  }
+}
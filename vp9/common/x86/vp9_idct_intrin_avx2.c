@@ -0,0 +1,638 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX2
+
+#include "./vp9_rtcd.h"
+#include "vp9/common/vp9_idct.h"
+#include "vpx_ports/mem.h"
+
+// The 1-D transforms below work across an array of registers, each holding
+// one coefficient of 16 independent transforms, so they transform 16 columns
+// at once. Rows are transformed by transposing before and after. The
+// arithmetic follows vp9_idct.c step by step and the results match the C
+// versions bit-exactly.
+
+#define pair256_set_epi16(a, b) \
+  _mm256_set_epi16(b, a, b, a, b, a, b, a, b, a, b, a, b, a, b, a)
+
+// Sets *lo and *hi to a * c0 + b * c1 for the low and high halves of each
+// 128-bit lane, in 32 bits.
+static INLINE void mult_add(__m256i a, __m256i b, int c0, int c1,
+                            __m256i *lo, __m256i *hi) {
+  const __m256i k = pair256_set_epi16(c0, c1);
+  *lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), k);
+  *hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), k);
+}
+
+// dct_const_round_shift() of the 32-bit results of mult_add(), packed back to
+// 16 bits.
+static INLINE __m256i round_shift_pack(__m256i lo, __m256i hi) {
+  const __m256i rounding = _mm256_set1_epi32(DCT_CONST_ROUNDING);
+  lo = _mm256_srai_epi32(_mm256_add_epi32(lo, rounding), DCT_CONST_BITS);
+  hi = _mm256_srai_epi32(_mm256_add_epi32(hi, rounding), DCT_CONST_BITS);
+  return _mm256_packs_epi32(lo, hi);
+}
+
+// dct_const_round_shift(a * c0 + b * c1)
+static INLINE __m256i mult_round(__m256i a, __m256i b, int c0, int c1) {
+  __m256i lo, hi;
+  mult_add(a, b, c0, c1, &lo, &hi);
+  return round_shift_pack(lo, hi);
+}
+
+#define ADD(a, b) _mm256_add_epi16(a, b)
+#define SUB(a, b) _mm256_sub_epi16(a, b)
+
+// Transposes the 8x8 blocks held in the two 128-bit lanes of in[0..7].
+static INLINE void transpose_8x8_lanes(const __m256i *in, __m256i *out) {
+  const __m256i a0 = _mm256_unpacklo_epi16(in[0], in[1]);
+  const __m256i a1 = _mm256_unpacklo_epi16(in[2], in[3]);
+  const __m256i a2 = _mm256_unpacklo_epi16(in[4], in[5]);
+  const __m256i a3 = _mm256_unpacklo_epi16(in[6], in[7]);
+  const __m256i a4 = _mm256_unpackhi_epi16(in[0], in[1]);
+  const __m256i a5 = _mm256_unpackhi_epi16(in[2], in[3]);
+  const __m256i a6 = _mm256_unpackhi_epi16(in[4], in[5]);
+  const __m256i a7 = _mm256_unpackhi_epi16(in[6], in[7]);
+
+  const __m256i b0 = _mm256_unpacklo_epi32(a0, a1);
+  const __m256i b1 = _mm256_unpacklo_epi32(a2, a3);
+  const __m256i b2 = _mm256_unpackhi_epi32(a0, a1);
+  const __m256i b3 = _mm256_unpackhi_epi32(a2, a3);
+  const __m256i b4 = _mm256_unpacklo_epi32(a4, a5);
+  const __m256i b5 = _mm256_unpacklo_epi32(a6, a7);
+  const __m256i b6 = _mm256_unpackhi_epi32(a4, a5);
+  const __m256i b7 = _mm256_unpackhi_epi32(a6, a7);
+
+  out[0] = _mm256_unpacklo_epi64(b0, b1);
+  out[1] = _mm256_unpackhi_epi64(b0, b1);
+  out[2] = _mm256_unpacklo_epi64(b2, b3);
+  out[3] = _mm256_unpackhi_epi64(b2, b3);
+  out[4] = _mm256_unpacklo_epi64(b4, b5);
+  out[5] = _mm256_unpackhi_epi64(b4, b5);
+  out[6] = _mm256_unpacklo_epi64(b6, b7);
+  out[7] = _mm256_unpackhi_epi64(b6, b7);
+}
+
+static INLINE void transpose_16x16(__m256i *in) {
+  __m256i top[8], bottom[8];
+  int i;
+
+  transpose_8x8_lanes(in, top);
+  transpose_8x8_lanes(in + 8, bottom);
+  for (i = 0; i < 8; ++i) {
+    in[i] = _mm256_permute2x128_si256(top[i], bottom[i], 0x20);
+    in[i + 8] = _mm256_permute2x128_si256(top[i], bottom[i], 0x31);
+  }
+}
+
+// Loads 'rows' rows of 16 coefficients and zeroes the rest.
+static INLINE void load_buffer_16x16(const int16_t *input, int input_stride,
+                                     int rows, __m256i *in) {
+  int i;
+  for (i = 0; i < rows; ++i)
+    in[i] = _mm256_loadu_si256((const __m256i *)(input + i * input_stride));
+  for (; i < 16; ++i)
+    in[i] = _mm256_setzero_si256();
+}
+
+// Adds ROUND_POWER_OF_TWO(in[i], 6) to row i of the 16 pixel wide block at
+// dest, for 'rows' rows.
+static INLINE void write_buffer_16xn(const __m256i *in, uint8_t *dest,
+                                     int stride, int rows) {
+  const __m256i final_rounding = _mm256_set1_epi16(1 << 5);
+  int i;
+
+  for (i = 0; i < rows; ++i) {
+    const __m256i res = _mm256_srai_epi16(
+        _mm256_adds_epi16(in[i], final_rounding), 6);
+    const __m256i d = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128((const __m128i *)dest));
+    const __m256i sum = _mm256_packus_epi16(_mm256_add_epi16(d, res),
+                                            _mm256_setzero_si256());
+    _mm_storeu_si128((__m128i *)dest, _mm256_castsi256_si128(
+        _mm256_permute4x64_epi64(sum, 0xd8)));
+    dest += stride;
+  }
+}
+
+static void idct16_avx2(__m256i *in) {
+  __m256i step1[16], step2[16];
+
+  // stage 1
+  step1[0] = in[0];
+  step1[1] = in[8];
+  step1[2] = in[4];
+  step1[3] = in[12];
+  step1[4] = in[2];
+  step1[5] = in[10];
+  step1[6] = in[6];
+  step1[7] = in[14];
+  step1[8] = in[1];
+  step1[9] = in[9];
+  step1[10] = in[5];
+  step1[11] = in[13];
+  step1[12] = in[3];
+  step1[13] = in[11];
+  step1[14] = in[7];
+  step1[15] = in[15];
+
+  // stage 2
+  step2[8] = mult_round(step1[8], step1[15], cospi_30_64, -cospi_2_64);
+  step2[15] = mult_round(step1[8], step1[15], cospi_2_64, cospi_30_64);
+  step2[9] = mult_round(step1[9], step1[14], cospi_14_64, -cospi_18_64);
+  step2[14] = mult_round(step1[9], step1[14], cospi_18_64, cospi_14_64);
+  step2[10] = mult_round(step1[10], step1[13], cospi_22_64, -cospi_10_64);
+  step2[13] = mult_round(step1[10], step1[13], cospi_10_64, cospi_22_64);
+  step2[11] = mult_round(step1[11], step1[12], cospi_6_64, -cospi_26_64);
+  step2[12] = mult_round(step1[11], step1[12], cospi_26_64, cospi_6_64);
+
+  // stage 3
+  step1[4] = mult_round(step1[4], step1[7], cospi_28_64, -cospi_4_64);
+  step1[7] = mult_round(in[2], step1[7], cospi_4_64, cospi_28_64);
+  step1[5] = mult_round(step1[5], step1[6], cospi_12_64, -cospi_20_64);
+  step1[6] = mult_round(in[10], step1[6], cospi_20_64, cospi_12_64);
+
+  step1[8] = ADD(step2[8], step2[9]);
+  step1[9] = SUB(step2[8], step2[9]);
+  step1[10] = SUB(step2[11], step2[10]);
+  step1[11] = ADD(step2[10], step2[11]);
+  step1[12] = ADD(step2[12], step2[13]);
+  step1[13] = SUB(step2[12], step2[13]);
+  step1[14] = SUB(step2[15], step2[14]);
+  step1[15] = ADD(step2[14], step2[15]);
+
+  // stage 4
+  step2[0] = mult_round(step1[0], step1[1], cospi_16_64, cospi_16_64);
+  step2[1] = mult_round(step1[0], step1[1], cospi_16_64, -cospi_16_64);
+  step2[2] = mult_round(step1[2], step1[3], cospi_24_64, -cospi_8_64);
+  step2[3] = mult_round(step1[2], step1[3], cospi_8_64, cospi_24_64);
+  step2[4] = ADD(step1[4], step1[5]);
+  step2[5] = SUB(step1[4], step1[5]);
+  step2[6] = SUB(step1[7], step1[6]);
+  step2[7] = ADD(step1[6], step1[7]);
+
+  step2[8] = step1[8];
+  step2[15] = step1[15];
+  step2[9] = mult_round(step1[9], step1[14], -cospi_8_64, cospi_24_64);
+  step2[14] = mult_round(step1[9], step1[14], cospi_24_64, cospi_8_64);
+  step2[10] = mult_round(step1[10], step1[13], -cospi_24_64, -cospi_8_64);
+  step2[13] = mult_round(step1[10], step1[13], -cospi_8_64, cospi_24_64);
+  step2[11] = step1[11];
+  step2[12] = step1[12];
+
+  // stage 5
+  step1[0] = ADD(step2[0], step2[3]);
+  step1[1] = ADD(step2[1], step2[2]);
+  step1[2] = SUB(step2[1], step2[2]);
+  step1[3] = SUB(step2[0], step2[3]);
+  step1[4] = step2[4];
+  step1[5] = mult_round(step2[5], step2[6], -cospi_16_64, cospi_16_64);
+  step1[6] = mult_round(step2[5], step2[6], cospi_16_64, cospi_16_64);
+  step1[7] = step2[7];
+
+  step1[8] = ADD(step2[8], step2[11]);
+  step1[9] = ADD(step2[9], step2[10]);
+  step1[10] = SUB(step2[9], step2[10]);
+  step1[11] = SUB(step2[8], step2[11]);
+  step1[12] = SUB(step2[15], step2[12]);
+  step1[13] = SUB(step2[14], step2[13]);
+  step1[14] = ADD(step2[13], step2[14]);
+  step1[15] = ADD(step2[12], step2[15]);
+
+  // stage 6
+  step2[0] = ADD(step1[0], step1[7]);
+  step2[1] = ADD(step1[1], step1[6]);
+  step2[2] = ADD(step1[2], step1[5]);
+  step2[3] = ADD(step1[3], step1[4]);
+  step2[4] = SUB(step1[3], step1[4]);
+  step2[5] = SUB(step1[2], step1[5]);
+  step2[6] = SUB(step1[1], step1[6]);
+  step2[7] = SUB(step1[0], step1[7]);
+  step2[8] = step1[8];
+  step2[9] = step1[9];
+  step2[10] = mult_round(step1[10], step1[13], -cospi_16_64, cospi_16_64);
+  step2[13] = mult_round(step1[10], step1[13], cospi_16_64, cospi_16_64);
+  step2[11] = mult_round(step1[11], step1[12], -cospi_16_64, cospi_16_64);
+  step2[12] = mult_round(step1[11], step1[12], cospi_16_64, cospi_16_64);
+  step2[14] = step1[14];
+  step2[15] = step1[15];
+
+  // stage 7
+  in[0] = ADD(step2[0], step2[15]);
+  in[1] = ADD(step2[1], step2[14]);
+  in[2] = ADD(step2[2], step2[13]);
+  in[3] = ADD(step2[3], step2[12]);
+  in[4] = ADD(step2[4], step2[11]);
+  in[5] = ADD(step2[5], step2[10]);
+  in[6] = ADD(step2[6], step2[9]);
+  in[7] = ADD(step2[7], step2[8]);
+  in[8] = SUB(step2[7], step2[8]);
+  in[9] = SUB(step2[6], step2[9]);
+  in[10] = SUB(step2[5], step2[10]);
+  in[11] = SUB(step2[4], step2[11]);
+  in[12] = SUB(step2[3], step2[12]);
+  in[13] = SUB(step2[2], step2[13]);
+  in[14] = SUB(step2[1], step2[14]);
+  in[15] = SUB(step2[0], step2[15]);
+}
+
+// Sets *out0 and *out1 to dct_const_round_shift() of x + y and x - y, where
+// x and y are the 32-bit results of mult_add().
+static INLINE void add_sub_round(__m256i x_lo, __m256i x_hi,
+                                 __m256i y_lo, __m256i y_hi,
+                                 __m256i *out0, __m256i *out1) {
+  *out0 = round_shift_pack(_mm256_add_epi32(x_lo, y_lo),
+                           _mm256_add_epi32(x_hi, y_hi));
+  *out1 = round_shift_pack(_mm256_sub_epi32(x_lo, y_lo),
+                           _mm256_sub_epi32(x_hi, y_hi));
+}
+
+static void iadst16_avx2(__m256i *in) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i x[16], s_lo[16], s_hi[16];
+  int i;
+
+  x[0] = in[15];
+  x[1] = in[0];
+  x[2] = in[13];
+  x[3] = in[2];
+  x[4] = in[11];
+  x[5] = in[4];
+  x[6] = in[9];
+  x[7] = in[6];
+  x[8] = in[7];
+  x[9] = in[8];
+  x[10] = in[5];
+  x[11] = in[10];
+  x[12] = in[3];
+  x[13] = in[12];
+  x[14] = in[1];
+  x[15] = in[14];
+
+  // stage 1
+  mult_add(x[0], x[1], cospi_1_64, cospi_31_64, &s_lo[0], &s_hi[0]);
+  mult_add(x[0], x[1], cospi_31_64, -cospi_1_64, &s_lo[1], &s_hi[1]);
+  mult_add(x[2], x[3], cospi_5_64, cospi_27_64, &s_lo[2], &s_hi[2]);
+  mult_add(x[2], x[3], cospi_27_64, -cospi_5_64, &s_lo[3], &s_hi[3]);
+  mult_add(x[4], x[5], cospi_9_64, cospi_23_64, &s_lo[4], &s_hi[4]);
+  mult_add(x[4], x[5], cospi_23_64, -cospi_9_64, &s_lo[5], &s_hi[5]);
+  mult_add(x[6], x[7], cospi_13_64, cospi_19_64, &s_lo[6], &s_hi[6]);
+  mult_add(x[6], x[7], cospi_19_64, -cospi_13_64, &s_lo[7], &s_hi[7]);
+  mult_add(x[8], x[9], cospi_17_64, cospi_15_64, &s_lo[8], &s_hi[8]);
+  mult_add(x[8], x[9], cospi_15_64, -cospi_17_64, &s_lo[9], &s_hi[9]);
+  mult_add(x[10], x[11], cospi_21_64, cospi_11_64, &s_lo[10], &s_hi[10]);
+  mult_add(x[10], x[11], cospi_11_64, -cospi_21_64, &s_lo[11], &s_hi[11]);
+  mult_add(x[12], x[13], cospi_25_64, cospi_7_64, &s_lo[12], &s_hi[12]);
+  mult_add(x[12], x[13], cospi_7_64, -cospi_25_64, &s_lo[13], &s_hi[13]);
+  mult_add(x[14], x[15], cospi_29_64, cospi_3_64, &s_lo[14], &s_hi[14]);
+  mult_add(x[14], x[15], cospi_3_64, -cospi_29_64, &s_lo[15], &s_hi[15]);
+
+  for (i = 0; i < 8; ++i)
+    add_sub_round(s_lo[i], s_hi[i], s_lo[i + 8], s_hi[i + 8],
+                  &x[i], &x[i + 8]);
+
+  // stage 2
+  mult_add(x[8], x[9], cospi_4_64, cospi_28_64, &s_lo[8], &s_hi[8]);
+  mult_add(x[8], x[9], cospi_28_64, -cospi_4_64, &s_lo[9], &s_hi[9]);
+  mult_add(x[10], x[11], cospi_20_64, cospi_12_64, &s_lo[10], &s_hi[10]);
+  mult_add(x[10], x[11], cospi_12_64, -cospi_20_64, &s_lo[11], &s_hi[11]);
+  mult_add(x[12], x[13], -cospi_28_64, cospi_4_64, &s_lo[12], &s_hi[12]);
+  mult_add(x[12], x[13], cospi_4_64, cospi_28_64, &s_lo[13], &s_hi[13]);
+  mult_add(x[14], x[15], -cospi_12_64, cospi_20_64, &s_lo[14], &s_hi[14]);
+  mult_add(x[14], x[15], cospi_20_64, cospi_12_64, &s_lo[15], &s_hi[15]);
+
+  for (i = 0; i < 4; ++i) {
+    const __m256i s = x[i];
+    x[i] = ADD(s, x[i + 4]);
+    x[i + 4] = SUB(s, x[i + 4]);
+    add_sub_round(s_lo[i + 8], s_hi[i + 8], s_lo[i + 12], s_hi[i + 12],
+                  &x[i + 8], &x[i + 12]);
+  }
+
+  // stage 3
+  mult_add(x[4], x[5], cospi_8_64, cospi_24_64, &s_lo[4], &s_hi[4]);
+  mult_add(x[4], x[5], cospi_24_64, -cospi_8_64, &s_lo[5], &s_hi[5]);
+  mult_add(x[6], x[7], -cospi_24_64, cospi_8_64, &s_lo[6], &s_hi[6]);
+  mult_add(x[6], x[7], cospi_8_64, cospi_24_64, &s_lo[7], &s_hi[7]);
+  mult_add(x[12], x[13], cospi_8_64, cospi_24_64, &s_lo[12], &s_hi[12]);
+  mult_add(x[12], x[13], cospi_24_64, -cospi_8_64, &s_lo[13], &s_hi[13]);
+  mult_add(x[14], x[15], -cospi_24_64, cospi_8_64, &s_lo[14], &s_hi[14]);
+  mult_add(x[14], x[15], cospi_8_64, cospi_24_64, &s_lo[15], &s_hi[15]);
+
+  for (i = 0; i < 16; i += 8) {
+    const __m256i s0 = x[i], s1 = x[i + 1];
+    x[i] = ADD(s0, x[i + 2]);
+    x[i + 1] = ADD(s1, x[i + 3]);
+    x[i + 2] = SUB(s0, x[i + 2]);
+    x[i + 3] = SUB(s1, x[i + 3]);
+    add_sub_round(s_lo[i + 4], s_hi[i + 4], s_lo[i + 6], s_hi[i + 6],
+                  &x[i + 4], &x[i + 6]);
+    add_sub_round(s_lo[i + 5], s_hi[i + 5], s_lo[i + 7], s_hi[i + 7],
+                  &x[i + 5], &x[i + 7]);
+  }
+
+  // stage 4
+  in[7] = mult_round(x[2], x[3], -cospi_16_64, -cospi_16_64);
+  in[8] = mult_round(x[2], x[3], cospi_16_64, -cospi_16_64);
+  in[4] = mult_round(x[6], x[7], cospi_16_64, cospi_16_64);
+  in[11] = mult_round(x[6], x[7], -cospi_16_64, cospi_16_64);
+  in[6] = mult_round(x[10], x[11], cospi_16_64, cospi_16_64);
+  in[9] = mult_round(x[10], x[11], -cospi_16_64, cospi_16_64);
+  in[5] = mult_round(x[14], x[15], -cospi_16_64, -cospi_16_64);
+  in[10] = mult_round(x[14], x[15], cospi_16_64, -cospi_16_64);
+
+  in[0] = x[0];
+  in[1] = SUB(zero, x[8]);
+  in[2] = x[12];
+  in[3] = SUB(zero, x[4]);
+  in[12] = x[5];
+  in[13] = SUB(zero, x[13]);
+  in[14] = x[9];
+  in[15] = SUB(zero, x[1]);
+}
+
+static void idct32_avx2(__m256i *in) {
+  __m256i even[16], step1[32], step2[32];
+  int i;
+
+  // The even coefficients form a 16-point idct; stages 2 to 7 of idct32()
+  // on step 0 to 15 are exactly idct16().
+  for (i = 0; i < 16; ++i)
+    even[i] = in[2 * i];
+  idct16_avx2(even);
+
+  // stage 1
+  step1[16] = mult_round(in[1], in[31], cospi_31_64, -cospi_1_64);
+  step1[31] = mult_round(in[1], in[31], cospi_1_64, cospi_31_64);
+  step1[17] = mult_round(in[17], in[15], cospi_15_64, -cospi_17_64);
+  step1[30] = mult_round(in[17], in[15], cospi_17_64, cospi_15_64);
+  step1[18] = mult_round(in[9], in[23], cospi_23_64, -cospi_9_64);
+  step1[29] = mult_round(in[9], in[23], cospi_9_64, cospi_23_64);
+  step1[19] = mult_round(in[25], in[7], cospi_7_64, -cospi_25_64);
+  step1[28] = mult_round(in[25], in[7], cospi_25_64, cospi_7_64);
+  step1[20] = mult_round(in[5], in[27], cospi_27_64, -cospi_5_64);
+  step1[27] = mult_round(in[5], in[27], cospi_5_64, cospi_27_64);
+  step1[21] = mult_round(in[21], in[11], cospi_11_64, -cospi_21_64);
+  step1[26] = mult_round(in[21], in[11], cospi_21_64, cospi_11_64);
+  step1[22] = mult_round(in[13], in[19], cospi_19_64, -cospi_13_64);
+  step1[25] = mult_round(in[13], in[19], cospi_13_64, cospi_19_64);
+  step1[23] = mult_round(in[29], in[3], cospi_3_64, -cospi_29_64);
+  step1[24] = mult_round(in[29], in[3], cospi_29_64, cospi_3_64);
+
+  // stage 2
+  for (i = 16; i < 32; i += 4) {
+    step2[i] = ADD(step1[i], step1[i + 1]);
+    step2[i + 1] = SUB(step1[i], step1[i + 1]);
+    step2[i + 2] = SUB(step1[i + 3], step1[i + 2]);
+    step2[i + 3] = ADD(step1[i + 2], step1[i + 3]);
+  }
+
+  // stage 3
+  step1[16] = step2[16];
+  step1[31] = step2[31];
+  step1[17] = mult_round(step2[17], step2[30], -cospi_4_64, cospi_28_64);
+  step1[30] = mult_round(step2[17], step2[30], cospi_28_64, cospi_4_64);
+  step1[18] = mult_round(step2[18], step2[29], -cospi_28_64, -cospi_4_64);
+  step1[29] = mult_round(step2[18], step2[29], -cospi_4_64, cospi_28_64);
+  step1[19] = step2[19];
+  step1[20] = step2[20];
+  step1[21] = mult_round(step2[21], step2[26], -cospi_20_64, cospi_12_64);
+  step1[26] = mult_round(step2[21], step2[26], cospi_12_64, cospi_20_64);
+  step1[22] = mult_round(step2[22], step2[25], -cospi_12_64, -cospi_20_64);
+  step1[25] = mult_round(step2[22], step2[25], -cospi_20_64, cospi_12_64);
+  step1[23] = step2[23];
+  step1[24] = step2[24];
+  step1[27] = step2[27];
+  step1[28] = step2[28];
+
+  // stage 4
+  for (i = 16; i < 32; i += 8) {
+    step2[i] = ADD(step1[i], step1[i + 3]);
+    step2[i + 1] = ADD(step1[i + 1], step1[i + 2]);
+    step2[i + 2] = SUB(step1[i + 1], step1[i + 2]);
+    step2[i + 3] = SUB(step1[i], step1[i + 3]);
+    step2[i + 4] = SUB(step1[i + 7], step1[i + 4]);
+    step2[i + 5] = SUB(step1[i + 6], step1[i + 5]);
+    step2[i + 6] = ADD(step1[i + 5], step1[i + 6]);
+    step2[i + 7] = ADD(step1[i + 4], step1[i + 7]);
+  }
+
+  // stage 5
+  step1[16] = step2[16];
+  step1[17] = step2[17];
+  step1[18] = mult_round(step2[18], step2[29], -cospi_8_64, cospi_24_64);
+  step1[29] = mult_round(step2[18], step2[29], cospi_24_64, cospi_8_64);
+  step1[19] = mult_round(step2[19], step2[28], -cospi_8_64, cospi_24_64);
+  step1[28] = mult_round(step2[19], step2[28], cospi_24_64, cospi_8_64);
+  step1[20] = mult_round(step2[20], step2[27], -cospi_24_64, -cospi_8_64);
+  step1[27] = mult_round(step2[20], step2[27], -cospi_8_64, cospi_24_64);
+  step1[21] = mult_round(step2[21], step2[26], -cospi_24_64, -cospi_8_64);
+  step1[26] = mult_round(step2[21], step2[26], -cospi_8_64, cospi_24_64);
+  step1[22] = step2[22];
+  step1[23] = step2[23];
+  step1[24] = step2[24];
+  step1[25] = step2[25];
+  step1[30] = step2[30];
+  step1[31] = step2[31];
+
+  // stage 6
+  for (i = 0; i < 4; ++i) {
+    step2[16 + i] = ADD(step1[16 + i], step1[23 - i]);
+    step2[23 - i] = SUB(step1[16 + i], step1[23 - i]);
+    step2[24 + i] = SUB(step1[31 - i], step1[24 + i]);
+    step2[31 - i] = ADD(step1[24 + i], step1[31 - i]);
+  }
+
+  // stage 7
+  for (i = 16; i < 20; ++i)
+    step1[i] = step2[i];
+  for (i = 20; i < 24; ++i) {
+    step1[i] = mult_round(step2[i], step2[47 - i], -cospi_16_64, cospi_16_64);
+    step1[47 - i] = mult_round(step2[i], step2[47 - i], cospi_16_64,
+                               cospi_16_64);
+  }
+  for (i = 28; i < 32; ++i)
+    step1[i] = step2[i];
+
+  // final stage
+  for (i = 0; i < 16; ++i) {
+    in[i] = ADD(even[i], step1[31 - i]);
+    in[31 - i] = SUB(even[i], step1[31 - i]);
+  }
+}
+
+typedef void (*transform_1d_avx2)(__m256i *in);
+
+// 2-D 16x16 inverse transform of 'rows' rows of coefficients, the rest being
+// zero, added to dest.
+static INLINE void inv_txfm_16x16_add(const int16_t *input, uint8_t *dest,
+                                      int stride, int rows,
+                                      transform_1d_avx2 row_txfm,
+                                      transform_1d_avx2 col_txfm) {
+  __m256i in[16];
+
+  load_buffer_16x16(input, 16, rows, in);
+  transpose_16x16(in);
+  row_txfm(in);
+  transpose_16x16(in);
+  col_txfm(in);
+  write_buffer_16xn(in, dest, stride, 16);
+}
+
+void vp9_idct16x16_256_add_avx2(const int16_t *input, uint8_t *dest,
+                                int stride) {
+  inv_txfm_16x16_add(input, dest, stride, 16, idct16_avx2, idct16_avx2);
+}
+
+void vp9_idct16x16_10_add_avx2(const int16_t *input, uint8_t *dest,
+                               int stride) {
+  // Only the upper-left 4x4 coefficients are non-zero.
+  inv_txfm_16x16_add(input, dest, stride, 4, idct16_avx2, idct16_avx2);
+}
+
+void vp9_iht16x16_256_add_avx2(const int16_t *input, uint8_t *dest,
+                               int stride, int tx_type) {
+  switch (tx_type) {
+    case 0:  // DCT_DCT
+      inv_txfm_16x16_add(input, dest, stride, 16, idct16_avx2, idct16_avx2);
+      break;
+    case 1:  // ADST_DCT
+      inv_txfm_16x16_add(input, dest, stride, 16, idct16_avx2, iadst16_avx2);
+      break;
+    case 2:  // DCT_ADST
+      inv_txfm_16x16_add(input, dest, stride, 16, iadst16_avx2, idct16_avx2);
+      break;
+    case 3:  // ADST_ADST
+      inv_txfm_16x16_add(input, dest, stride, 16, iadst16_avx2, iadst16_avx2);
+      break;
+    default:
+      assert(0);
+      break;
+  }
+}
+
+// Row pass of the 32x32 transform for rows [row, row + 16) of which the first
+// 'rows' may be non-zero and only the first 'cols' columns may be non-zero.
+// On return in[i] holds columns 0 to 15 of row i and in[i + 16] columns 16 to
+// 31.
+static INLINE void idct32_rows_16(const int16_t *input, int rows, int cols,
+                                  __m256i *in) {
+  int i;
+
+  load_buffer_16x16(input, 32, rows, in);
+  transpose_16x16(in);
+  if (cols > 16) {
+    load_buffer_16x16(input + 16, 32, rows, in + 16);
+    transpose_16x16(in + 16);
+  } else {
+    for (i = 16; i < 32; ++i)
+      in[i] = _mm256_setzero_si256();
+  }
+  idct32_avx2(in);
+  transpose_16x16(in);
+  transpose_16x16(in + 16);
+}
+
+static INLINE int is_zero_16x32(const int16_t *input) {
+  __m256i any = _mm256_setzero_si256();
+  int i;
+  for (i = 0; i < 16 * 32; i += 16)
+    any = _mm256_or_si256(any,
+                          _mm256_loadu_si256((const __m256i *)(input + i)));
+  return _mm256_testz_si256(any, any);
+}
+
+void vp9_idct32x32_1024_add_avx2(const int16_t *input, uint8_t *dest,
+                                 int stride) {
+  DECLARE_ALIGNED(32, int16_t, out[32 * 32]);
+  __m256i in[32];
+  int i, j;
+
+  // Rows, 16 at a time. Blocks are often sparse, so all-zero halves are
+  // skipped.
+  for (i = 0; i < 32; i += 16) {
+    int16_t *const out_row = out + i * 32;
+    if (is_zero_16x32(input + i * 32)) {
+      for (j = 0; j < 16 * 32; j += 16)
+        _mm256_store_si256((__m256i *)(out_row + j), _mm256_setzero_si256());
+      continue;
+    }
+    idct32_rows_16(input + i * 32, 16, 32, in);
+    for (j = 0; j < 16; ++j) {
+      _mm256_store_si256((__m256i *)(out_row + j * 32), in[j]);
+      _mm256_store_si256((__m256i *)(out_row + j * 32 + 16), in[j + 16]);
+    }
+  }
+
+  // Columns, 16 at a time.
+  for (i = 0; i < 32; i += 16) {
+    for (j = 0; j < 32; ++j)
+      in[j] = _mm256_load_si256((const __m256i *)(out + j * 32 + i));
+    idct32_avx2(in);
+    write_buffer_16xn(in, dest + i, stride, 32);
+  }
+}
+
+void vp9_idct32x32_34_add_avx2(const int16_t *input, uint8_t *dest,
+                               int stride) {
+  __m256i rows[32], in[32];
+  int i, j;
+
+  // Only the upper-left 8x8 coefficients are non-zero, so only rows 0 to 7
+  // of the row pass output are non-zero and can stay in registers.
+  idct32_rows_16(input, 8, 8, rows);
+
+  for (i = 0; i < 32; i += 16) {
+    for (j = 0; j < 8; ++j)
+      in[j] = rows[j + i];
+    for (; j < 32; ++j)
+      in[j] = _mm256_setzero_si256();
+    idct32_avx2(in);
+    write_buffer_16xn(in, dest + i, stride, 32);
+  }
+}
+
+// Adds a1 to every pixel of the size x size block at dest, with clipping.
+static INLINE void dc_only_add(int a1, uint8_t *dest, int stride, int size) {
+  const __m256i dc = _mm256_set1_epi8((char)MIN(abs(a1), 255));
+  int i, j;
+
+  for (i = 0; i < size; ++i) {
+    for (j = 0; j < size; j += 32) {
+      __m256i d;
+      if (size == 16)
+        d = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)dest));
+      else
+        d = _mm256_loadu_si256((const __m256i *)(dest + j));
+      d = a1 >= 0 ? _mm256_adds_epu8(d, dc) : _mm256_subs_epu8(d, dc);
+      if (size == 16)
+        _mm_storeu_si128((__m128i *)dest, _mm256_castsi256_si128(d));
+      else
+        _mm256_storeu_si256((__m256i *)(dest + j), d);
+    }
+    dest += stride;
+  }
+}
+
+void vp9_idct16x16_1_add_avx2(const int16_t *input, uint8_t *dest,
+                              int stride) {
+  int16_t out = dct_const_round_shift(input[0] * cospi_16_64);
+  out = dct_const_round_shift(out * cospi_16_64);
+  dc_only_add(ROUND_POWER_OF_TWO(out, 6), dest, stride, 16);
+}
+
+void vp9_idct32x32_1_add_avx2(const int16_t *input, uint8_t *dest,
+                              int stride) {
+  int16_t out = dct_const_round_shift(input[0] * cospi_16_64);
+  out = dct_const_round_shift(out * cospi_16_64);
+  dc_only_add(ROUND_POWER_OF_TWO(out, 6), dest, stride, 32);
+}
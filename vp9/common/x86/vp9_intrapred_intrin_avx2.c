@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>  // AVX2
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+// Rows of 16 pixels or fewer gain nothing from 256-bit registers, so only the
+// 32x32 predictors have AVX2 versions; the other sizes use the SSSE3 ones.
+
+// (a + 2 * b + c + 2) >> 2 without widening to 16 bits.
+static INLINE __m256i avg3_avx2(__m256i a, __m256i b, __m256i c) {
+  const __m256i odd = _mm256_and_si256(_mm256_xor_si256(a, c),
+                                       _mm256_set1_epi8(1));
+  return _mm256_avg_epu8(_mm256_sub_epi8(_mm256_avg_epu8(a, c), odd), b);
+}
+
+static INLINE void copy_row_32(uint8_t *dst, const uint8_t *src) {
+  _mm256_storeu_si256((__m256i *)dst,
+                      _mm256_loadu_si256((const __m256i *)src));
+}
+
+// Same as filter_edge() in vp9_intrapred_intrin_ssse3.c for bs = 32: with
+//   s = { left[31], ..., left[0], above[-1], above[0], ..., above[31] }
+// sets a2[i] = avg2(s[i], s[i + 1]) and f[i] = avg3(s[i], s[i + 1], s[i + 2])
+// for i < 64.
+static INLINE void filter_edge_32(const uint8_t *above, const uint8_t *left,
+                                  uint8_t *a2, uint8_t *f) {
+  const __m256i rev = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                       7, 6, 5, 4, 3, 2, 1, 0,
+                                       15, 14, 13, 12, 11, 10, 9, 8,
+                                       7, 6, 5, 4, 3, 2, 1, 0);
+  DECLARE_ALIGNED(32, uint8_t, s[96]);
+  int i;
+
+  _mm256_store_si256((__m256i *)s, _mm256_permute4x64_epi64(
+      _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)left), rev),
+      0x4e));
+  _mm256_store_si256((__m256i *)(s + 32),
+                     _mm256_loadu_si256((const __m256i *)(above - 1)));
+  // The filters below read up to 2 bytes past the end of the edge.
+  _mm256_store_si256((__m256i *)(s + 64), _mm256_setzero_si256());
+  s[64] = above[31];
+
+  for (i = 0; i < 64; i += 32) {
+    const __m256i x0 = _mm256_load_si256((const __m256i *)(s + i));
+    const __m256i x1 = _mm256_loadu_si256((const __m256i *)(s + i + 1));
+    const __m256i x2 = _mm256_loadu_si256((const __m256i *)(s + i + 2));
+    if (a2 != NULL)
+      _mm256_store_si256((__m256i *)(a2 + i), _mm256_avg_epu8(x0, x1));
+    _mm256_store_si256((__m256i *)(f + i), avg3_avx2(x0, x1, x2));
+  }
+}
+
+void vp9_d117_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                   const uint8_t *above, const uint8_t *left) {
+  const __m256i even = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+                                        -1, -1, -1, -1, -1, -1, -1, -1,
+                                        0, 2, 4, 6, 8, 10, 12, 14,
+                                        -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i odd = _mm256_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15,
+                                       -1, -1, -1, -1, -1, -1, -1, -1,
+                                       1, 3, 5, 7, 9, 11, 13, 15,
+                                       -1, -1, -1, -1, -1, -1, -1, -1);
+  DECLARE_ALIGNED(32, uint8_t, a2[64]);
+  DECLARE_ALIGNED(32, uint8_t, f[64]);
+  DECLARE_ALIGNED(32, uint8_t, e[64]);
+  DECLARE_ALIGNED(32, uint8_t, o[64]);
+  __m256i f0;
+  int r;
+
+  filter_edge_32(above, left, a2, f);
+
+  // See d117_predictor() in vp9_intrapred_intrin_ssse3.c.
+  f0 = _mm256_load_si256((const __m256i *)f);
+  _mm_store_si128((__m128i *)e, _mm256_castsi256_si128(
+      _mm256_permute4x64_epi64(_mm256_shuffle_epi8(f0, even), 0x08)));
+  _mm_store_si128((__m128i *)o, _mm256_castsi256_si128(
+      _mm256_permute4x64_epi64(_mm256_shuffle_epi8(f0, odd), 0x08)));
+  copy_row_32(e + 16, a2 + 32);
+  copy_row_32(o + 15, f + 31);
+
+  for (r = 0; r < 16; ++r) {
+    copy_row_32(dst, e + 16 - r);
+    copy_row_32(dst + stride, o + 15 - r);
+    dst += 2 * stride;
+  }
+}
+
+void vp9_d135_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                   const uint8_t *above, const uint8_t *left) {
+  DECLARE_ALIGNED(32, uint8_t, f[64]);
+  int r;
+
+  filter_edge_32(above, left, NULL, f);
+
+  for (r = 0; r < 32; ++r) {
+    copy_row_32(dst, f + 31 - r);
+    dst += stride;
+  }
+}
+
+void vp9_d153_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                   const uint8_t *above, const uint8_t *left) {
+  DECLARE_ALIGNED(32, uint8_t, a2[64]);
+  DECLARE_ALIGNED(32, uint8_t, f[64]);
+  DECLARE_ALIGNED(32, uint8_t, b[96]);
+  __m256i x, y, lo, hi;
+  int r;
+
+  filter_edge_32(above, left, a2, f);
+
+  // See d153_predictor() in vp9_intrapred_intrin_ssse3.c. The unpacks work
+  // within 128-bit lanes, so the lanes are put back in order afterwards.
+  x = _mm256_load_si256((const __m256i *)a2);
+  y = _mm256_load_si256((const __m256i *)f);
+  lo = _mm256_unpacklo_epi8(x, y);
+  hi = _mm256_unpackhi_epi8(x, y);
+  _mm256_store_si256((__m256i *)b, _mm256_permute2x128_si256(lo, hi, 0x20));
+  _mm256_store_si256((__m256i *)(b + 32),
+                     _mm256_permute2x128_si256(lo, hi, 0x31));
+  copy_row_32(b + 64, f + 32);
+
+  for (r = 0; r < 32; ++r) {
+    copy_row_32(dst, b + 2 * (31 - r));
+    dst += stride;
+  }
+}
+
+static INLINE void dc_store_32(uint8_t *dst, ptrdiff_t stride, int value) {
+  const __m256i dc = _mm256_set1_epi8((char)value);
+  int r;
+
+  for (r = 0; r < 32; ++r) {
+    _mm256_storeu_si256((__m256i *)dst, dc);
+    dst += stride;
+  }
+}
+
+static INLINE int sum_32(const uint8_t *p) {
+  const __m256i sum = _mm256_sad_epu8(_mm256_loadu_si256((const __m256i *)p),
+                                      _mm256_setzero_si256());
+  const __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                       _mm256_extracti128_si256(sum, 1));
+  return _mm_cvtsi128_si32(_mm_add_epi32(sum128, _mm_srli_si128(sum128, 8)));
+}
+
+void vp9_dc_128_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                     const uint8_t *above,
+                                     const uint8_t *left) {
+  (void)above;
+  (void)left;
+  dc_store_32(dst, stride, 128);
+}
+
+void vp9_dc_left_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                      const uint8_t *above,
+                                      const uint8_t *left) {
+  (void)above;
+  dc_store_32(dst, stride, (sum_32(left) + 16) >> 5);
+}
+
+void vp9_dc_top_predictor_32x32_avx2(uint8_t *dst, ptrdiff_t stride,
+                                     const uint8_t *above,
+                                     const uint8_t *left) {
+  (void)left;
+  dc_store_32(dst, stride, (sum_32(above) + 16) >> 5);
+}
@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <tmmintrin.h>  // SSSE3
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+// (a + 2 * b + c + 2) >> 2 without widening to 16 bits.
+static INLINE __m128i avg3_epu8(__m128i a, __m128i b, __m128i c) {
+  const __m128i odd = _mm_and_si128(_mm_xor_si128(a, c), _mm_set1_epi8(1));
+  return _mm_avg_epu8(_mm_sub_epi8(_mm_avg_epu8(a, c), odd), b);
+}
+
+// Loads the first bs bytes of p. Lanes beyond bs are zero for bs < 16.
+static INLINE __m128i load_edge(const uint8_t *p, int bs) {
+  if (bs == 4)
+    return _mm_cvtsi32_si128(*(const int *)p);
+  else if (bs == 8)
+    return _mm_loadl_epi64((const __m128i *)p);
+  return _mm_loadu_si128((const __m128i *)p);
+}
+
+static INLINE void copy_row(uint8_t *dst, const uint8_t *src, int bs) {
+  if (bs == 4) {
+    *(int *)dst = *(const int *)src;
+  } else if (bs == 8) {
+    _mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+  } else {
+    int i;
+    for (i = 0; i < bs; i += 16)
+      _mm_storeu_si128((__m128i *)(dst + i),
+                       _mm_loadu_si128((const __m128i *)(src + i)));
+  }
+}
+
+// Filters the edge of a bs x bs block for the directional predictors. The
+// edge is laid out from the bottom left to the top right as
+//   s = { left[bs - 1], ..., left[0], above[-1], above[0], ..., above[bs - 1] }
+// and a2[i] = avg2(s[i], s[i + 1]), f[i] = avg3(s[i], s[i + 1], s[i + 2]) for
+// i < 2 * bs. Every output pixel of d117, d135 and d153 is one of these.
+static INLINE void filter_edge(const uint8_t *above, const uint8_t *left,
+                               int bs, uint8_t *a2, uint8_t *f) {
+  DECLARE_ALIGNED(16, uint8_t, s[96]);
+  int i;
+
+  if (bs < 16) {
+    const __m128i rev = _mm_sub_epi8(_mm_set1_epi8(bs - 1),
+                                     _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8,
+                                                   9, 10, 11, 12, 13, 14, 15));
+    _mm_store_si128((__m128i *)s,
+                    _mm_shuffle_epi8(load_edge(left, bs), rev));
+  } else {
+    const __m128i rev = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5,
+                                      4, 3, 2, 1, 0);
+    for (i = 0; i < bs; i += 16)
+      _mm_storeu_si128((__m128i *)(s + bs - 16 - i),
+                       _mm_shuffle_epi8(
+                           _mm_loadu_si128((const __m128i *)(left + i)), rev));
+  }
+  // The filters below read up to 2 bytes past the end of the edge.
+  _mm_storeu_si128((__m128i *)(s + 2 * bs + 1), _mm_setzero_si128());
+  if (bs == 4) {
+    _mm_storel_epi64((__m128i *)(s + bs),
+                     _mm_loadl_epi64((const __m128i *)(above - 1)));
+  } else {
+    for (i = 0; i < bs; i += 16)
+      _mm_storeu_si128((__m128i *)(s + bs + i),
+                       _mm_loadu_si128((const __m128i *)(above - 1 + i)));
+  }
+  s[2 * bs] = above[bs - 1];
+
+  for (i = 0; i < 2 * bs; i += 16) {
+    const __m128i x0 = _mm_load_si128((const __m128i *)(s + i));
+    const __m128i x1 = _mm_loadu_si128((const __m128i *)(s + i + 1));
+    const __m128i x2 = _mm_loadu_si128((const __m128i *)(s + i + 2));
+    if (a2 != NULL)
+      _mm_store_si128((__m128i *)(a2 + i), _mm_avg_epu8(x0, x1));
+    _mm_store_si128((__m128i *)(f + i), avg3_epu8(x0, x1, x2));
+  }
+}
+
+static INLINE void d117_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                  const uint8_t *above, const uint8_t *left) {
+  const __m128i even = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+                                     -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i odd = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15,
+                                    -1, -1, -1, -1, -1, -1, -1, -1);
+  DECLARE_ALIGNED(16, uint8_t, a2[64]);
+  DECLARE_ALIGNED(16, uint8_t, f[64]);
+  DECLARE_ALIGNED(16, uint8_t, e[64]);
+  DECLARE_ALIGNED(16, uint8_t, o[64]);
+  __m128i f0, f1;
+  int i, r;
+
+  filter_edge(above, left, bs, a2, f);
+
+  // The first column of the even rows is f[bs - 2 * k] and of the odd rows
+  // f[bs - 1 - 2 * k]. Each row repeats the one two rows above it shifted
+  // right by one, so row 2 * k starts at e + bs / 2 - k, where e holds the
+  // even entries of f followed by row 0, and row 2 * k + 1 starts at
+  // o + bs / 2 - 1 - k, where o holds the odd entries followed by row 1.
+  f0 = _mm_load_si128((const __m128i *)f);
+  f1 = bs > 16 ? _mm_load_si128((const __m128i *)(f + 16)) : f0;
+  _mm_store_si128((__m128i *)e, _mm_unpacklo_epi64(_mm_shuffle_epi8(f0, even),
+                                                   _mm_shuffle_epi8(f1, even)));
+  _mm_store_si128((__m128i *)o, _mm_unpacklo_epi64(_mm_shuffle_epi8(f0, odd),
+                                                   _mm_shuffle_epi8(f1, odd)));
+  for (i = 0; i < bs; i += 16) {
+    _mm_storeu_si128((__m128i *)(e + bs / 2 + i),
+                     _mm_loadu_si128((const __m128i *)(a2 + bs + i)));
+    _mm_storeu_si128((__m128i *)(o + bs / 2 - 1 + i),
+                     _mm_loadu_si128((const __m128i *)(f + bs - 1 + i)));
+  }
+
+  for (r = 0; r < bs / 2; ++r) {
+    copy_row(dst, e + bs / 2 - r, bs);
+    copy_row(dst + stride, o + bs / 2 - 1 - r, bs);
+    dst += 2 * stride;
+  }
+}
+
+static INLINE void d135_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                  const uint8_t *above, const uint8_t *left) {
+  DECLARE_ALIGNED(16, uint8_t, f[64]);
+  int r;
+
+  filter_edge(above, left, bs, NULL, f);
+
+  // Row r is f[bs - 1 - r], ..., f[2 * bs - 2 - r].
+  for (r = 0; r < bs; ++r) {
+    copy_row(dst, f + bs - 1 - r, bs);
+    dst += stride;
+  }
+}
+
+static INLINE void d153_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                  const uint8_t *above, const uint8_t *left) {
+  DECLARE_ALIGNED(16, uint8_t, a2[64]);
+  DECLARE_ALIGNED(16, uint8_t, f[64]);
+  DECLARE_ALIGNED(16, uint8_t, b[112]);
+  int i, r;
+
+  filter_edge(above, left, bs, a2, f);
+
+  // The first two columns of row r are a2[bs - 1 - r] and f[bs - 1 - r], and
+  // each row repeats the one above it shifted right by two. Interleaving them
+  // bottom row first and appending the rest of row 0 gives every row as a
+  // window of b.
+  for (i = 0; i < bs; i += 16) {
+    const __m128i x = _mm_load_si128((const __m128i *)(a2 + i));
+    const __m128i y = _mm_load_si128((const __m128i *)(f + i));
+    _mm_store_si128((__m128i *)(b + 2 * i), _mm_unpacklo_epi8(x, y));
+    _mm_store_si128((__m128i *)(b + 2 * i + 16), _mm_unpackhi_epi8(x, y));
+  }
+  for (i = 0; i < bs - 2; i += 16)
+    _mm_storeu_si128((__m128i *)(b + 2 * bs + i),
+                     _mm_loadu_si128((const __m128i *)(f + bs + i)));
+
+  for (r = 0; r < bs; ++r) {
+    copy_row(dst, b + 2 * (bs - 1 - r), bs);
+    dst += stride;
+  }
+}
+
+static INLINE int sum_edge(const uint8_t *p, int bs) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum;
+  int i;
+
+  if (bs < 16) {
+    sum = _mm_sad_epu8(load_edge(p, bs), zero);
+  } else {
+    sum = zero;
+    for (i = 0; i < bs; i += 16)
+      sum = _mm_add_epi16(sum, _mm_sad_epu8(
+          _mm_loadu_si128((const __m128i *)(p + i)), zero));
+    sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+  }
+  return _mm_cvtsi128_si32(sum);
+}
+
+static INLINE void dc_store(uint8_t *dst, ptrdiff_t stride, int bs,
+                            int value) {
+  const __m128i dc = _mm_shuffle_epi8(_mm_cvtsi32_si128(value),
+                                      _mm_setzero_si128());
+  int i, r;
+
+  for (r = 0; r < bs; ++r) {
+    if (bs == 4) {
+      *(int *)dst = _mm_cvtsi128_si32(dc);
+    } else if (bs == 8) {
+      _mm_storel_epi64((__m128i *)dst, dc);
+    } else {
+      for (i = 0; i < bs; i += 16)
+        _mm_storeu_si128((__m128i *)(dst + i), dc);
+    }
+    dst += stride;
+  }
+}
+
+static INLINE void dc_128_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                    const uint8_t *above, const uint8_t *left) {
+  (void)above;
+  (void)left;
+  dc_store(dst, stride, bs, 128);
+}
+
+static INLINE void dc_left_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                     const uint8_t *above,
+                                     const uint8_t *left) {
+  (void)above;
+  dc_store(dst, stride, bs, (sum_edge(left, bs) + (bs >> 1)) / bs);
+}
+
+static INLINE void dc_top_predictor(uint8_t *dst, ptrdiff_t stride, int bs,
+                                    const uint8_t *above, const uint8_t *left) {
+  (void)left;
+  dc_store(dst, stride, bs, (sum_edge(above, bs) + (bs >> 1)) / bs);
+}
+
+#define intra_pred_sized(type, size) \
+  void vp9_##type##_predictor_##size##x##size##_ssse3(uint8_t *dst, \
+                                                      ptrdiff_t stride, \
+                                                      const uint8_t *above, \
+                                                      const uint8_t *left) { \
+    type##_predictor(dst, stride, size, above, left); \
+  }
+
+#define intra_pred_allsizes(type) \
+  intra_pred_sized(type, 4) \
+  intra_pred_sized(type, 8) \
+  intra_pred_sized(type, 16) \
+  intra_pred_sized(type, 32)
+
+intra_pred_allsizes(d117)
+intra_pred_allsizes(d135)
+// The smaller d153 sizes are in vp9_intrapred_ssse3.asm.
+intra_pred_sized(d153, 32)
+intra_pred_allsizes(dc_128)
+intra_pred_allsizes(dc_left)
+intra_pred_allsizes(dc_top)
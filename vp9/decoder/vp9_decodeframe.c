@@ -9,6 +9,7 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>  // qsort()
 
 #include "./vp9_rtcd.h"
@@ -38,7 +39,7 @@
 #include "vp9/decoder/vp9_dthread.h"
 #include "vp9/decoder/vp9_read_bit_buffer.h"
 #include "vp9/decoder/vp9_reader.h"
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
 
 #define MAX_VP9_HEADER_SIZE 80
 
@@ -333,10 +334,42 @@ static void set_ref(VP9_COMMON *const cm, MACROBLOCKD *const xd,
   xd->corrupted |= ref_buffer->buf->corrupted;
 }
 
-static void decode_block(VP9_COMMON *const cm, MACROBLOCKD *const xd,
+// Frame-parallel decoding: waits until the reference frame rows used to
+// predict the block are decoded.
+static void wait_for_ref_rows(VP9Decoder *pbi, const MODE_INFO *mi,
+                              int mi_row, BLOCK_SIZE bsize) {
+  FrameWorkerData *const fwd = pbi->frame_worker_data;
+  const VP9_COMMON *const cm = &pbi->common;
+  const MB_MODE_INFO *const mbmi = &mi->mbmi;
+  int ref;
+
+  for (ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+    const int i = mbmi->ref_frame[ref] - LAST_FRAME;
+    int row = INT_MAX;
+
+    if (!vp9_is_scaled(&cm->frame_refs[i].sf)) {
+      int mv_row = mbmi->mv[ref].as_mv.row;
+      if (bsize < BLOCK_8X8) {
+        int b;
+        for (b = 0; b < 4; ++b)
+          mv_row = MAX(mv_row, mi->bmi[b].as_mv[ref].as_mv.row);
+      }
+      // Bottom of the prediction in luma rows, including the rows read by
+      // the interpolation filter for the subsampled chroma planes.
+      row = (mi_row + num_8x8_blocks_high_lookup[bsize]) * MI_SIZE +
+            (mv_row >> 3) + 2 * (VP9_INTERP_EXTEND + 1);
+    }
+    if (fwd->ref_row[i] < row)
+      fwd->ref_row[i] = vp9_frameworker_wait(fwd->owner, fwd->ref_fb_idx[i],
+                                             row);
+  }
+}
+
+static void decode_block(VP9Decoder *const pbi, MACROBLOCKD *const xd,
                          const TileInfo *const tile,
                          int mi_row, int mi_col,
                          vp9_reader *r, BLOCK_SIZE bsize) {
+  VP9_COMMON *const cm = &pbi->common;
   const int less8x8 = bsize < BLOCK_8X8;
   MB_MODE_INFO *mbmi = set_offsets(cm, xd, tile, bsize, mi_row, mi_col);
   vp9_read_mode_info(cm, xd, tile, mi_row, mi_col, r);
@@ -362,6 +395,9 @@ static void decode_block(VP9_COMMON *const cm, MACROBLOCKD *const xd,
     if (has_second_ref(mbmi))
       set_ref(cm, xd, 1, mi_row, mi_col);
 
+    if (pbi->frame_worker_data != NULL)
+      wait_for_ref_rows(pbi, xd->mi[0], mi_row, bsize);
+
     // Prediction
     vp9_dec_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
 
@@ -402,10 +438,11 @@ static PARTITION_TYPE read_partition(VP9_COMMON *cm, MACROBLOCKD *xd, int hbs,
   return p;
 }
 
-static void decode_partition(VP9_COMMON *const cm, MACROBLOCKD *const xd,
+static void decode_partition(VP9Decoder *const pbi, MACROBLOCKD *const xd,
                              const TileInfo *const tile,
                              int mi_row, int mi_col,
                              vp9_reader* r, BLOCK_SIZE bsize) {
+  VP9_COMMON *const cm = &pbi->common;
   const int hbs = num_8x8_blocks_wide_lookup[bsize] / 2;
   PARTITION_TYPE partition;
   BLOCK_SIZE subsize;
@@ -416,27 +453,28 @@ static void decode_partition(VP9_COMMON *const cm, MACROBLOCKD *const xd,
   partition = read_partition(cm, xd, hbs, mi_row, mi_col, bsize, r);
   subsize = get_subsize(bsize, partition);
   if (subsize < BLOCK_8X8) {
-    decode_block(cm, xd, tile, mi_row, mi_col, r, subsize);
+    decode_block(pbi, xd, tile, mi_row, mi_col, r, subsize);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        decode_block(cm, xd, tile, mi_row, mi_col, r, subsize);
+        decode_block(pbi, xd, tile, mi_row, mi_col, r, subsize);
         break;
       case PARTITION_HORZ:
-        decode_block(cm, xd, tile, mi_row, mi_col, r, subsize);
+        decode_block(pbi, xd, tile, mi_row, mi_col, r, subsize);
         if (mi_row + hbs < cm->mi_rows)
-          decode_block(cm, xd, tile, mi_row + hbs, mi_col, r, subsize);
+          decode_block(pbi, xd, tile, mi_row + hbs, mi_col, r, subsize);
         break;
       case PARTITION_VERT:
-        decode_block(cm, xd, tile, mi_row, mi_col, r, subsize);
+        decode_block(pbi, xd, tile, mi_row, mi_col, r, subsize);
         if (mi_col + hbs < cm->mi_cols)
-          decode_block(cm, xd, tile, mi_row, mi_col + hbs, r, subsize);
+          decode_block(pbi, xd, tile, mi_row, mi_col + hbs, r, subsize);
         break;
       case PARTITION_SPLIT:
-        decode_partition(cm, xd, tile, mi_row,       mi_col,       r, subsize);
-        decode_partition(cm, xd, tile, mi_row,       mi_col + hbs, r, subsize);
-        decode_partition(cm, xd, tile, mi_row + hbs, mi_col,       r, subsize);
-        decode_partition(cm, xd, tile, mi_row + hbs, mi_col + hbs, r, subsize);
+        decode_partition(pbi, xd, tile, mi_row, mi_col, r, subsize);
+        decode_partition(pbi, xd, tile, mi_row, mi_col + hbs, r, subsize);
+        decode_partition(pbi, xd, tile, mi_row + hbs, mi_col, r, subsize);
+        decode_partition(pbi, xd, tile, mi_row + hbs, mi_col + hbs, r,
+                         subsize);
         break;
       default:
         assert(0 && "Invalid partition type");
@@ -616,8 +654,14 @@ static void setup_display_size(VP9_COMMON *cm, struct vp9_read_bit_buffer *rb) {
     read_frame_size(rb, &cm->display_width, &cm->display_height);
 }
 
-static void apply_frame_size(VP9_COMMON *cm, int width, int height) {
+static void apply_frame_size(VP9Decoder *pbi, int width, int height) {
+  VP9_COMMON *const cm = &pbi->common;
+
   if (cm->width != width || cm->height != height) {
+    // The frames being decoded use the buffers resized below.
+    if (pbi->frame_parallel_decode)
+      vp9_frameworker_sync_all(pbi);
+
     // Change in frame size.
     // TODO(agrange) Don't test width/height, check overall size.
     if (width > cm->width || height > cm->height) {
@@ -643,15 +687,17 @@ static void apply_frame_size(VP9_COMMON *cm, int width, int height) {
   }
 }
 
-static void setup_frame_size(VP9_COMMON *cm, struct vp9_read_bit_buffer *rb) {
+static void setup_frame_size(VP9Decoder *pbi,
+                             struct vp9_read_bit_buffer *rb) {
   int width, height;
   read_frame_size(rb, &width, &height);
-  apply_frame_size(cm, width, height);
-  setup_display_size(cm, rb);
+  apply_frame_size(pbi, width, height);
+  setup_display_size(&pbi->common, rb);
 }
 
-static void setup_frame_size_with_refs(VP9_COMMON *cm,
+static void setup_frame_size_with_refs(VP9Decoder *pbi,
                                        struct vp9_read_bit_buffer *rb) {
+  VP9_COMMON *const cm = &pbi->common;
   int width, height;
   int found = 0, i;
   for (i = 0; i < REFS_PER_FRAME; ++i) {
@@ -671,7 +717,7 @@ static void setup_frame_size_with_refs(VP9_COMMON *cm,
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Referenced frame with invalid size");
 
-  apply_frame_size(cm, width, height);
+  apply_frame_size(pbi, width, height);
   setup_display_size(cm, rb);
 }
 
@@ -751,6 +797,32 @@ static void get_tile_buffers(VP9Decoder *pbi,
   }
 }
 
+// Frame-parallel decoding: waits until the mode info and segmentation map
+// rows of the superblock row are written by the frames decoded before.
+static void wait_for_sb_row(VP9Decoder *pbi, int mi_row) {
+  FrameWorkerData *const fwd = pbi->frame_worker_data;
+  VP9_COMMON *const cm = &pbi->common;
+  const int row = (mi_row + MI_BLOCK_SIZE) * MI_SIZE;
+
+  if (fwd->prev_fb_idx >= 0 && fwd->prev_row < row)
+    fwd->prev_row = vp9_frameworker_wait(fwd->owner, fwd->prev_fb_idx, row);
+  if (fwd->seg_fb_idx >= 0 && fwd->seg_row < row)
+    fwd->seg_row = vp9_frameworker_wait(fwd->owner, fwd->seg_fb_idx, row);
+  if (fwd->reset_seg_map)
+    vpx_memset(cm->last_frame_seg_map + mi_row * cm->mi_cols, 0,
+               MIN(MI_BLOCK_SIZE, cm->mi_rows - mi_row) * cm->mi_cols);
+}
+
+// Publishes the number of luma rows of the frame that are final, to the frames
+// decoded after it in frame-parallel decoding or else to the application.
+static void set_decoded_rows(VP9Decoder *pbi, int row) {
+  FrameWorkerData *const fwd = pbi->frame_worker_data;
+  if (fwd != NULL)
+    vp9_frameworker_broadcast(fwd->owner, fwd->fb_idx, row);
+  else if (pbi->decoded_rows_cb != NULL)
+    pbi->decoded_rows_cb(pbi->decoded_rows_priv, row);
+}
+
 static const uint8_t *decode_tiles(VP9Decoder *pbi,
                                    const uint8_t *data,
                                    const uint8_t *data_end) {
@@ -767,6 +839,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi,
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
                     vpx_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = (VP9WorkerHook)vp9_loop_filter_worker;
+    pbi->lf_worker.pool = pbi->worker_pool;
     if (pbi->max_threads > 1 && !vp9_worker_reset(&pbi->lf_worker)) {
       vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
                          "Loop filter thread creation failed");
@@ -812,10 +885,10 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi,
       TileInfo tile;
       const TileBuffer *const buf = &tile_buffers[tile_row][tile_col];
       tile_data = pbi->tile_data + tile_cols * tile_row + tile_col;
-      tile_data->cm = cm;
+      tile_data->pbi = pbi;
       tile_data->xd = pbi->mb;
       tile_data->xd.corrupted = 0;
-      vp9_tile_init(&tile, tile_data->cm, tile_row, tile_col);
+      vp9_tile_init(&tile, cm, tile_row, tile_col);
       setup_token_decoder(buf->data, data_end, buf->size, &cm->error,
                           &tile_data->bit_reader, pbi->decrypt_cb,
                           pbi->decrypt_state);
@@ -829,19 +902,23 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi,
     vp9_tile_set_row(&tile, cm, tile_row);
     for (mi_row = tile.mi_row_start; mi_row < tile.mi_row_end;
          mi_row += MI_BLOCK_SIZE) {
+      if (pbi->frame_worker_data != NULL)
+        wait_for_sb_row(pbi, mi_row);
       for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
         const int col = pbi->inv_tile_order ?
                         tile_cols - tile_col - 1 : tile_col;
         tile_data = pbi->tile_data + tile_cols * tile_row + col;
-        vp9_tile_set_col(&tile, tile_data->cm, col);
+        vp9_tile_set_col(&tile, cm, col);
         vp9_zero(tile_data->xd.left_context);
         vp9_zero(tile_data->xd.left_seg_context);
         for (mi_col = tile.mi_col_start; mi_col < tile.mi_col_end;
              mi_col += MI_BLOCK_SIZE) {
-          decode_partition(tile_data->cm, &tile_data->xd, &tile, mi_row, mi_col,
+          decode_partition(pbi, &tile_data->xd, &tile, mi_row, mi_col,
                            &tile_data->bit_reader, BLOCK_64X64);
         }
       }
+      if (!cm->lf.filter_level)
+        set_decoded_rows(pbi, (mi_row + MI_BLOCK_SIZE) * MI_SIZE);
       // Loopfilter one row.
       if (cm->lf.filter_level) {
         const int lf_start = mi_row - MI_BLOCK_SIZE;
@@ -853,13 +930,18 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi,
         // decoding has completed: finish up the loop filter in this thread.
         if (mi_row + MI_BLOCK_SIZE >= cm->mi_rows) continue;
 
+        // Filtering the next row may still modify the rows above it, up to
+        // 16 luma rows for the subsampled chroma planes.
         vp9_worker_sync(&pbi->lf_worker);
+        if (pbi->max_threads > 1 && lf_data->stop > 0)
+          set_decoded_rows(pbi, (lf_data->stop - 2) * MI_SIZE);
         lf_data->start = lf_start;
         lf_data->stop = mi_row;
         if (pbi->max_threads > 1) {
           vp9_worker_launch(&pbi->lf_worker);
         } else {
           vp9_worker_execute(&pbi->lf_worker);
+          set_decoded_rows(pbi, (mi_row - 2) * MI_SIZE);
         }
       }
     }
@@ -891,7 +973,7 @@ static int tile_worker_hook(void *arg1, void *arg2) {
     vp9_zero(tile_data->xd.left_seg_context);
     for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
          mi_col += MI_BLOCK_SIZE) {
-      decode_partition(tile_data->cm, &tile_data->xd, tile,
+      decode_partition(tile_data->pbi, &tile_data->xd, tile,
                        mi_row, mi_col, &tile_data->bit_reader, BLOCK_64X64);
     }
   }
@@ -942,6 +1024,7 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi,
       ++pbi->num_tile_workers;
 
       vp9_worker_init(worker);
+      worker->pool = pbi->worker_pool;
       CHECK_MEM_ERROR(cm, worker->data1,
                       vpx_memalign(32, sizeof(TileWorkerData)));
       CHECK_MEM_ERROR(cm, worker->data2, vpx_malloc(sizeof(TileInfo)));
@@ -996,10 +1079,10 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi,
       TileInfo *const tile = (TileInfo*)worker->data2;
       TileBuffer *const buf = &tile_buffers[0][n];
 
-      tile_data->cm = cm;
+      tile_data->pbi = pbi;
       tile_data->xd = pbi->mb;
       tile_data->xd.corrupted = 0;
-      vp9_tile_init(tile, tile_data->cm, 0, buf->col);
+      vp9_tile_init(tile, cm, 0, buf->col);
       setup_token_decoder(buf->data, data_end, buf->size, &cm->error,
                           &tile_data->bit_reader, pbi->decrypt_cb,
                           pbi->decrypt_state);
@@ -1124,7 +1207,7 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
       cm->frame_refs[i].buf = get_frame_new_buffer(cm);
     }
 
-    setup_frame_size(cm, rb);
+    setup_frame_size(pbi, rb);
   } else {
     cm->intra_only = cm->show_frame ? 0 : vp9_rb_read_bit(rb);
 
@@ -1135,7 +1218,7 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
       check_sync_code(cm, rb);
 
       pbi->refresh_frame_flags = vp9_rb_read_literal(rb, REF_FRAMES);
-      setup_frame_size(cm, rb);
+      setup_frame_size(pbi, rb);
     } else {
       pbi->refresh_frame_flags = vp9_rb_read_literal(rb, REF_FRAMES);
 
@@ -1147,7 +1230,7 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
         cm->ref_frame_sign_bias[LAST_FRAME + i] = vp9_rb_read_bit(rb);
       }
 
-      setup_frame_size_with_refs(cm, rb);
+      setup_frame_size_with_refs(pbi, rb);
 
       cm->allow_high_precision_mv = vp9_rb_read_bit(rb);
       cm->interp_filter = read_interp_filter(rb);
@@ -1158,8 +1241,11 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
                                           ref_buf->buf->y_crop_width,
                                           ref_buf->buf->y_crop_height,
                                           cm->width, cm->height);
-        if (vp9_is_scaled(&ref_buf->sf))
+        if (vp9_is_scaled(&ref_buf->sf)) {
+          if (pbi->frame_parallel_decode)
+            vp9_frameworker_sync_all(pbi);
           vp9_extend_frame_borders(ref_buf->buf);
+        }
       }
     }
   }
@@ -1178,10 +1264,27 @@ static size_t read_uncompressed_header(VP9Decoder *pbi,
   // below, forcing the use of context 0 for those frame types.
   cm->frame_context_idx = vp9_rb_read_literal(rb, FRAME_CONTEXTS_LOG2);
 
-  if (frame_is_intra_only(cm) || cm->error_resilient_mode)
-    vp9_setup_past_independence(cm);
+  if (frame_is_intra_only(cm) || cm->error_resilient_mode) {
+    if (pbi->frame_parallel_decode) {
+      // The segmentation map may still be in use by the frames being
+      // decoded: the frame worker clears it ahead of each superblock row.
+      unsigned char *const seg_map = cm->last_frame_seg_map;
+      cm->last_frame_seg_map = NULL;
+      vp9_setup_past_independence(cm);
+      cm->last_frame_seg_map = seg_map;
+      pbi->reset_seg_map = 1;
+    } else {
+      vp9_setup_past_independence(cm);
+    }
+  }
 
   setup_loopfilter(&cm->lf, rb);
+  if (pbi->skip_loop_filter == 2 ||
+      (pbi->skip_loop_filter == 1 && pbi->refresh_frame_flags == 0))
+    cm->lf.filter_level = 0;
+
+  pbi->mb.interp_kernel = pbi->bilinear_prediction ? vp9_bilinear_filters
+                                                   : NULL;
   setup_quantization(cm, &pbi->mb, rb);
   setup_segmentation(&cm->seg, rb);
 
@@ -1296,6 +1399,19 @@ static void debug_check_frame_counts(const VP9_COMMON *const cm) {
 }
 #endif  // NDEBUG
 
+static void adapt_probs(VP9_COMMON *cm) {
+  if (!cm->error_resilient_mode && !cm->frame_parallel_decoding_mode) {
+    vp9_adapt_coef_probs(cm);
+
+    if (!frame_is_intra_only(cm)) {
+      vp9_adapt_mode_probs(cm);
+      vp9_adapt_mv_probs(cm, cm->allow_high_precision_mv);
+    }
+  } else {
+    debug_check_frame_counts(cm);
+  }
+}
+
 static struct vp9_read_bit_buffer* init_read_bit_buffer(
     VP9Decoder *pbi,
     struct vp9_read_bit_buffer *rb,
@@ -1359,33 +1475,74 @@ void vp9_decode_frame(VP9Decoder *pbi,
   xd->corrupted = 0;
   new_fb->corrupted = read_compressed_header(pbi, data, first_partition_size);
 
+  if (pbi->frame_parallel_decode) {
+    // Backward adaptation needs the symbol counts of the whole frame, so the
+    // next header may only be parsed once this frame is decoded.
+    pbi->frame_context_pending = cm->refresh_frame_context &&
+                                 !cm->error_resilient_mode &&
+                                 !cm->frame_parallel_decoding_mode;
+    if (cm->refresh_frame_context && !pbi->frame_context_pending)
+      cm->frame_contexts[cm->frame_context_idx] = cm->fc;
+
+    vp9_frameworker_launch(pbi, data + first_partition_size, data_end);
+    *p_data_end = data_end;
+    return;
+  }
+
   // TODO(jzern): remove frame_parallel_decoding_mode restriction for
   // single-frame tile decoding.
   if (pbi->max_threads > 1 && tile_rows == 1 && tile_cols > 1 &&
       cm->frame_parallel_decoding_mode) {
+    // The decoder is using num_workers instead of pbi->num_tile_workers
+    // because it has been observed that using more threads on the
+    // loopfilter, than there are tile columns in the frame will hurt
+    // performance on Android. This is because the system will only
+    // schedule the tile decode workers on cores equal to the number
+    // of tile columns. Then if the decoder tries to use more threads for the
+    // loopfilter, it will hurt performance because of contention. If the
+    // multithreading code changes in the future then the number of workers
+    // used by the loopfilter should be revisited.
+    const int num_lf_workers = MIN(pbi->max_threads & ~1, tile_cols);
     *p_data_end = decode_tiles_mt(pbi, data + first_partition_size, data_end);
     // If multiple threads are used to decode tiles, then we use those threads
     // to do parallel loopfiltering.
-    vp9_loop_filter_frame_mt(new_fb, pbi, cm, cm->lf.filter_level, 0);
+    pbi->lf_row_sync.rows_done = pbi->decoded_rows_cb;
+    pbi->lf_row_sync.rows_done_priv = pbi->decoded_rows_priv;
+    vp9_loop_filter_frame_mt(new_fb, cm, pbi->mb.plane, cm->lf.filter_level,
+                             0, 0, pbi->tile_workers, num_lf_workers,
+                             &pbi->lf_row_sync);
   } else {
     *p_data_end = decode_tiles(pbi, data + first_partition_size, data_end);
   }
+  set_decoded_rows(pbi, cm->height);
 
   new_fb->corrupted |= xd->corrupted;
 
-  if (!new_fb->corrupted) {
-    if (!cm->error_resilient_mode && !cm->frame_parallel_decoding_mode) {
-      vp9_adapt_coef_probs(cm);
-
-      if (!frame_is_intra_only(cm)) {
-        vp9_adapt_mode_probs(cm);
-        vp9_adapt_mv_probs(cm, cm->allow_high_precision_mv);
-      }
-    } else {
-      debug_check_frame_counts(cm);
-    }
-  }
+  if (!new_fb->corrupted)
+    adapt_probs(cm);
 
   if (cm->refresh_frame_context)
     cm->frame_contexts[cm->frame_context_idx] = cm->fc;
 }
+
+void vp9_decode_frame_tiles(VP9Decoder *pbi,
+                            const uint8_t *data, const uint8_t *data_end) {
+  VP9_COMMON *const cm = &pbi->common;
+  MACROBLOCKD *const xd = &pbi->mb;
+  YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
+
+  xd->cur_buf = new_fb;
+  init_macroblockd(cm, xd);
+  setup_plane_dequants(cm, xd, cm->base_qindex);
+  vp9_setup_block_planes(xd, cm->subsampling_x, cm->subsampling_y);
+
+  vp9_zero(cm->counts);
+  vp9_zero(xd->dqcoeff);
+  xd->corrupted = 0;
+
+  decode_tiles(pbi, data, data_end);
+
+  new_fb->corrupted |= xd->corrupted;
+  if (!new_fb->corrupted)
+    adapt_probs(cm);
+}
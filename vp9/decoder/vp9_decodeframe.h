@@ -25,6 +25,11 @@ void vp9_decode_frame(struct VP9Decoder *pbi,
                       const uint8_t *data, const uint8_t *data_end,
                       const uint8_t **p_data_end);
 
+// Frame-parallel decoding: decodes the tile data of a frame whose headers
+// were parsed by the owner of the frame worker.
+void vp9_decode_frame_tiles(struct VP9Decoder *pbi,
+                            const uint8_t *data, const uint8_t *data_end);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
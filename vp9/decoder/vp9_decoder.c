@@ -82,10 +82,46 @@ VP9Decoder *vp9_decoder_create() {
   return pbi;
 }
 
+static void remove_frame_workers(VP9Decoder *pbi) {
+  int i;
+
+  for (i = 0; i < pbi->num_frame_workers; ++i) {
+    VP9Worker *const worker = &pbi->frame_workers[i];
+    FrameWorkerData *const fwd = (FrameWorkerData *)worker->data1;
+
+    vp9_worker_end(worker);
+    if (fwd == NULL)
+      continue;
+    if (fwd->pbi != NULL) {
+      VP9_COMMON *const wcm = &fwd->pbi->common;
+      // The frame buffers and the segmentation map belong to the owner; the
+      // worker only frees its mode info and above context arrays.
+      vp9_zero(wcm->frame_bufs);
+      vp9_zero(wcm->post_proc_buffer);
+      vp9_zero(wcm->int_frame_buffers);
+      wcm->last_frame_seg_map = NULL;
+      vp9_decoder_remove(fwd->pbi);
+    }
+    vpx_free(fwd->data);
+    vpx_free(fwd);
+  }
+  vpx_free(pbi->frame_workers);
+  pbi->frame_workers = NULL;
+  pbi->num_frame_workers = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&pbi->frame_mutex);
+  pthread_cond_destroy(&pbi->frame_cond);
+#endif
+}
+
 void vp9_decoder_remove(VP9Decoder *pbi) {
   VP9_COMMON *const cm = &pbi->common;
   int i;
 
+  if (pbi->frame_workers != NULL)
+    remove_frame_workers(pbi);
+
   vp9_remove_common(cm);
   vp9_worker_end(&pbi->lf_worker);
   vpx_free(pbi->lf_worker.data1);
@@ -98,15 +134,304 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
   }
   vpx_free(pbi->tile_workers);
 
-  if (pbi->num_tile_workers) {
-    const int sb_rows =
-        mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
-    vp9_loop_filter_dealloc(&pbi->lf_row_sync, sb_rows);
-  }
+  vp9_loop_filter_dealloc(&pbi->lf_row_sync);
 
   vpx_free(pbi);
 }
 
+static int frame_worker_hook(void *arg1, void *arg2) {
+  FrameWorkerData *const fwd = (FrameWorkerData *)arg1;
+  VP9Decoder *const pbi = fwd->pbi;
+  VP9_COMMON *const cm = &pbi->common;
+  int ok = 1;
+  (void)arg2;
+
+  if (setjmp(cm->error.jmp)) {
+    ok = 0;
+  } else {
+    cm->error.setjmp = 1;
+    vp9_decode_frame_tiles(pbi, fwd->data, fwd->data + fwd->data_size);
+  }
+  cm->error.setjmp = 0;
+
+  // Release the frames waiting on this one, even if it failed to decode.
+  vp9_frameworker_broadcast(fwd->owner, fwd->fb_idx, INT_MAX);
+  return ok;
+}
+
+int vp9_frameworker_create(VP9Decoder *pbi, int num_workers) {
+  int i;
+
+  pbi->frame_workers = (VP9Worker *)vpx_calloc(num_workers,
+                                               sizeof(*pbi->frame_workers));
+  if (pbi->frame_workers == NULL)
+    return 1;
+  pbi->num_frame_workers = num_workers;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&pbi->frame_mutex, NULL);
+  pthread_cond_init(&pbi->frame_cond, NULL);
+#endif
+
+  for (i = 0; i < num_workers; ++i) {
+    VP9Worker *const worker = &pbi->frame_workers[i];
+    FrameWorkerData *fwd;
+
+    vp9_worker_init(worker);
+    fwd = (FrameWorkerData *)vpx_calloc(1, sizeof(*fwd));
+    if (fwd == NULL)
+      return 1;
+    worker->data1 = fwd;
+    fwd->owner = pbi;
+    fwd->pbi = vp9_decoder_create();
+    if (fwd->pbi == NULL)
+      return 1;
+    fwd->pbi->frame_worker_data = fwd;
+    // The decoding progress is published as the loop filter completes, so
+    // the worker filters its frame itself.
+    fwd->pbi->max_threads = 1;
+
+    worker->hook = (VP9WorkerHook)frame_worker_hook;
+    if (!vp9_worker_reset(worker))
+      return 1;
+  }
+
+  for (i = 0; i < FRAME_BUFFERS; ++i)
+    pbi->frame_rows[i] = INT_MAX;
+  pbi->last_frame_worker = -1;
+  pbi->seg_frame_worker = -1;
+  pbi->frame_parallel_decode = 1;
+  return 0;
+}
+
+static FrameWorkerData *get_frame_worker_data(const VP9Decoder *pbi, int i) {
+  return (FrameWorkerData *)pbi->frame_workers[i].data1;
+}
+
+// Returns the frame buffer of frame 'frame_num' if it is still being decoded
+// by frame worker 'i', -1 otherwise.
+static int get_busy_fb(const VP9Decoder *pbi, int i, unsigned int frame_num) {
+  const FrameWorkerData *fwd;
+
+  if (i < 0)
+    return -1;
+  fwd = get_frame_worker_data(pbi, i);
+  return fwd->busy && fwd->frame_num == frame_num ? fwd->fb_idx : -1;
+}
+
+void vp9_ref_frame_buffer(VP9Decoder *pbi, int idx) {
+  ++pbi->common.frame_bufs[idx].ref_count;
+}
+
+void vp9_release_frame_buffer_ref(VP9Decoder *pbi, int idx) {
+  VP9_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const buf = &cm->frame_bufs[idx];
+
+  assert(buf->ref_count > 0);
+  if (--buf->ref_count == 0)
+    cm->release_fb_cb(cm->cb_priv, &buf->raw_frame_buffer);
+}
+
+// Sets up the worker instance with the headers parsed by 'pbi'. The worker
+// keeps its own error state, mode info and above context arrays.
+static void copy_frame_context(VP9Decoder *pbi, FrameWorkerData *fwd) {
+  VP9_COMMON *const cm = &pbi->common;
+  VP9Decoder *const wpbi = fwd->pbi;
+  VP9_COMMON *const wcm = &wpbi->common;
+  const struct vpx_internal_error_info error = wcm->error;
+  MODE_INFO *const mip = wcm->mip;
+  MODE_INFO *const prev_mip = wcm->prev_mip;
+  MODE_INFO **const mi_grid_base = wcm->mi_grid_base;
+  MODE_INFO **const prev_mi_grid_base = wcm->prev_mi_grid_base;
+  ENTROPY_CONTEXT *const above_context = wcm->above_context;
+  PARTITION_CONTEXT *const above_seg_context = wcm->above_seg_context;
+  MODE_INFO *prev_mi = NULL;
+  MODE_INFO **prev_mi_grid_visible = NULL;
+  int i;
+
+  // The mode info of the previous frame is in the arrays of the worker that
+  // decoded it, which may be this one.
+  if (cm->prev_mi != NULL && pbi->last_frame_worker >= 0) {
+    const VP9_COMMON *const last_cm =
+        &get_frame_worker_data(pbi, pbi->last_frame_worker)->pbi->common;
+    prev_mi = last_cm->mi;
+    prev_mi_grid_visible = last_cm->mi_grid_visible;
+  }
+
+  *wcm = *cm;
+  wcm->error = error;
+  wcm->mip = mip;
+  wcm->prev_mip = prev_mip;
+  wcm->mi_grid_base = mi_grid_base;
+  wcm->prev_mi_grid_base = prev_mi_grid_base;
+  wcm->above_context = above_context;
+  wcm->above_seg_context = above_seg_context;
+
+  if (fwd->mi_rows != cm->mi_rows || fwd->mi_cols != cm->mi_cols) {
+    fwd->mi_rows = fwd->mi_cols = 0;
+    if (vp9_alloc_context_buffers(wcm, cm->width, cm->height))
+      vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                         "Failed to allocate frame worker context buffers");
+    fwd->mi_rows = cm->mi_rows;
+    fwd->mi_cols = cm->mi_cols;
+  }
+
+  // Each worker alternates between two mode info arrays, so the arrays of
+  // its last frame stay intact while the next frame reads them.
+  vp9_swap_mi_and_prev_mi(wcm);
+  wcm->prev_mi = prev_mi;
+  wcm->prev_mi_grid_visible = prev_mi_grid_visible;
+
+  // Use the worker's copies of the frame buffer configurations.
+  for (i = 0; i < REFS_PER_FRAME; ++i) {
+    const int idx = wcm->frame_refs[i].idx;
+    if (idx >= 0 && idx < FRAME_BUFFERS)
+      wcm->frame_refs[i].buf = &wcm->frame_bufs[idx].buf;
+  }
+
+  wpbi->mb.lossless = pbi->mb.lossless;
+  wpbi->mb.itxm_add = pbi->mb.itxm_add;
+  wpbi->mb.interp_kernel = pbi->mb.interp_kernel;
+  wpbi->inv_tile_order = pbi->inv_tile_order;
+}
+
+void vp9_frameworker_launch(VP9Decoder *pbi,
+                            const uint8_t *data, const uint8_t *data_end) {
+  VP9_COMMON *const cm = &pbi->common;
+  const int worker_idx = pbi->next_frame_worker;
+  VP9Worker *const worker = &pbi->frame_workers[worker_idx];
+  FrameWorkerData *const fwd = get_frame_worker_data(pbi, worker_idx);
+  const size_t size = data_end - data;
+  int i;
+
+  assert(!fwd->busy);
+
+  if (size > fwd->data_alloc_size) {
+    vpx_free(fwd->data);
+    fwd->data_alloc_size = 0;
+    CHECK_MEM_ERROR(cm, fwd->data, (uint8_t *)vpx_malloc(size));
+    fwd->data_alloc_size = size;
+  }
+  // The tile data is decrypted here so the worker reads it directly.
+  if (pbi->decrypt_cb)
+    pbi->decrypt_cb(pbi->decrypt_state, data, fwd->data, (int)size);
+  else
+    vpx_memcpy(fwd->data, data, size);
+  fwd->data_size = size;
+
+  copy_frame_context(pbi, fwd);
+  fwd->pbi->decrypt_cb = NULL;
+
+  fwd->fb_idx = cm->new_fb_idx;
+  vp9_ref_frame_buffer(pbi, fwd->fb_idx);
+  for (i = 0; i < REFS_PER_FRAME; ++i) {
+    fwd->ref_fb_idx[i] = -1;
+    fwd->ref_row[i] = 0;
+    if (!frame_is_intra_only(cm)) {
+      fwd->ref_fb_idx[i] = cm->frame_refs[i].idx;
+      vp9_ref_frame_buffer(pbi, fwd->ref_fb_idx[i]);
+    }
+  }
+
+  fwd->prev_row = 0;
+  fwd->prev_fb_idx = fwd->pbi->common.prev_mi != NULL ?
+      get_busy_fb(pbi, pbi->last_frame_worker, pbi->last_frame_num) : -1;
+  if (fwd->prev_fb_idx >= 0)
+    vp9_ref_frame_buffer(pbi, fwd->prev_fb_idx);
+
+  fwd->seg_row = 0;
+  fwd->seg_fb_idx = -1;
+  fwd->reset_seg_map = pbi->reset_seg_map;
+  pbi->reset_seg_map = 0;
+  if (cm->seg.enabled || fwd->reset_seg_map) {
+    fwd->seg_fb_idx = get_busy_fb(pbi, pbi->seg_frame_worker,
+                                  pbi->seg_frame_num);
+    if (fwd->seg_fb_idx >= 0)
+      vp9_ref_frame_buffer(pbi, fwd->seg_fb_idx);
+    pbi->seg_frame_worker = worker_idx;
+    pbi->seg_frame_num = pbi->frame_num;
+  }
+
+  fwd->refresh_frame_context = pbi->frame_context_pending;
+  fwd->frame_num = pbi->frame_num;
+  pbi->last_frame_worker = worker_idx;
+  pbi->last_frame_num = pbi->frame_num;
+  ++pbi->frame_num;
+
+  // No other frame holds the new frame buffer yet.
+  pbi->frame_rows[fwd->fb_idx] = 0;
+  fwd->busy = 1;
+  ++pbi->num_busy_frame_workers;
+  pbi->next_frame_worker = (worker_idx + 1) % pbi->num_frame_workers;
+
+  worker->had_error = 0;
+  vp9_worker_launch(worker);
+}
+
+// Waits for the oldest frame being decoded and releases its frame buffers.
+static void collect_frame_worker(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  const int worker_idx = (pbi->next_frame_worker - pbi->num_busy_frame_workers +
+                          pbi->num_frame_workers) % pbi->num_frame_workers;
+  VP9Worker *const worker = &pbi->frame_workers[worker_idx];
+  FrameWorkerData *const fwd = get_frame_worker_data(pbi, worker_idx);
+  VP9_COMMON *const wcm = &fwd->pbi->common;
+  YV12_BUFFER_CONFIG *const buf = &cm->frame_bufs[fwd->fb_idx].buf;
+  const int ok = vp9_worker_sync(worker);
+  int i;
+
+  assert(fwd->busy);
+
+  buf->corrupted |= wcm->frame_bufs[fwd->fb_idx].buf.corrupted || !ok;
+  // Errors in the references are only known once they are decoded.
+  for (i = 0; i < REFS_PER_FRAME; ++i)
+    if (fwd->ref_fb_idx[i] >= 0)
+      buf->corrupted |= cm->frame_bufs[fwd->ref_fb_idx[i]].buf.corrupted;
+
+  if (!ok && pbi->frame_worker_error.error_code == VPX_CODEC_OK)
+    pbi->frame_worker_error = wcm->error;
+
+  if (fwd->refresh_frame_context)
+    cm->frame_contexts[wcm->frame_context_idx] = wcm->fc;
+
+  vp9_release_frame_buffer_ref(pbi, fwd->fb_idx);
+  for (i = 0; i < REFS_PER_FRAME; ++i)
+    if (fwd->ref_fb_idx[i] >= 0)
+      vp9_release_frame_buffer_ref(pbi, fwd->ref_fb_idx[i]);
+  if (fwd->prev_fb_idx >= 0)
+    vp9_release_frame_buffer_ref(pbi, fwd->prev_fb_idx);
+  if (fwd->seg_fb_idx >= 0)
+    vp9_release_frame_buffer_ref(pbi, fwd->seg_fb_idx);
+
+  fwd->busy = 0;
+  --pbi->num_busy_frame_workers;
+}
+
+void vp9_frameworker_sync_all(VP9Decoder *pbi) {
+  while (pbi->num_busy_frame_workers > 0)
+    collect_frame_worker(pbi);
+  pbi->frame_context_pending = 0;
+}
+
+int vp9_frameworker_is_busy(const VP9Decoder *pbi, int idx) {
+  int i;
+
+  for (i = 0; i < pbi->num_frame_workers; ++i) {
+    const FrameWorkerData *const fwd = get_frame_worker_data(pbi, i);
+    if (fwd->busy && fwd->fb_idx == idx)
+      return 1;
+  }
+  return 0;
+}
+
+static int has_free_fb(const VP9_COMMON *cm) {
+  int i;
+
+  for (i = 0; i < FRAME_BUFFERS; ++i)
+    if (cm->frame_bufs[i].ref_count == 0)
+      return 1;
+  return 0;
+}
+
 static int equal_dimensions(const YV12_BUFFER_CONFIG *a,
                             const YV12_BUFFER_CONFIG *b) {
     return a->y_height == b->y_height && a->y_width == b->y_width &&
@@ -239,10 +564,27 @@ int vp9_receive_compressed_data(VP9Decoder *pbi,
       cm->frame_refs[0].buf->corrupted = 1;
   }
 
-  // Check if the previous frame was a frame without any references to it.
-  if (cm->new_fb_idx >= 0 && cm->frame_bufs[cm->new_fb_idx].ref_count == 0)
-    cm->release_fb_cb(cm->cb_priv,
-                      &cm->frame_bufs[cm->new_fb_idx].raw_frame_buffer);
+  if (pbi->frame_parallel_decode) {
+    // The header of this frame is parsed with the frame context adapted by
+    // the last frame, if any. Otherwise only wait for a frame worker.
+    if (pbi->frame_context_pending)
+      vp9_frameworker_sync_all(pbi);
+    else if (pbi->num_busy_frame_workers == pbi->num_frame_workers)
+      collect_frame_worker(pbi);
+
+    while (!has_free_fb(cm) && pbi->num_busy_frame_workers > 0)
+      collect_frame_worker(pbi);
+    if (!has_free_fb(cm)) {
+      vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                         "No free frame buffer");
+      return -1;
+    }
+  } else {
+    // Check if the previous frame was a frame without any references to it.
+    if (cm->new_fb_idx >= 0 && cm->frame_bufs[cm->new_fb_idx].ref_count == 0)
+      cm->release_fb_cb(cm->cb_priv,
+                        &cm->frame_bufs[cm->new_fb_idx].raw_frame_buffer);
+  }
   cm->new_fb_idx = get_free_fb(cm);
 
   if (setjmp(cm->error.jmp)) {
@@ -258,8 +600,12 @@ int vp9_receive_compressed_data(VP9Decoder *pbi,
     if (cm->frame_refs[0].idx != INT_MAX)
       cm->frame_refs[0].buf->corrupted = 1;
 
-    if (cm->frame_bufs[cm->new_fb_idx].ref_count > 0)
-      cm->frame_bufs[cm->new_fb_idx].ref_count--;
+    if (cm->frame_bufs[cm->new_fb_idx].ref_count > 0) {
+      if (pbi->frame_parallel_decode)
+        vp9_release_frame_buffer_ref(pbi, cm->new_fb_idx);
+      else
+        cm->frame_bufs[cm->new_fb_idx].ref_count--;
+    }
 
     return -1;
   }
@@ -21,7 +21,7 @@
 
 #include "vp9/decoder/vp9_decoder.h"
 #include "vp9/decoder/vp9_dthread.h"
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,7 +29,7 @@ extern "C" {
 
 // TODO(hkuang): combine this with TileWorkerData.
 typedef struct TileData {
-  VP9_COMMON *cm;
+  struct VP9Decoder *pbi;
   vp9_reader bit_reader;
   DECLARE_ALIGNED(16, MACROBLOCKD, xd);
 } TileData;
@@ -57,6 +57,54 @@ typedef struct VP9Decoder {
 
   int max_threads;
   int inv_tile_order;
+  // Trade accuracy for speed: skip the loop filter on the frames that no
+  // other frame references (1) or on every frame (2), and predict with the
+  // bilinear filter. Errors build up until the next intra-only frame.
+  int skip_loop_filter;
+  int bilinear_prediction;
+  // Optional: threads, possibly shared with other decoders, that run the tile
+  // and loop filter jobs instead of threads of this instance.
+  VP9WorkerPool *worker_pool;
+
+  // Frame-parallel decoding (VPX_CODEC_USE_FRAME_THREADING). This instance
+  // parses the frame headers in decode order and hands the tile data of each
+  // frame to the next frame worker, which decodes it with its own instance.
+  int frame_parallel_decode;
+  VP9Worker *frame_workers;
+  int num_frame_workers;
+  int next_frame_worker;
+  int num_busy_frame_workers;
+  unsigned int frame_num;
+  // Worker and decode order of the last frame handed to a worker, and of the
+  // last one to access the segmentation map; -1 if none.
+  int last_frame_worker;
+  unsigned int last_frame_num;
+  int seg_frame_worker;
+  unsigned int seg_frame_num;
+  // The next header may only be parsed once the last frame has adapted its
+  // frame context.
+  int frame_context_pending;
+  // The current frame clears the segmentation map.
+  int reset_seg_map;
+  // First error reported by a frame worker, cleared once returned.
+  struct vpx_internal_error_info frame_worker_error;
+  // Number of luma rows of each frame buffer that are reconstructed and loop
+  // filtered, INT_MAX once the frame is decoded.
+  int frame_rows[FRAME_BUFFERS];
+#if CONFIG_MULTITHREAD
+  // Guards frame_rows.
+  pthread_mutex_t frame_mutex;
+  pthread_cond_t frame_cond;
+#endif
+
+  // Set on the instances used by the frame workers.
+  FrameWorkerData *frame_worker_data;
+
+  // Optional: called as a frame is decoded with the number of luma rows at the
+  // top of it that are final, ending with the frame height. Not used by
+  // frame-parallel decoding.
+  void (*decoded_rows_cb)(void *priv, int rows);
+  void *decoded_rows_priv;
 } VP9Decoder;
 
 int vp9_receive_compressed_data(struct VP9Decoder *pbi,
@@ -80,6 +128,27 @@ struct VP9Decoder *vp9_decoder_create();
 
 void vp9_decoder_remove(struct VP9Decoder *pbi);
 
+// Frame-parallel decoding: creates 'num_workers' frame workers. A shown frame
+// may be output once vp9_frameworker_is_busy() no longer reports its frame
+// buffer. Returns 0 on success.
+int vp9_frameworker_create(struct VP9Decoder *pbi, int num_workers);
+
+// Frame-parallel decoding: hands the tile data of the frame whose headers
+// were just parsed to the next frame worker.
+void vp9_frameworker_launch(struct VP9Decoder *pbi,
+                            const uint8_t *data, const uint8_t *data_end);
+
+// Frame-parallel decoding: waits for all the frames being decoded.
+void vp9_frameworker_sync_all(struct VP9Decoder *pbi);
+
+// Frame-parallel decoding: returns 1 while frame buffer 'idx' is decoding.
+int vp9_frameworker_is_busy(const struct VP9Decoder *pbi, int idx);
+
+// Takes or drops a reference to frame buffer 'idx', e.g. while a shown frame
+// is waiting to be output in frame-parallel mode.
+void vp9_ref_frame_buffer(struct VP9Decoder *pbi, int idx);
+void vp9_release_frame_buffer_ref(struct VP9Decoder *pbi, int idx);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -57,16 +57,22 @@ static const vp9_prob cat6_prob[15] = {
   254, 254, 254, 252, 249, 243, 230, 196, 177, 153, 140, 133, 130, 129, 0
 };
 
+// Reading a bool shifts at most 7 bits out of the value. A reader with this
+// many bits buffered can read two bools without a refill in between.
+#define TWO_BOOLS_MIN_COUNT 7
+
 #define INCREMENT_COUNT(token)                              \
   do {                                                      \
      if (!cm->frame_parallel_decoding_mode)                 \
        ++coef_counts[band][ctx][token];                     \
   } while (0)
 
+#define READ_BOOL(prob) read_bool(r, prob, &value, &count, &range)
+
 #define WRITE_COEF_CONTINUE(val, token)                  \
   {                                                      \
     v = (val * dqv) >> dq_shift;                         \
-    dqcoeff[scan[c]] = vp9_read_bit(r) ? -v : v;         \
+    dqcoeff[scan[c]] = READ_BOOL(128) ? -v : v;          \
     token_cache[scan[c]] = vp9_pt_energy_class[token];   \
     ++c;                                                 \
     ctx = get_coef_context(nb, token_cache, c);          \
@@ -76,9 +82,41 @@ static const vp9_prob cat6_prob[15] = {
 
 #define ADJUST_COEF(prob, bits_count)                   \
   do {                                                  \
-    val += (vp9_read(r, prob) << bits_count);           \
+    val += (READ_BOOL(prob) << bits_count);             \
   } while (0)
 
+static INLINE void fill_bools(vp9_reader *r, BD_VALUE *value, int *count) {
+  r->value = *value;
+  r->count = *count;
+  vp9_reader_fill(r);
+  *value = r->value;
+  *count = r->count;
+}
+
+// As vp9_read(), without the refill, on reader state the caller keeps in
+// locals. The new range and value are selected without branching on the
+// decoded bit, which is hard to predict.
+static INLINE int read_bool_nofill(int prob, BD_VALUE *value, int *count,
+                                   unsigned int *range) {
+  const unsigned int split = (*range * prob + (256 - prob)) >> CHAR_BIT;
+  const BD_VALUE bigsplit = (BD_VALUE)split << (BD_VALUE_SIZE - CHAR_BIT);
+  const int bit = *value >= bigsplit;
+  const unsigned int new_range = bit ? *range - split : split;
+  const int shift = vp9_norm[new_range];
+
+  *value = (*value - (bigsplit & -(BD_VALUE)bit)) << shift;
+  *range = new_range << shift;
+  *count -= shift;
+  return bit;
+}
+
+static INLINE int read_bool(vp9_reader *r, int prob, BD_VALUE *value,
+                            int *count, unsigned int *range) {
+  if (*count < 0)
+    fill_bools(r, value, count);
+  return read_bool_nofill(prob, value, count, range);
+}
+
 static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
                        int16_t *dqcoeff, TX_SIZE tx_size, const int16_t *dq,
                        int ctx, const int16_t *scan, const int16_t *nb,
@@ -101,6 +139,11 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
   const int dq_shift = (tx_size == TX_32X32);
   int v;
   int16_t dqv = dq[0];
+  // The reader state is kept in locals for the whole block, and only stored
+  // back for refills and on return.
+  BD_VALUE value = r->value;
+  int count = r->count;
+  unsigned int range = r->range;
 
   while (c < max_eob) {
     int val;
@@ -108,25 +151,36 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
     prob = coef_probs[band][ctx];
     if (!cm->frame_parallel_decoding_mode)
       ++eob_branch_count[band][ctx];
-    if (!vp9_read(r, prob[EOB_CONTEXT_NODE])) {
+
+    // The EOB and first ZERO decisions of a token share one refill check.
+    if (count < TWO_BOOLS_MIN_COUNT)
+      fill_bools(r, &value, &count);
+    if (!read_bool_nofill(prob[EOB_CONTEXT_NODE], &value, &count, &range)) {
       INCREMENT_COUNT(EOB_MODEL_TOKEN);
       break;
     }
 
-    while (!vp9_read(r, prob[ZERO_CONTEXT_NODE])) {
-      INCREMENT_COUNT(ZERO_TOKEN);
-      dqv = dq[1];
-      token_cache[scan[c]] = 0;
-      ++c;
-      if (c >= max_eob)
-        return c;  // zero tokens at the end (no eob token)
-      ctx = get_coef_context(nb, token_cache, c);
-      band = *band_translate++;
-      prob = coef_probs[band][ctx];
+    if (!read_bool_nofill(prob[ZERO_CONTEXT_NODE], &value, &count, &range)) {
+      do {
+        INCREMENT_COUNT(ZERO_TOKEN);
+        dqv = dq[1];
+        token_cache[scan[c]] = 0;
+        ++c;
+        if (c >= max_eob) {
+          // zero tokens at the end (no eob token)
+          r->value = value;
+          r->count = count;
+          r->range = range;
+          return c;
+        }
+        ctx = get_coef_context(nb, token_cache, c);
+        band = *band_translate++;
+        prob = coef_probs[band][ctx];
+      } while (!READ_BOOL(prob[ZERO_CONTEXT_NODE]));
     }
 
     // ONE_CONTEXT_NODE_0_
-    if (!vp9_read(r, prob[ONE_CONTEXT_NODE])) {
+    if (!READ_BOOL(prob[ONE_CONTEXT_NODE])) {
       INCREMENT_COUNT(ONE_TOKEN);
       WRITE_COEF_CONTINUE(1, ONE_TOKEN);
     }
@@ -135,18 +189,18 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
 
     prob = vp9_pareto8_full[prob[PIVOT_NODE] - 1];
 
-    if (!vp9_read(r, prob[LOW_VAL_CONTEXT_NODE])) {
-      if (!vp9_read(r, prob[TWO_CONTEXT_NODE])) {
+    if (!READ_BOOL(prob[LOW_VAL_CONTEXT_NODE])) {
+      if (!READ_BOOL(prob[TWO_CONTEXT_NODE])) {
         WRITE_COEF_CONTINUE(2, TWO_TOKEN);
       }
-      if (!vp9_read(r, prob[THREE_CONTEXT_NODE])) {
+      if (!READ_BOOL(prob[THREE_CONTEXT_NODE])) {
         WRITE_COEF_CONTINUE(3, THREE_TOKEN);
       }
       WRITE_COEF_CONTINUE(4, FOUR_TOKEN);
     }
 
-    if (!vp9_read(r, prob[HIGH_LOW_CONTEXT_NODE])) {
-      if (!vp9_read(r, prob[CAT_ONE_CONTEXT_NODE])) {
+    if (!READ_BOOL(prob[HIGH_LOW_CONTEXT_NODE])) {
+      if (!READ_BOOL(prob[CAT_ONE_CONTEXT_NODE])) {
         val = CAT1_MIN_VAL;
         ADJUST_COEF(CAT1_PROB0, 0);
         WRITE_COEF_CONTINUE(val, CATEGORY1_TOKEN);
@@ -157,8 +211,8 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
       WRITE_COEF_CONTINUE(val, CATEGORY2_TOKEN);
     }
 
-    if (!vp9_read(r, prob[CAT_THREEFOUR_CONTEXT_NODE])) {
-      if (!vp9_read(r, prob[CAT_THREE_CONTEXT_NODE])) {
+    if (!READ_BOOL(prob[CAT_THREEFOUR_CONTEXT_NODE])) {
+      if (!READ_BOOL(prob[CAT_THREE_CONTEXT_NODE])) {
         val = CAT3_MIN_VAL;
         ADJUST_COEF(CAT3_PROB2, 2);
         ADJUST_COEF(CAT3_PROB1, 1);
@@ -173,7 +227,7 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
       WRITE_COEF_CONTINUE(val, CATEGORY4_TOKEN);
     }
 
-    if (!vp9_read(r, prob[CAT_FIVE_CONTEXT_NODE])) {
+    if (!READ_BOOL(prob[CAT_FIVE_CONTEXT_NODE])) {
       val = CAT5_MIN_VAL;
       ADJUST_COEF(CAT5_PROB4, 4);
       ADJUST_COEF(CAT5_PROB3, 3);
@@ -185,12 +239,15 @@ static int decode_coefs(VP9_COMMON *cm, const MACROBLOCKD *xd, PLANE_TYPE type,
     val = 0;
     cat6 = cat6_prob;
     while (*cat6)
-      val = (val << 1) | vp9_read(r, *cat6++);
+      val = (val << 1) | READ_BOOL(*cat6++);
     val += CAT6_MIN_VAL;
 
     WRITE_COEF_CONTINUE(val, CATEGORY6_TOKEN);
   }
 
+  r->value = value;
+  r->count = count;
+  r->range = range;
   return c;
 }
 
@@ -12,46 +12,63 @@
 #define VP9_DECODER_VP9_DTHREAD_H_
 
 #include "./vpx_config.h"
+#include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/common/vp9_thread.h"
+#include "vp9/common/vp9_thread_common.h"
 #include "vp9/decoder/vp9_reader.h"
-#include "vp9/decoder/vp9_thread.h"
 
 struct VP9Common;
 struct VP9Decoder;
 
 typedef struct TileWorkerData {
-  struct VP9Common *cm;
+  struct VP9Decoder *pbi;
   vp9_reader bit_reader;
   DECLARE_ALIGNED(16, struct macroblockd, xd);
-
-  // Row-based parallel loopfilter data
-  LFWorkerData lfdata;
 } TileWorkerData;
 
-// Loopfilter row synchronization
-typedef struct VP9LfSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_;
-  pthread_cond_t *cond_;
-#endif
-  // Allocate memory to store the loop-filtered superblock index in each row.
-  int *cur_sb_col;
-  // The optimal sync_range for different resolution and platform should be
-  // determined by testing. Currently, it is chosen to be a power-of-2 number.
-  int sync_range;
-} VP9LfSync;
-
-// Allocate memory for loopfilter row synchronization.
-void vp9_loop_filter_alloc(struct VP9Common *cm, VP9LfSync *lf_sync,
-                           int rows, int width);
-
-// Deallocate loopfilter synchronization related mutex and data.
-void vp9_loop_filter_dealloc(VP9LfSync *lf_sync, int rows);
-
-// Multi-threaded loopfilter that uses the tile threads.
-void vp9_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
-                              struct VP9Decoder *pbi,
-                              struct VP9Common *cm,
-                              int frame_filter_level,
-                              int y_only);
+// Frame-parallel decoding: the frame handed to a frame worker.
+typedef struct FrameWorkerData {
+  struct VP9Decoder *pbi;    // Decoder instance used by the worker.
+  struct VP9Decoder *owner;  // Decoder instance that parsed the headers.
+  unsigned int frame_num;    // Decode order of the frame.
+  int busy;
+
+  // Copy of the tile data, as the caller may release its buffer before the
+  // frame is decoded.
+  uint8_t *data;
+  size_t data_size;
+  size_t data_alloc_size;
+
+  // Frame buffers held in the owner while the frame is decoded, -1 if unused:
+  // the frame itself, its references, the previous frame whose mode info is
+  // used for motion vector prediction, and the last frame to access the
+  // segmentation map. The last two are only set while still being decoded.
+  int fb_idx;
+  int ref_fb_idx[REFS_PER_FRAME];
+  int prev_fb_idx;
+  int seg_fb_idx;
+
+  // Decoding progress last seen for the frames above.
+  int ref_row[REFS_PER_FRAME];
+  int prev_row;
+  int seg_row;
+
+  // Clear the segmentation map ahead of each superblock row.
+  int reset_seg_map;
+  // The owner stores the adapted frame context once the frame is decoded.
+  int refresh_frame_context;
+
+  // Size of the worker's mode info arrays.
+  int mi_rows;
+  int mi_cols;
+} FrameWorkerData;
+
+// Frame-parallel decoding: waits until 'row' luma rows of frame buffer
+// 'fb_idx' have been decoded, and returns its decoding progress.
+int vp9_frameworker_wait(struct VP9Decoder *owner, int fb_idx, int row);
+
+// Frame-parallel decoding: publishes the decoding progress of frame buffer
+// 'fb_idx'.
+void vp9_frameworker_broadcast(struct VP9Decoder *owner, int fb_idx, int row);
 
 #endif  // VP9_DECODER_VP9_DTHREAD_H_
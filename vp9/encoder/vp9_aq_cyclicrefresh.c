@@ -31,17 +31,12 @@ struct CYCLIC_REFRESH {
   int sb_index;
   // Controls how long a block will need to wait to be refreshed again.
   int time_for_refresh;
-  // Actual number of (8x8) blocks that were applied delta-q (segment 1).
-  int num_seg_blocks;
   // Actual encoding bits for segment 1.
   int actual_seg_bits;
   // RD mult. parameters for segment 1.
   int rdmult;
   // Cyclic refresh map.
   signed char *map;
-  // Projected rate and distortion for the current superblock.
-  int64_t projected_rate_sb;
-  int64_t projected_dist_sb;
   // Thresholds applied to projected rate/distortion of the superblock.
   int64_t thresh_rate_sb;
   int64_t thresh_dist_sb;
@@ -92,12 +87,13 @@ static int apply_cyclic_refresh_bitrate(const VP9_COMMON *cm,
 // size of the coding block (i.e., below min_block size rejected), coding
 // mode, and rate/distortion.
 static int candidate_refresh_aq(const CYCLIC_REFRESH *cr,
+                                const MACROBLOCK *x,
                                 const MB_MODE_INFO *mbmi,
                                 BLOCK_SIZE bsize, int use_rd) {
   if (use_rd) {
     // If projected rate is below the thresh_rate (well below target,
     // so undershoot expected), accept it for lower-qp coding.
-    if (cr->projected_rate_sb < cr->thresh_rate_sb)
+    if (x->sb_projected_rate < cr->thresh_rate_sb)
       return 1;
     // Otherwise, reject the block for lower-qp coding if any of the following:
     // 1) prediction block size is below min_block_size
@@ -106,7 +102,7 @@ static int candidate_refresh_aq(const CYCLIC_REFRESH *cr,
     // another thresh_dist)
     else if (bsize < cr->min_block_size ||
              (mbmi->mv[0].as_int != 0 &&
-              cr->projected_dist_sb > cr->thresh_dist_sb) ||
+              x->sb_projected_dist > cr->thresh_dist_sb) ||
              !is_inter_block(mbmi))
       return 0;
     else
@@ -126,6 +122,7 @@ static int candidate_refresh_aq(const CYCLIC_REFRESH *cr,
 // check if we should reset the segment_id, and update the cyclic_refresh map
 // and segmentation map.
 void vp9_cyclic_refresh_update_segment(VP9_COMP *const cpi,
+                                       const MACROBLOCK *const x,
                                        MB_MODE_INFO *const mbmi,
                                        int mi_row, int mi_col,
                                        BLOCK_SIZE bsize, int use_rd) {
@@ -136,11 +133,11 @@ void vp9_cyclic_refresh_update_segment(VP9_COMP *const cpi,
   const int xmis = MIN(cm->mi_cols - mi_col, bw);
   const int ymis = MIN(cm->mi_rows - mi_row, bh);
   const int block_index = mi_row * cm->mi_cols + mi_col;
-  const int refresh_this_block = cpi->mb.in_static_area ||
-                                 candidate_refresh_aq(cr, mbmi, bsize, use_rd);
+  const int refresh_this_block = x->in_static_area ||
+      candidate_refresh_aq(cr, x, mbmi, bsize, use_rd);
   // Default is to not update the refresh map.
   int new_map_value = cr->map[block_index];
-  int x = 0; int y = 0;
+  int i, j;
 
   // Check if we should reset the segment_id for this block.
   if (mbmi->segment_id > 0 && !refresh_this_block)
@@ -164,16 +161,12 @@ void vp9_cyclic_refresh_update_segment(VP9_COMP *const cpi,
   }
   // Update entries in the cyclic refresh map with new_map_value, and
   // copy mbmi->segment_id into global segmentation map.
-  for (y = 0; y < ymis; y++)
-    for (x = 0; x < xmis; x++) {
-      cr->map[block_index + y * cm->mi_cols + x] = new_map_value;
-      cpi->segmentation_map[block_index + y * cm->mi_cols + x] =
+  for (j = 0; j < ymis; j++)
+    for (i = 0; i < xmis; i++) {
+      cr->map[block_index + j * cm->mi_cols + i] = new_map_value;
+      cpi->segmentation_map[block_index + j * cm->mi_cols + i] =
           mbmi->segment_id;
     }
-  // Keep track of actual number (in units of 8x8) of blocks in segment 1 used
-  // for encoding this frame.
-  if (mbmi->segment_id)
-    cr->num_seg_blocks += xmis * ymis;
 }
 
 // Setup cyclic background refresh: set delta q and segmentation map.
@@ -219,7 +212,6 @@ void vp9_cyclic_refresh_setup(VP9_COMP *const cpi) {
       cr->thresh_dist_sb = 4 * (int)(q * q);
     }
 
-    cr->num_seg_blocks = 0;
     // Set up segmentation.
     // Clear down the segment map.
     vpx_memset(seg_map, 0, cm->mi_rows * cm->mi_cols);
@@ -313,12 +305,6 @@ void vp9_cyclic_refresh_setup(VP9_COMP *const cpi) {
   }
 }
 
-void vp9_cyclic_refresh_set_rate_and_dist_sb(CYCLIC_REFRESH *cr,
-                                             int64_t rate_sb, int64_t dist_sb) {
-  cr->projected_rate_sb = rate_sb;
-  cr->projected_dist_sb = dist_sb;
-}
-
 int vp9_cyclic_refresh_get_rdmult(const CYCLIC_REFRESH *cr) {
   return cr->rdmult;
 }
@@ -14,6 +14,8 @@
 
 #include "vp9/common/vp9_blockd.h"
 
+#include "vp9/encoder/vp9_block.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,8 +31,10 @@ void vp9_cyclic_refresh_free(CYCLIC_REFRESH *cr);
 
 // Prior to coding a given prediction block, of size bsize at (mi_row, mi_col),
 // check if we should reset the segment_id, and update the cyclic_refresh map
-// and segmentation map.
+// and segmentation map. The projected rate/distortion of the enclosing SB64
+// and its static-area flag are read from x.
 void vp9_cyclic_refresh_update_segment(struct VP9_COMP *const cpi,
+                                       const MACROBLOCK *const x,
                                        MB_MODE_INFO *const mbmi,
                                        int mi_row, int mi_col,
                                        BLOCK_SIZE bsize, int use_rd);
@@ -38,9 +42,6 @@ void vp9_cyclic_refresh_update_segment(struct VP9_COMP *const cpi,
 // Setup cyclic background refresh: set delta q and segmentation map.
 void vp9_cyclic_refresh_setup(struct VP9_COMP *const cpi);
 
-void vp9_cyclic_refresh_set_rate_and_dist_sb(CYCLIC_REFRESH *cr,
-                                             int64_t rate_sb, int64_t dist_sb);
-
 int vp9_cyclic_refresh_get_rdmult(const CYCLIC_REFRESH *cr);
 
 #ifdef __cplusplus
@@ -16,11 +16,15 @@
 extern "C" {
 #endif
 
-struct VP9_COMP;
+#include "vp9/encoder/vp9_encoder.h"
 
 void vp9_entropy_mode_init();
 
-void vp9_pack_bitstream(struct VP9_COMP *cpi, uint8_t *dest, size_t *size);
+// Packs a tile of the current frame into its scratch buffer, for
+// vp9_pack_bitstream() to copy out once all the tiles are packed.
+void vp9_pack_tile(VP9_COMP *cpi, ThreadData *td, int tile_row, int tile_col);
+
+void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size);
 
 #ifdef __cplusplus
 }  // extern "C"
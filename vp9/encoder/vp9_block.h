@@ -32,6 +32,8 @@ struct macroblock_plane {
   int16_t *quant_shift;
   int16_t *zbin;
   int16_t *round;
+  int16_t *quant_fp;
+  int16_t *round_fp;
 
   // Zbin Over Quant value
   int16_t zbin_extra;
@@ -52,6 +54,9 @@ struct macroblock {
   int skip_recode;
   int skip_optimize;
   int q_index;
+  // Use the fast-path quantizer in the final encode of inter blocks.
+  int quant_fp;
+  int zbin_mode_boost;
 
   int errorperbit;
   int sadperbit16;
@@ -99,6 +104,11 @@ struct macroblock {
 
   int in_static_area;
 
+  // Projected rate and distortion of the current SB64, used by the cyclic
+  // refresh aq mode to decide whether to refresh a block.
+  int64_t sb_projected_rate;
+  int64_t sb_projected_dist;
+
   int optimize;
 
   // indicate if it is in the rd search loop or encoding process
@@ -108,6 +118,13 @@ struct macroblock {
   // Used to store sub partition's choices.
   MV pred_mv[MAX_REF_FRAMES];
 
+  // Motion of the block from the previous source, found on the pyramid.
+  MV pyramid_mv;
+
+  // Partition search limits, derived per SB64 from the neighboring blocks.
+  BLOCK_SIZE min_partition_size;
+  BLOCK_SIZE max_partition_size;
+
   void (*fwd_txm4x4)(const int16_t *input, int16_t *output, int stride);
 };
 
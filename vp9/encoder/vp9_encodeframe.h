@@ -19,6 +19,8 @@ extern "C" {
 struct macroblock;
 struct yv12_buffer_config;
 struct VP9_COMP;
+struct ThreadData;
+struct VP9RowMTSyncData;
 
 void vp9_setup_src_planes(struct macroblock *x,
                           const struct yv12_buffer_config *src,
@@ -26,6 +28,17 @@ void vp9_setup_src_planes(struct macroblock *x,
 
 void vp9_encode_frame(struct VP9_COMP *cpi);
 
+void vp9_init_tile_data(struct VP9_COMP *cpi);
+void vp9_free_tile_data(struct VP9_COMP *cpi);
+void vp9_encode_tile(struct VP9_COMP *cpi, struct ThreadData *td,
+                     int tile_row, int tile_col);
+
+// Encodes one superblock row of a tile for the row based multi-threaded
+// encoder. row_mt_sync orders it against the row above.
+void vp9_encode_sb_row(struct VP9_COMP *cpi, struct ThreadData *td,
+                       int tile_row, int tile_col, int mi_row,
+                       struct VP9RowMTSyncData *row_mt_sync);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
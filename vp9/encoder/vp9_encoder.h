@@ -22,10 +22,13 @@
 #include "vp9/common/vp9_entropy.h"
 #include "vp9/common/vp9_entropymode.h"
 #include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/common/vp9_thread.h"
+#include "vp9/common/vp9_thread_common.h"
 
 #include "vp9/encoder/vp9_aq_cyclicrefresh.h"
 #include "vp9/encoder/vp9_context_tree.h"
 #include "vp9/encoder/vp9_encodemb.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_firstpass.h"
 #include "vp9/encoder/vp9_lookahead.h"
 #include "vp9/encoder/vp9_mbgraph.h"
@@ -280,6 +283,13 @@ typedef struct VP9EncoderConfig {
   int tile_columns;
   int tile_rows;
 
+  int max_threads;
+  // Encode the superblock rows of each tile column as a wavefront.
+  int row_mt;
+  // The macroblocks that the active map marks inactive are unchanged from the
+  // previous source, so they need not be copied into the lookahead.
+  int inactive_unchanged;
+
   struct vpx_fixed_buf         two_pass_stats_in;
   struct vpx_codec_pkt_list  *output_pkt_list;
 
@@ -299,26 +309,72 @@ typedef struct RD_OPT {
   int thresh_mult_sub8x8[MAX_REFS];
 
   int threshes[MAX_SEGMENTS][BLOCK_SIZES][MAX_MODES];
-  int thresh_freq_fact[BLOCK_SIZES][MAX_MODES];
 
-  int64_t comp_pred_diff[REFERENCE_MODES];
   int64_t prediction_type_threshes[MAX_REF_FRAMES][REFERENCE_MODES];
-  int64_t tx_select_diff[TX_MODES];
   // FIXME(rbultje) can this overflow?
   int tx_select_threshes[MAX_REF_FRAMES][TX_MODES];
 
-  int64_t filter_diff[SWITCHABLE_FILTER_CONTEXTS];
   int64_t filter_threshes[MAX_REF_FRAMES][SWITCHABLE_FILTER_CONTEXTS];
-  int64_t filter_cache[SWITCHABLE_FILTER_CONTEXTS];
-  int64_t mask_filter;
 
   int RDMULT;
   int RDDIV;
+
+  // The coefficient probabilities the token costs were last filled from.
+  // Only the contexts whose probabilities have changed since are refilled.
+  vp9_coeff_probs_model token_cost_probs[TX_SIZES][PLANE_TYPES];
+  int token_costs_filled;
+  // The key frame intra mode costs come from fixed probabilities.
+  int kf_mode_costs_filled;
 } RD_OPT;
 
+// Statistics gathered by the rd loop of a single encoding thread. They are
+// accumulated over all threads once the frame has been encoded.
+typedef struct RD_COUNTS {
+  vp9_coeff_count coef_counts[TX_SIZES][PLANE_TYPES];
+  int64_t comp_pred_diff[REFERENCE_MODES];
+  int64_t tx_select_diff[TX_MODES];
+  int64_t filter_diff[SWITCHABLE_FILTER_CONTEXTS];
+  int use_large_partition_rate;
+} RD_COUNTS;
+
+// Alt-ref temporal filter applied to cpi->frames.
+typedef struct ARNRFilterData {
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  struct scale_factors sf;
+} ARNRFilterData;
+
+// Per-thread encoder state.
+typedef struct ThreadData {
+  MACROBLOCK mb;
+  RD_COUNTS rd_counts;
+  FRAME_COUNTS *counts;
+  // Largest motion vector component in the tiles this thread packed.
+  unsigned int max_mv_magnitude;
+
+  PICK_MODE_CONTEXT *leaf_tree;
+  PC_TREE *pc_tree;
+  PC_TREE *pc_root;
+} ThreadData;
+
+// Per-tile encoder state that persists across frames.
+typedef struct TileDataEnc {
+  TileInfo tile_info;
+  int thresh_freq_fact[BLOCK_SIZES][MAX_MODES];
+
+  // With row based multi-threading each superblock row adapts its own copy
+  // of thresh_freq_fact, so the result does not depend on the order in which
+  // the rows complete.
+  int (*row_thresh_freq_fact)[BLOCK_SIZES][MAX_MODES];
+  int sb_rows;
+} TileDataEnc;
+
+struct EncWorkerData;
+
 typedef struct VP9_COMP {
   QUANTS quants;
-  MACROBLOCK mb;
+  ThreadData td;
   VP9_COMMON common;
   VP9EncoderConfig oxcf;
   struct lookahead_ctx    *lookahead;
@@ -337,6 +393,9 @@ typedef struct VP9_COMP {
   YV12_BUFFER_CONFIG *unscaled_last_source;
   YV12_BUFFER_CONFIG scaled_last_source;
 
+  // Motion of the source from last_source, or NULL if not searched.
+  const PYRAMID *pyramid;
+
   int gold_is_last;  // gold same as last frame ( short circuit gold searches)
   int alt_is_last;  // Alt same as last ( short circuit altref search)
   int gold_is_alt;  // don't do both alt and gold search ( just do gold).
@@ -363,8 +422,18 @@ typedef struct VP9_COMP {
 
   YV12_BUFFER_CONFIG last_frame_uf;
 
-  TOKENEXTRA *tok;
-  unsigned int tok_count[4][1 << 6];
+  TileDataEnc *tile_data;
+  int allocated_tiles;  // Keep track of memory allocated for tiles.
+
+  TOKENEXTRA *tile_tok[4][1 << 6];
+  TOKENLIST *tplist[4][1 << 6];
+
+  // Scratch space the tiles are packed into on the encoder threads, before
+  // they are copied out one after another.
+  uint8_t *tile_pack_buf;
+  size_t tile_pack_buf_size;
+  uint8_t *tile_pack_data[4][1 << 6];
+  unsigned int tile_pack_size[4][1 << 6];
 
 #if CONFIG_MULTIPLE_ARF
   // Position within a frame coding order (including any additional ARF frames).
@@ -380,7 +449,6 @@ typedef struct VP9_COMP {
 
   CODING_CONTEXT coding_context;
 
-  int zbin_mode_boost;
   int zbin_mode_boost_enabled;
   int active_arnr_frames;           // <= cpi->oxcf.arnr_max_frames
   int active_arnr_strength;         // <= cpi->oxcf.arnr_max_strength
@@ -391,8 +459,6 @@ typedef struct VP9_COMP {
 
   RATE_CONTROL rc;
 
-  vp9_coeff_count coef_counts[TX_SIZES][PLANE_TYPES];
-
   struct vpx_codec_pkt_list  *output_pkt_list;
 
   MBGRAPH_FRAME_STATS mbgraph_stats[MAX_LAG_BUFFERS];
@@ -442,6 +508,7 @@ typedef struct VP9_COMP {
 
   YV12_BUFFER_CONFIG alt_ref_buffer;
   YV12_BUFFER_CONFIG *frames[MAX_LAG_BUFFERS];
+  ARNRFilterData arnr_filter_data;
 
 #if CONFIG_INTERNAL_STATS
   unsigned int mode_chosen_counts[MAX_MODES];
@@ -482,8 +549,6 @@ typedef struct VP9_COMP {
 
   int dummy_packing;    /* flag to indicate if packing is dummy */
 
-  unsigned int tx_stepdown_count[TX_SIZES];
-
   int initial_width;
   int initial_height;
 
@@ -503,9 +568,6 @@ typedef struct VP9_COMP {
   int y_mode_costs[INTRA_MODES][INTRA_MODES][INTRA_MODES];
   int switchable_interp_costs[SWITCHABLE_FILTER_CONTEXTS][SWITCHABLE_FILTERS];
 
-  PICK_MODE_CONTEXT *leaf_tree;
-  PC_TREE *pc_tree;
-  PC_TREE *pc_root;
   int partition_cost[PARTITION_CONTEXTS][PARTITION_TYPES];
 
 #if CONFIG_MULTIPLE_ARF
@@ -520,6 +582,17 @@ typedef struct VP9_COMP {
   int this_frame_weight;
   int max_arf_level;
 #endif
+
+  // Multi-threading
+  int num_workers;
+  VP9Worker *workers;
+  struct EncWorkerData *tile_thr_data;
+  VP9RowMTSync *row_mt_sync;  // One per tile column.
+  int row_mt_sync_cols;
+  VP9LfSync lf_row_sync;
+  VP9RowMTSync fp_row_mt_sync;  // Macroblock rows of the first pass.
+  FIRSTPASS_ROW_STATS *fp_row_stats;  // One per macroblock row.
+  int fp_row_stats_rows;
 } VP9_COMP;
 
 void vp9_initialize_enc();
@@ -530,10 +603,13 @@ void vp9_remove_compressor(VP9_COMP *cpi);
 void vp9_change_config(VP9_COMP *cpi, const VP9EncoderConfig *oxcf);
 
   // receive a frames worth of data. caller can assume that a copy of this
-  // frame is made and not just a copy of the pointer..
+  // frame is made and not just a copy of the pointer, unless zero_copy is
+  // non-NULL, in which case the frame is released through it later.
 int vp9_receive_raw_frame(VP9_COMP *cpi, unsigned int frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp,
+                          const vpx_zero_copy_input_t *zero_copy,
+                          void *user_priv);
 
 int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
                             size_t *size, uint8_t *dest,
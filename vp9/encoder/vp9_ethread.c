@@ -0,0 +1,527 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "./vpx_config.h"
+
+#include "vpx_mem/vpx_mem.h"
+
+#include "vp9/common/vp9_thread.h"
+
+#include "vp9/encoder/vp9_bitstream.h"
+#include "vp9/encoder/vp9_context_tree.h"
+#include "vp9/encoder/vp9_encodeframe.h"
+#include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_ethread.h"
+#include "vp9/encoder/vp9_firstpass.h"
+#include "vp9/encoder/vp9_temporal_filter.h"
+
+#if CONFIG_MULTITHREAD
+static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
+  const int kMaxTryLocks = 4000;
+  int locked = 0;
+  int i;
+
+  for (i = 0; i < kMaxTryLocks; ++i) {
+    if (!pthread_mutex_trylock(mutex)) {
+      locked = 1;
+      break;
+    }
+  }
+
+  if (!locked)
+    pthread_mutex_lock(mutex);
+}
+#endif  // CONFIG_MULTITHREAD
+
+static void accumulate_frame_counts(FRAME_COUNTS *dst,
+                                    const FRAME_COUNTS *src) {
+  // FRAME_COUNTS is made up exclusively of unsigned int counters.
+  unsigned int *const d = (unsigned int *)dst;
+  const unsigned int *const s = (const unsigned int *)src;
+  const size_t n = sizeof(*dst) / sizeof(*d);
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    d[i] += s[i];
+}
+
+static void accumulate_rd_counts(RD_COUNTS *dst, const RD_COUNTS *src) {
+  const unsigned int *const s = (const unsigned int *)src->coef_counts;
+  unsigned int *const d = (unsigned int *)dst->coef_counts;
+  const size_t n = sizeof(dst->coef_counts) / sizeof(*d);
+  size_t i;
+  int j;
+
+  for (i = 0; i < n; ++i)
+    d[i] += s[i];
+
+  for (j = 0; j < REFERENCE_MODES; ++j)
+    dst->comp_pred_diff[j] += src->comp_pred_diff[j];
+
+  for (j = 0; j < TX_MODES; ++j)
+    dst->tx_select_diff[j] += src->tx_select_diff[j];
+
+  for (j = 0; j < SWITCHABLE_FILTER_CONTEXTS; ++j)
+    dst->filter_diff[j] += src->filter_diff[j];
+
+  dst->use_large_partition_rate += src->use_large_partition_rate;
+}
+
+static int enc_worker_hook(EncWorkerData *const thread_data, void *unused) {
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  int t;
+
+  (void) unused;
+
+  for (t = thread_data->start; t < tile_cols; t += cpi->num_workers) {
+    int tile_row;
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      vp9_encode_tile(cpi, thread_data->td, tile_row, t);
+  }
+
+  return 0;
+}
+
+static int enc_row_worker_hook(EncWorkerData *const thread_data,
+                               void *unused) {
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  int tile_col, tile_row;
+
+  (void) unused;
+
+  // Rows are handed out round-robin over the whole height of each tile
+  // column, since tile rows are not independent of each other.
+  for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+      const TileInfo *const tile_info =
+          &cpi->tile_data[tile_row * tile_cols + tile_col].tile_info;
+      int mi_row;
+
+      for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
+           mi_row += MI_BLOCK_SIZE) {
+        const int sb_row = mi_row >> MI_BLOCK_SIZE_LOG2;
+        if (sb_row % cpi->num_workers == thread_data->start)
+          vp9_encode_sb_row(cpi, thread_data->td, tile_row, tile_col, mi_row,
+                            &cpi->row_mt_sync[tile_col]);
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i;
+
+  // Create the threads and allocate their thread data on first use, and
+  // again whenever more are needed than there are, e.g. when row based
+  // multi-threading follows frames encoded with one thread per tile column.
+  if (cpi->num_workers >= num_workers)
+    return;
+  vp9_free_enc_workers(cpi);
+
+  CHECK_MEM_ERROR(cm, cpi->workers,
+                  vpx_malloc(num_workers * sizeof(*cpi->workers)));
+
+  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
+                  vpx_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+
+  for (i = 0; i < num_workers; ++i) {
+    VP9Worker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    ++cpi->num_workers;
+
+    vp9_worker_init(worker);
+    thread_data->cpi = cpi;
+
+    if (i < num_workers - 1) {
+      // Allocate thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td,
+                      vpx_memalign(32, sizeof(*thread_data->td)));
+      vp9_zero(*thread_data->td);
+      vp9_setup_pc_tree(cm, thread_data->td);
+
+      // Allocate frame counters in thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td->counts,
+                      vpx_calloc(1, sizeof(*thread_data->td->counts)));
+
+      // Create threads
+      if (!vp9_worker_reset(worker))
+        vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
+                           "Tile encoder thread creation failed");
+    } else {
+      // Main thread acts as a worker and uses the thread data in cpi.
+      thread_data->td = &cpi->td;
+    }
+
+    worker->data1 = thread_data;
+    worker->data2 = NULL;
+  }
+}
+
+static void launch_enc_workers(VP9_COMP *cpi, VP9WorkerHook hook) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i;
+
+  // Before encoding a frame, copy the thread data from cpi.
+  for (i = 0; i < cpi->num_workers; ++i) {
+    VP9Worker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = (EncWorkerData*)worker->data1;
+
+    worker->hook = hook;
+    thread_data->start = i;
+
+    if (thread_data->td != &cpi->td) {
+      thread_data->td->mb = cpi->td.mb;
+      vp9_zero(thread_data->td->rd_counts);
+      vp9_zero(*thread_data->td->counts);
+    }
+
+    // Set up the non-RD coefficient buffers for this thread's pc_tree. These
+    // are only swapped per block on the RD path.
+    if (cpi->sf.use_nonrd_pick_mode) {
+      MACROBLOCK *const x = &thread_data->td->mb;
+      MACROBLOCKD *const xd = &x->e_mbd;
+      struct macroblock_plane *const p = x->plane;
+      struct macroblockd_plane *const pd = xd->plane;
+      PICK_MODE_CONTEXT *ctx = &thread_data->td->pc_root->none;
+      int j;
+
+      for (j = 0; j < MAX_MB_PLANE; ++j) {
+        p[j].coeff = ctx->coeff_pbuf[j][0];
+        p[j].qcoeff = ctx->qcoeff_pbuf[j][0];
+        pd[j].dqcoeff = ctx->dqcoeff_pbuf[j][0];
+        p[j].eobs = ctx->eobs_pbuf[j][0];
+      }
+    }
+  }
+
+  // Encode a frame
+  for (i = 0; i < cpi->num_workers; ++i) {
+    VP9Worker *const worker = &cpi->workers[i];
+
+    // Main thread acts as a worker.
+    if (i == cpi->num_workers - 1)
+      vp9_worker_execute(worker);
+    else
+      vp9_worker_launch(worker);
+  }
+
+  // Encoding ends.
+  for (i = 0; i < cpi->num_workers; ++i) {
+    VP9Worker *const worker = &cpi->workers[i];
+    vp9_worker_sync(worker);
+  }
+
+  for (i = 0; i < cpi->num_workers; ++i) {
+    VP9Worker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = (EncWorkerData*)worker->data1;
+
+    // Accumulate counters.
+    if (i < cpi->num_workers - 1) {
+      accumulate_frame_counts(&cm->counts, thread_data->td->counts);
+      accumulate_rd_counts(&cpi->td.rd_counts, &thread_data->td->rd_counts);
+    }
+  }
+}
+
+void vp9_free_enc_workers(VP9_COMP *cpi) {
+  int t;
+
+  for (t = 0; t < cpi->num_workers; ++t) {
+    VP9Worker *const worker = &cpi->workers[t];
+    EncWorkerData *const thread_data = (EncWorkerData*)worker->data1;
+
+    // Deallocate allocated threads.
+    vp9_worker_end(worker);
+
+    // Deallocate allocated thread data.
+    if (t < cpi->num_workers - 1) {
+      vpx_free(thread_data->td->counts);
+      vp9_free_pc_tree(thread_data->td);
+      vpx_free(thread_data->td);
+    }
+  }
+  vpx_free(cpi->tile_thr_data);
+  cpi->tile_thr_data = NULL;
+  vpx_free(cpi->workers);
+  cpi->workers = NULL;
+  cpi->num_workers = 0;
+}
+
+void vp9_encode_tiles_mt(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+
+  vp9_init_tile_data(cpi);
+  create_enc_workers(cpi, MIN(cpi->oxcf.max_threads, tile_cols));
+  launch_enc_workers(cpi, (VP9WorkerHook)enc_worker_hook);
+}
+
+static int get_sync_range(int width) {
+  // nsync numbers are picked by testing. For example, for 4k
+  // video, using 4 gives best performance.
+  if (width < 640)
+    return 1;
+  else if (width <= 1280)
+    return 2;
+  else if (width <= 4096)
+    return 4;
+  else
+    return 8;
+}
+
+void vp9_row_mt_sync_mem_alloc(VP9_COMMON *cm, VP9RowMTSync *row_mt_sync,
+                               int rows, int width) {
+#if CONFIG_MULTITHREAD
+  int i;
+#endif  // CONFIG_MULTITHREAD
+
+  // Set first so that a failed allocation can still be released.
+  row_mt_sync->rows = rows;
+  row_mt_sync->width = width;
+
+#if CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                  vpx_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+  for (i = 0; i < rows; ++i) {
+    pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+  }
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                  vpx_malloc(sizeof(*row_mt_sync->cond_) * rows));
+  for (i = 0; i < rows; ++i) {
+    pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->cur_sb_col,
+                  vpx_malloc(sizeof(*row_mt_sync->cur_sb_col) * rows));
+
+  // Set up nsync.
+  row_mt_sync->sync_range = get_sync_range(width);
+}
+
+void vp9_row_mt_sync_mem_dealloc(VP9RowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      }
+      vpx_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      }
+      vpx_free(row_mt_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    vpx_free(row_mt_sync->cur_sb_col);
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    vp9_zero(*row_mt_sync);
+  }
+}
+
+void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c) {
+#if CONFIG_MULTITHREAD
+  if (row_mt_sync != NULL) {
+    const int nsync = row_mt_sync->sync_range;
+
+    if (r && !(c & (nsync - 1))) {
+      pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
+      mutex_lock(mutex);
+
+      while (c > row_mt_sync->cur_sb_col[r - 1] - nsync) {
+        pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
+      }
+      pthread_mutex_unlock(mutex);
+    }
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void vp9_row_mt_sync_write(VP9RowMTSync *const row_mt_sync, int r, int c,
+                           const int sb_cols) {
+#if CONFIG_MULTITHREAD
+  if (row_mt_sync != NULL) {
+    const int nsync = row_mt_sync->sync_range;
+    int cur;
+    // Only signal when there are enough encoded SB for next row to run.
+    int sig = 1;
+
+    if (c < sb_cols - 1) {
+      cur = c;
+      if (c % nsync)
+        sig = 0;
+    } else {
+      cur = sb_cols + nsync;
+    }
+
+    if (sig) {
+      mutex_lock(&row_mt_sync->mutex_[r]);
+
+      row_mt_sync->cur_sb_col[r] = cur;
+
+      pthread_cond_signal(&row_mt_sync->cond_[r]);
+      pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+    }
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void vp9_encode_tiles_row_mt(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
+  const int tile_width = cm->width >> cm->log2_tile_cols;
+  int i;
+
+  vp9_init_tile_data(cpi);
+  create_enc_workers(cpi, cpi->oxcf.max_threads);
+
+  // One wavefront per tile column; (re)allocate when the number of tile
+  // columns, the superblock rows or the width the sync range depends on
+  // changes.
+  if (cpi->row_mt_sync == NULL || cpi->row_mt_sync_cols != tile_cols ||
+      cpi->row_mt_sync[0].rows != sb_rows ||
+      cpi->row_mt_sync[0].width != tile_width) {
+    for (i = 0; i < cpi->row_mt_sync_cols; ++i)
+      vp9_row_mt_sync_mem_dealloc(&cpi->row_mt_sync[i]);
+    vpx_free(cpi->row_mt_sync);
+    cpi->row_mt_sync_cols = 0;
+    CHECK_MEM_ERROR(cm, cpi->row_mt_sync,
+                    vpx_calloc(tile_cols, sizeof(*cpi->row_mt_sync)));
+    cpi->row_mt_sync_cols = tile_cols;
+    for (i = 0; i < tile_cols; ++i)
+      vp9_row_mt_sync_mem_alloc(cm, &cpi->row_mt_sync[i], sb_rows,
+                                tile_width);
+  }
+
+  // Initialize cur_sb_col to -1 for all SB rows.
+  for (i = 0; i < tile_cols; ++i)
+    vpx_memset(cpi->row_mt_sync[i].cur_sb_col, -1,
+               sizeof(*cpi->row_mt_sync[i].cur_sb_col) * sb_rows);
+
+  launch_enc_workers(cpi, (VP9WorkerHook)enc_row_worker_hook);
+}
+
+static int first_pass_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  int mb_row;
+
+  (void) unused;
+
+  for (mb_row = thread_data->start; mb_row < cm->mb_rows;
+       mb_row += cpi->num_workers)
+    vp9_first_pass_encode_mb_row(cpi, thread_data->td, mb_row,
+                                 &cpi->fp_row_mt_sync);
+
+  return 0;
+}
+
+void vp9_first_pass_rows_mt(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+
+  create_enc_workers(cpi, cpi->oxcf.max_threads);
+
+  if (cpi->fp_row_mt_sync.rows != cm->mb_rows ||
+      cpi->fp_row_mt_sync.width != cm->width) {
+    vp9_row_mt_sync_mem_dealloc(&cpi->fp_row_mt_sync);
+    vp9_row_mt_sync_mem_alloc(cm, &cpi->fp_row_mt_sync, cm->mb_rows,
+                              cm->width);
+  }
+
+  // Initialize cur_sb_col to -1 for all MB rows.
+  vpx_memset(cpi->fp_row_mt_sync.cur_sb_col, -1,
+             sizeof(*cpi->fp_row_mt_sync.cur_sb_col) * cm->mb_rows);
+
+  launch_enc_workers(cpi, (VP9WorkerHook)first_pass_worker_hook);
+}
+
+static int temporal_filter_worker_hook(EncWorkerData *const thread_data,
+                                       void *unused) {
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  int mb_row;
+
+  (void) unused;
+
+  for (mb_row = thread_data->start; mb_row < cm->mb_rows;
+       mb_row += cpi->num_workers)
+    vp9_temporal_filter_iterate_row(cpi, thread_data->td, mb_row);
+
+  return 0;
+}
+
+void vp9_temporal_filter_row_mt(VP9_COMP *cpi) {
+  create_enc_workers(cpi, cpi->oxcf.max_threads);
+  launch_enc_workers(cpi, (VP9WorkerHook)temporal_filter_worker_hook);
+}
+
+static int pack_tiles_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  VP9_COMP *const cpi = thread_data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  int tile_row, tile_col;
+
+  (void) unused;
+
+  thread_data->td->max_mv_magnitude = 0;
+  for (tile_col = thread_data->start; tile_col < tile_cols;
+       tile_col += cpi->num_workers) {
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      vp9_pack_tile(cpi, thread_data->td, tile_row, tile_col);
+  }
+
+  return 0;
+}
+
+void vp9_pack_tiles_mt(VP9_COMP *cpi) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  int i;
+
+  create_enc_workers(cpi, MIN(cpi->oxcf.max_threads, tile_cols));
+  launch_enc_workers(cpi, (VP9WorkerHook)pack_tiles_worker_hook);
+
+  for (i = 0; i < cpi->num_workers; ++i) {
+    const EncWorkerData *const thread_data =
+        (const EncWorkerData *)cpi->workers[i].data1;
+    cpi->max_mv_magnitude = MAX(cpi->max_mv_magnitude,
+                                thread_data->td->max_mv_magnitude);
+  }
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_ENCODER_VP9_ETHREAD_H_
+#define VP9_ENCODER_VP9_ETHREAD_H_
+
+#include "./vpx_config.h"
+#include "vp9/common/vp9_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct VP9Common;
+struct VP9_COMP;
+struct ThreadData;
+
+typedef struct EncWorkerData {
+  struct VP9_COMP *cpi;
+  struct ThreadData *td;
+  int start;
+} EncWorkerData;
+
+// Encodes the tile columns of the current frame in parallel. Each worker
+// owns a private ThreadData; the per-thread statistics are merged back into
+// the main thread's once all workers have finished.
+void vp9_encode_tiles_mt(struct VP9_COMP *cpi);
+
+// Superblock row synchronization for the row based multi-threaded encoder.
+// A superblock may only be encoded once the row above has finished the
+// superblock to its top-right, as its above context, motion vector candidates
+// and intra edge pixels come from there.
+typedef struct VP9RowMTSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // Allocate memory to store the last encoded superblock index in each row.
+  int *cur_sb_col;
+  // The optimal sync_range for different resolution and platform should be
+  // determined by testing. Currently, it is chosen to be a power-of-2 number.
+  int sync_range;
+  int rows;
+  // Width the sync_range was picked for.
+  int width;
+} VP9RowMTSync;
+
+// Allocate memory for superblock row synchronization.
+void vp9_row_mt_sync_mem_alloc(struct VP9Common *cm, VP9RowMTSync *row_mt_sync,
+                               int rows, int width);
+
+// Deallocate superblock row synchronization related mutex and data.
+void vp9_row_mt_sync_mem_dealloc(VP9RowMTSync *row_mt_sync);
+
+// Wait until row r - 1 is far enough ahead to encode superblock c of row r.
+// A NULL row_mt_sync is a no-op.
+void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c);
+
+// Signal that superblock c of row r has been encoded.
+void vp9_row_mt_sync_write(VP9RowMTSync *const row_mt_sync, int r, int c,
+                           const int sb_cols);
+
+// Encodes the superblock rows of each tile column in wavefront order, with
+// the rows distributed over all the encoder threads.
+void vp9_encode_tiles_row_mt(struct VP9_COMP *cpi);
+
+// Runs the first pass over the macroblock rows of the frame in wavefront
+// order, with the rows distributed over all the encoder threads.
+void vp9_first_pass_rows_mt(struct VP9_COMP *cpi);
+
+// Applies the alt-ref temporal filter with the macroblock rows distributed
+// over all the encoder threads.
+void vp9_temporal_filter_row_mt(struct VP9_COMP *cpi);
+
+// Packs the tiles of the current frame into their scratch buffers, with the
+// tile columns distributed over the encoder threads. Each column is packed
+// top to bottom by one thread, as tile rows share the above context.
+void vp9_pack_tiles_mt(struct VP9_COMP *cpi);
+
+// Ends the encoder threads and frees their thread data.
+void vp9_free_enc_workers(struct VP9_COMP *cpi);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_ENCODER_VP9_ETHREAD_H_
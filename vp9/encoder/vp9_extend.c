@@ -28,7 +28,8 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
 
   for (i = 0; i < h; i++) {
     vpx_memset(dst_ptr1, src_ptr1[0], extend_left);
-    vpx_memcpy(dst_ptr1 + extend_left, src_ptr1, w);
+    if (src != dst)
+      vpx_memcpy(dst_ptr1 + extend_left, src_ptr1, w);
     vpx_memset(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
@@ -55,8 +56,38 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
   }
 }
 
-void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
-                               YV12_BUFFER_CONFIG *dst) {
+// Copies the part of a plane that lies under the luma rectangle at (x, y) of
+// size w x h, extending it into the border by the given amounts on the sides
+// where it reaches the edge of the plane. ss_x and ss_y are the subsampling
+// of the plane relative to luma.
+static void copy_and_extend_plane_rect(const uint8_t *src, int src_pitch,
+                                       uint8_t *dst, int dst_pitch,
+                                       int plane_w, int plane_h,
+                                       int ss_x, int ss_y,
+                                       int x, int y, int w, int h,
+                                       int extend_top, int extend_left,
+                                       int extend_bottom, int extend_right) {
+  const int x0 = x >> ss_x;
+  const int y0 = y >> ss_y;
+  const int x1 = MIN((x + w + ss_x) >> ss_x, plane_w);
+  const int y1 = MIN((y + h + ss_y) >> ss_y, plane_h);
+
+  copy_and_extend_plane(src + y0 * src_pitch + x0, src_pitch,
+                        dst + y0 * dst_pitch + x0, dst_pitch,
+                        x1 - x0, y1 - y0,
+                        y0 == 0 ? extend_top : 0,
+                        x0 == 0 ? extend_left : 0,
+                        y1 == plane_h ? extend_bottom : 0,
+                        x1 == plane_w ? extend_right : 0);
+}
+
+// Copies the luma rectangle at (x, y) of size w x h, and the matching parts
+// of the other planes, from src to dst, or only extends them if src and dst
+// are the same frame. The border next to the rectangle is extended exactly
+// as a copy of the whole frame would extend it.
+static void copy_and_extend_rect(const YV12_BUFFER_CONFIG *src,
+                                 YV12_BUFFER_CONFIG *dst,
+                                 int x, int y, int w, int h) {
   // Extend src frame in buffer
   // Altref filtering assumes 16 pixel extension
   const int et_y = 16;
@@ -76,68 +107,50 @@ void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
   const int er_uv = er_y >> uv_width_subsampling;
 
 #if CONFIG_ALPHA
-  const int et_a = dst->border >> (dst->alpha_height != dst->y_height);
-  const int el_a = dst->border >> (dst->alpha_width != dst->y_width);
+  const int alpha_width_subsampling = (dst->alpha_width != dst->y_width);
+  const int alpha_height_subsampling = (dst->alpha_height != dst->y_height);
+  const int et_a = dst->border >> alpha_height_subsampling;
+  const int el_a = dst->border >> alpha_width_subsampling;
   const int eb_a = et_a + dst->alpha_height - src->alpha_height;
   const int er_a = el_a + dst->alpha_width - src->alpha_width;
 
-  copy_and_extend_plane(src->alpha_buffer, src->alpha_stride,
-                        dst->alpha_buffer, dst->alpha_stride,
-                        src->alpha_width, src->alpha_height,
-                        et_a, el_a, eb_a, er_a);
+  copy_and_extend_plane_rect(src->alpha_buffer, src->alpha_stride,
+                             dst->alpha_buffer, dst->alpha_stride,
+                             src->alpha_width, src->alpha_height,
+                             alpha_width_subsampling, alpha_height_subsampling,
+                             x, y, w, h, et_a, el_a, eb_a, er_a);
 #endif
 
-  copy_and_extend_plane(src->y_buffer, src->y_stride,
-                        dst->y_buffer, dst->y_stride,
-                        src->y_width, src->y_height,
-                        et_y, el_y, eb_y, er_y);
+  copy_and_extend_plane_rect(src->y_buffer, src->y_stride,
+                             dst->y_buffer, dst->y_stride,
+                             src->y_width, src->y_height, 0, 0,
+                             x, y, w, h, et_y, el_y, eb_y, er_y);
+
+  copy_and_extend_plane_rect(src->u_buffer, src->uv_stride,
+                             dst->u_buffer, dst->uv_stride,
+                             src->uv_width, src->uv_height,
+                             uv_width_subsampling, uv_height_subsampling,
+                             x, y, w, h, et_uv, el_uv, eb_uv, er_uv);
+
+  copy_and_extend_plane_rect(src->v_buffer, src->uv_stride,
+                             dst->v_buffer, dst->uv_stride,
+                             src->uv_width, src->uv_height,
+                             uv_width_subsampling, uv_height_subsampling,
+                             x, y, w, h, et_uv, el_uv, eb_uv, er_uv);
+}
 
-  copy_and_extend_plane(src->u_buffer, src->uv_stride,
-                        dst->u_buffer, dst->uv_stride,
-                        src->uv_width, src->uv_height,
-                        et_uv, el_uv, eb_uv, er_uv);
+void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
+                               YV12_BUFFER_CONFIG *dst) {
+  copy_and_extend_rect(src, dst, 0, 0, src->y_width, src->y_height);
+}
 
-  copy_and_extend_plane(src->v_buffer, src->uv_stride,
-                        dst->v_buffer, dst->uv_stride,
-                        src->uv_width, src->uv_height,
-                        et_uv, el_uv, eb_uv, er_uv);
+void vp9_extend_frame_in_place(YV12_BUFFER_CONFIG *ybf) {
+  copy_and_extend_rect(ybf, ybf, 0, 0, ybf->y_width, ybf->y_height);
 }
 
 void vp9_copy_and_extend_frame_with_rect(const YV12_BUFFER_CONFIG *src,
                                          YV12_BUFFER_CONFIG *dst,
                                          int srcy, int srcx,
                                          int srch, int srcw) {
-  // If the side is not touching the bounder then don't extend.
-  const int et_y = srcy ? 0 : dst->border;
-  const int el_y = srcx ? 0 : dst->border;
-  const int eb_y = srcy + srch != src->y_height ? 0 :
-                      dst->border + dst->y_height - src->y_height;
-  const int er_y = srcx + srcw != src->y_width ? 0 :
-                      dst->border + dst->y_width - src->y_width;
-  const int src_y_offset = srcy * src->y_stride + srcx;
-  const int dst_y_offset = srcy * dst->y_stride + srcx;
-
-  const int et_uv = ROUND_POWER_OF_TWO(et_y, 1);
-  const int el_uv = ROUND_POWER_OF_TWO(el_y, 1);
-  const int eb_uv = ROUND_POWER_OF_TWO(eb_y, 1);
-  const int er_uv = ROUND_POWER_OF_TWO(er_y, 1);
-  const int src_uv_offset = ((srcy * src->uv_stride) >> 1) + (srcx >> 1);
-  const int dst_uv_offset = ((srcy * dst->uv_stride) >> 1) + (srcx >> 1);
-  const int srch_uv = ROUND_POWER_OF_TWO(srch, 1);
-  const int srcw_uv = ROUND_POWER_OF_TWO(srcw, 1);
-
-  copy_and_extend_plane(src->y_buffer + src_y_offset, src->y_stride,
-                        dst->y_buffer + dst_y_offset, dst->y_stride,
-                        srcw, srch,
-                        et_y, el_y, eb_y, er_y);
-
-  copy_and_extend_plane(src->u_buffer + src_uv_offset, src->uv_stride,
-                        dst->u_buffer + dst_uv_offset, dst->uv_stride,
-                        srcw_uv, srch_uv,
-                        et_uv, el_uv, eb_uv, er_uv);
-
-  copy_and_extend_plane(src->v_buffer + src_uv_offset, src->uv_stride,
-                        dst->v_buffer + dst_uv_offset, dst->uv_stride,
-                        srcw_uv, srch_uv,
-                        et_uv, el_uv, eb_uv, er_uv);
+  copy_and_extend_rect(src, dst, srcx, srcy, srcw, srch);
 }
@@ -22,6 +22,14 @@ extern "C" {
 void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst);
 
+// Extends the borders of a source frame by as much as
+// vp9_copy_and_extend_frame() does, writing at most
+// VP9_ZERO_COPY_INPUT_BORDER pixels (scaled for chroma) beyond each edge.
+void vp9_extend_frame_in_place(YV12_BUFFER_CONFIG *ybf);
+
+// Copies the luma rectangle at (srcx, srcy) and the matching chroma and alpha
+// pixels, extending the border next to it the same way as
+// vp9_copy_and_extend_frame().
 void vp9_copy_and_extend_frame_with_rect(const YV12_BUFFER_CONFIG *src,
                                          YV12_BUFFER_CONFIG *dst,
                                          int srcy, int srcx,
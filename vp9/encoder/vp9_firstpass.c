@@ -459,87 +459,61 @@ static BLOCK_SIZE get_bsize(const VP9_COMMON *cm, int mb_row, int mb_col) {
   }
 }
 
-void vp9_first_pass(VP9_COMP *cpi) {
-  int mb_row, mb_col;
-  MACROBLOCK *const x = &cpi->mb;
-  VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &x->e_mbd;
-  TileInfo tile;
-  struct macroblock_plane *const p = x->plane;
-  struct macroblockd_plane *const pd = xd->plane;
-  const PICK_MODE_CONTEXT *ctx = &cpi->pc_root->none;
-  int i;
-
-  int recon_yoffset, recon_uvoffset;
-  YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
-  YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
-  YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
-  int recon_y_stride = lst_yv12->y_stride;
-  int recon_uv_stride = lst_yv12->uv_stride;
-  int uv_mb_height = 16 >> (lst_yv12->y_height > lst_yv12->uv_height);
-  int64_t intra_error = 0;
-  int64_t coded_error = 0;
-  int64_t sr_coded_error = 0;
-
-  int sum_mvr = 0, sum_mvc = 0;
-  int sum_mvr_abs = 0, sum_mvc_abs = 0;
-  int64_t sum_mvrs = 0, sum_mvcs = 0;
-  int mvcount = 0;
-  int intercount = 0;
-  int second_ref_count = 0;
-  int intrapenalty = 256;
-  int neutral_count = 0;
-  int new_mv_count = 0;
-  int sum_in_vectors = 0;
-  uint32_t lastmv_as_int = 0;
-  TWO_PASS *twopass = &cpi->twopass;
-  const MV zero_mv = {0, 0};
-  const YV12_BUFFER_CONFIG *first_ref_buf = lst_yv12;
-
-  vp9_clear_system_state();
+// Returns the reference frame used for the first pass motion search.
+static const YV12_BUFFER_CONFIG *get_first_ref_buf(VP9_COMP *cpi) {
+  const YV12_BUFFER_CONFIG *scaled_ref_buf = NULL;
 
   if (cpi->use_svc && cpi->svc.number_temporal_layers == 1) {
-    MV_REFERENCE_FRAME ref_frame = LAST_FRAME;
-    const YV12_BUFFER_CONFIG *scaled_ref_buf = NULL;
-    twopass = &cpi->svc.layer_context[cpi->svc.spatial_layer_id].twopass;
-
-    vp9_scale_references(cpi);
-
     // Use either last frame or alt frame for motion search.
-    if (cpi->ref_frame_flags & VP9_LAST_FLAG) {
+    if (cpi->ref_frame_flags & VP9_LAST_FLAG)
       scaled_ref_buf = vp9_get_scaled_ref_frame(cpi, LAST_FRAME);
-      ref_frame = LAST_FRAME;
-    } else if (cpi->ref_frame_flags & VP9_ALT_FLAG) {
+    else if (cpi->ref_frame_flags & VP9_ALT_FLAG)
       scaled_ref_buf = vp9_get_scaled_ref_frame(cpi, ALTREF_FRAME);
-      ref_frame = ALTREF_FRAME;
-    }
-
-    if (scaled_ref_buf != NULL) {
-      // Update the stride since we are using scaled reference buffer
-      first_ref_buf = scaled_ref_buf;
-      recon_y_stride = first_ref_buf->y_stride;
-      recon_uv_stride = first_ref_buf->uv_stride;
-      uv_mb_height = 16 >> (first_ref_buf->y_height > first_ref_buf->uv_height);
-    }
+  }
 
-    // Disable golden frame for svc first pass for now.
-    gld_yv12 = NULL;
-    set_ref_ptrs(cm, xd, ref_frame, NONE);
+  return scaled_ref_buf != NULL ? scaled_ref_buf
+                                : get_ref_frame_buffer(cpi, LAST_FRAME);
+}
 
-    cpi->Source = vp9_scale_if_required(cm, cpi->un_scaled_source,
-                                        &cpi->scaled_source);
-  }
+static YV12_BUFFER_CONFIG *get_gld_buf(VP9_COMP *cpi) {
+  // Disable golden frame for svc first pass for now.
+  if (cpi->use_svc && cpi->svc.number_temporal_layers == 1)
+    return NULL;
+  return get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+}
 
-  vp9_setup_src_planes(x, cpi->Source, 0, 0);
-  vp9_setup_pre_planes(xd, 0, first_ref_buf, 0, 0, NULL);
-  vp9_setup_dst_planes(xd->plane, new_yv12, 0, 0);
+void vp9_first_pass_encode_mb_row(VP9_COMP *cpi, ThreadData *td, int mb_row,
+                                  VP9RowMTSync *const row_mt_sync) {
+  int mb_col;
+  MACROBLOCK *const x = &td->mb;
+  VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  TileInfo tile;
+  struct macroblock_plane *const p = x->plane;
+  struct macroblockd_plane *const pd = xd->plane;
+  const PICK_MODE_CONTEXT *ctx = &td->pc_root->none;
+  FIRSTPASS_ROW_STATS *const stats = &cpi->fp_row_stats[mb_row];
+  int i;
 
-  xd->mi = cm->mi_grid_visible;
-  xd->mi[0] = cm->mi;
+  const YV12_BUFFER_CONFIG *const first_ref_buf = get_first_ref_buf(cpi);
+  const YV12_BUFFER_CONFIG *const gld_yv12 = get_gld_buf(cpi);
+  YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
+  const int recon_y_stride = first_ref_buf->y_stride;
+  const int recon_uv_stride = first_ref_buf->uv_stride;
+  const int uv_mb_height =
+      16 >> (first_ref_buf->y_height > first_ref_buf->uv_height);
+  int recon_yoffset = mb_row * recon_y_stride * 16;
+  int recon_uvoffset = mb_row * recon_uv_stride * uv_mb_height;
+  const int intrapenalty = 256;
+  const MV zero_mv = {0, 0};
+  int_mv best_ref_mv;
 
-  vp9_setup_block_planes(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
+  // Each row works on its own copy of the mode info, so that rows can be
+  // encoded in any order.
+  MODE_INFO mi = *cm->mi;
+  MODE_INFO *mi_ptr = &mi;
 
-  vp9_frame_init_quantizer(cpi);
+  xd->mi = &mi_ptr;
 
   for (i = 0; i < MAX_MB_PLANE; ++i) {
     p[i].coeff = ctx->coeff_pbuf[i][1];
@@ -549,268 +523,366 @@ void vp9_first_pass(VP9_COMP *cpi) {
   }
   x->skip_recode = 0;
 
-  vp9_init_mv_probs(cm);
-  vp9_initialize_rd_consts(cpi);
-
   // Tiling is ignored in the first pass.
   vp9_tile_init(&tile, cm, 0, 0);
 
-  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-    int_mv best_ref_mv;
+  vp9_zero(*stats);
+  best_ref_mv.as_int = 0;
 
-    best_ref_mv.as_int = 0;
+  x->plane[0].src.buf = cpi->Source->y_buffer +
+                        mb_row * 16 * x->plane[0].src.stride;
+  x->plane[1].src.buf = cpi->Source->u_buffer +
+                        mb_row * uv_mb_height * x->plane[1].src.stride;
+  x->plane[2].src.buf = cpi->Source->v_buffer +
+                        mb_row * uv_mb_height * x->plane[1].src.stride;
 
-    // Reset above block coeffs.
-    xd->up_available = (mb_row != 0);
-    recon_yoffset = (mb_row * recon_y_stride * 16);
-    recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
+  // Reset above block coeffs.
+  xd->up_available = (mb_row != 0);
 
-    // Set up limit values for motion vectors to prevent them extending
-    // outside the UMV borders.
-    x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
-    x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16)
-                    + BORDER_MV_PIXELS_B16;
+  // Set up limit values for motion vectors to prevent them extending
+  // outside the UMV borders.
+  x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
+  x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16)
+                  + BORDER_MV_PIXELS_B16;
 
-    for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-      int this_error;
-      const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
-      double error_weight = 1.0;
-      const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
+  for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
+    int this_error;
+    const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
+    double error_weight = 1.0;
+    const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
 
-      vp9_clear_system_state();
+    // Intra prediction uses the reconstruction of the row above.
+    vp9_row_mt_sync_read(row_mt_sync, mb_row, mb_col);
 
-      xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
-      xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
-      xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
-      xd->left_available = (mb_col != 0);
-      xd->mi[0]->mbmi.sb_type = bsize;
-      xd->mi[0]->mbmi.ref_frame[0] = INTRA_FRAME;
-      set_mi_row_col(xd, &tile,
-                     mb_row << 1, num_8x8_blocks_high_lookup[bsize],
-                     mb_col << 1, num_8x8_blocks_wide_lookup[bsize],
-                     cm->mi_rows, cm->mi_cols);
+    vp9_clear_system_state();
 
-      if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-        const int energy = vp9_block_energy(cpi, x, bsize);
-        error_weight = vp9_vaq_inv_q_ratio(energy);
-      }
+    xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
+    xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
+    xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
+    xd->left_available = (mb_col != 0);
+    xd->mi[0]->mbmi.sb_type = bsize;
+    xd->mi[0]->mbmi.ref_frame[0] = INTRA_FRAME;
+    set_mi_row_col(xd, &tile,
+                   mb_row << 1, num_8x8_blocks_high_lookup[bsize],
+                   mb_col << 1, num_8x8_blocks_wide_lookup[bsize],
+                   cm->mi_rows, cm->mi_cols);
+
+    if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
+      const int energy = vp9_block_energy(cpi, x, bsize);
+      error_weight = vp9_vaq_inv_q_ratio(energy);
+    }
+
+    // Do intra 16x16 prediction.
+    x->skip_encode = 0;
+    xd->mi[0]->mbmi.mode = DC_PRED;
+    xd->mi[0]->mbmi.tx_size = use_dc_pred ?
+       (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
+    vp9_encode_intra_block_plane(x, bsize, 0);
+    this_error = vp9_get_mb_ss(x->plane[0].src_diff);
+
+    if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
+      vp9_clear_system_state();
+      this_error = (int)(this_error * error_weight);
+    }
 
-      // Do intra 16x16 prediction.
-      x->skip_encode = 0;
-      xd->mi[0]->mbmi.mode = DC_PRED;
-      xd->mi[0]->mbmi.tx_size = use_dc_pred ?
-         (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
-      vp9_encode_intra_block_plane(x, bsize, 0);
-      this_error = vp9_get_mb_ss(x->plane[0].src_diff);
+    // Intrapenalty below deals with situations where the intra and inter
+    // error scores are very low (e.g. a plain black frame).
+    // We do not have special cases in first pass for 0,0 and nearest etc so
+    // all inter modes carry an overhead cost estimate for the mv.
+    // When the error score is very low this causes us to pick all or lots of
+    // INTRA modes and throw lots of key frames.
+    // This penalty adds a cost matching that of a 0,0 mv to the intra case.
+    this_error += intrapenalty;
 
+    // Accumulate the intra error.
+    stats->intra_error += (int64_t)this_error;
+
+    // Set up limit values for motion vectors to prevent them extending
+    // outside the UMV borders.
+    x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
+    x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
+
+    // Other than for the first frame do a motion search.
+    if (cm->current_video_frame > 0) {
+      int tmp_err, motion_error;
+      int_mv mv, tmp_mv;
+
+      xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
+      motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                          &xd->plane[0].pre[0]);
+      // Assume 0,0 motion with no mv overhead.
+      mv.as_int = tmp_mv.as_int = 0;
+
+      // Test last reference frame using the previous best mv as the
+      // starting point (best reference) for the search.
+      first_pass_motion_search(cpi, x, &best_ref_mv.as_mv, &mv.as_mv,
+                               &motion_error);
       if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
         vp9_clear_system_state();
-        this_error = (int)(this_error * error_weight);
+        motion_error = (int)(motion_error * error_weight);
       }
 
-      // Intrapenalty below deals with situations where the intra and inter
-      // error scores are very low (e.g. a plain black frame).
-      // We do not have special cases in first pass for 0,0 and nearest etc so
-      // all inter modes carry an overhead cost estimate for the mv.
-      // When the error score is very low this causes us to pick all or lots of
-      // INTRA modes and throw lots of key frames.
-      // This penalty adds a cost matching that of a 0,0 mv to the intra case.
-      this_error += intrapenalty;
-
-      // Accumulate the intra error.
-      intra_error += (int64_t)this_error;
-
-      // Set up limit values for motion vectors to prevent them extending
-      // outside the UMV borders.
-      x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
-      x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
+      // If the current best reference mv is not centered on 0,0 then do a 0,0
+      // based search as well.
+      if (best_ref_mv.as_int) {
+        tmp_err = INT_MAX;
+        first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv.as_mv,
+                                 &tmp_err);
+        if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
+          vp9_clear_system_state();
+          tmp_err = (int)(tmp_err * error_weight);
+        }
 
-      // Other than for the first frame do a motion search.
-      if (cm->current_video_frame > 0) {
-        int tmp_err, motion_error;
-        int_mv mv, tmp_mv;
+        if (tmp_err < motion_error) {
+          motion_error = tmp_err;
+          mv.as_int = tmp_mv.as_int;
+        }
+      }
 
-        xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
-        motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                            &xd->plane[0].pre[0]);
+      // Search in an older reference frame.
+      if (cm->current_video_frame > 1 && gld_yv12 != NULL) {
         // Assume 0,0 motion with no mv overhead.
-        mv.as_int = tmp_mv.as_int = 0;
+        int gf_motion_error;
 
-        // Test last reference frame using the previous best mv as the
-        // starting point (best reference) for the search.
-        first_pass_motion_search(cpi, x, &best_ref_mv.as_mv, &mv.as_mv,
-                                 &motion_error);
+        xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
+        gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                               &xd->plane[0].pre[0]);
+
+        first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv.as_mv,
+                                 &gf_motion_error);
         if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
           vp9_clear_system_state();
-          motion_error = (int)(motion_error * error_weight);
+          gf_motion_error = (int)(gf_motion_error * error_weight);
         }
 
-        // If the current best reference mv is not centered on 0,0 then do a 0,0
-        // based search as well.
-        if (best_ref_mv.as_int) {
-          tmp_err = INT_MAX;
-          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv.as_mv,
-                                   &tmp_err);
-          if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-            vp9_clear_system_state();
-            tmp_err = (int)(tmp_err * error_weight);
+        if (gf_motion_error < motion_error && gf_motion_error < this_error)
+          ++stats->second_ref_count;
+
+        // Reset to last frame as reference buffer.
+        xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
+        xd->plane[1].pre[0].buf = first_ref_buf->u_buffer + recon_uvoffset;
+        xd->plane[2].pre[0].buf = first_ref_buf->v_buffer + recon_uvoffset;
+
+        // In accumulating a score for the older reference frame take the
+        // best of the motion predicted score and the intra coded error
+        // (just as will be done for) accumulation of "coded_error" for
+        // the last frame.
+        if (gf_motion_error < this_error)
+          stats->sr_coded_error += gf_motion_error;
+        else
+          stats->sr_coded_error += this_error;
+      } else {
+        stats->sr_coded_error += motion_error;
+      }
+      // Start by assuming that intra mode is best.
+      best_ref_mv.as_int = 0;
+
+      if (motion_error <= this_error) {
+        // Keep a count of cases where the inter and intra were very close
+        // and very low. This helps with scene cut detection for example in
+        // cropped clips with black bars at the sides or top and bottom.
+        if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
+            this_error < 2 * intrapenalty)
+          ++stats->neutral_count;
+
+        mv.as_mv.row *= 8;
+        mv.as_mv.col *= 8;
+        this_error = motion_error;
+        xd->mi[0]->mbmi.mode = NEWMV;
+        xd->mi[0]->mbmi.mv[0] = mv;
+        xd->mi[0]->mbmi.tx_size = TX_4X4;
+        xd->mi[0]->mbmi.ref_frame[0] = LAST_FRAME;
+        xd->mi[0]->mbmi.ref_frame[1] = NONE;
+        vp9_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1, bsize);
+        vp9_encode_sby_pass1(x, bsize);
+        stats->sum_mvr += mv.as_mv.row;
+        stats->sum_mvr_abs += abs(mv.as_mv.row);
+        stats->sum_mvc += mv.as_mv.col;
+        stats->sum_mvc_abs += abs(mv.as_mv.col);
+        stats->sum_mvrs += mv.as_mv.row * mv.as_mv.row;
+        stats->sum_mvcs += mv.as_mv.col * mv.as_mv.col;
+        ++stats->intercount;
+
+        best_ref_mv.as_int = mv.as_int;
+
+        if (mv.as_int) {
+          // Non-zero vector, was it different from the last non zero vector?
+          // The first one of the row is compared when the rows are merged.
+          if (!stats->mvcount)
+            stats->first_mv_as_int = mv.as_int;
+          else if (mv.as_int != stats->last_mv_as_int)
+            ++stats->new_mv_count;
+          stats->last_mv_as_int = mv.as_int;
+          ++stats->mvcount;
+
+          // Does the row vector point inwards or outwards?
+          if (mb_row < cm->mb_rows / 2) {
+            if (mv.as_mv.row > 0)
+              --stats->sum_in_vectors;
+            else if (mv.as_mv.row < 0)
+              ++stats->sum_in_vectors;
+          } else if (mb_row > cm->mb_rows / 2) {
+            if (mv.as_mv.row > 0)
+              ++stats->sum_in_vectors;
+            else if (mv.as_mv.row < 0)
+              --stats->sum_in_vectors;
           }
 
-          if (tmp_err < motion_error) {
-            motion_error = tmp_err;
-            mv.as_int = tmp_mv.as_int;
+          // Does the col vector point inwards or outwards?
+          if (mb_col < cm->mb_cols / 2) {
+            if (mv.as_mv.col > 0)
+              --stats->sum_in_vectors;
+            else if (mv.as_mv.col < 0)
+              ++stats->sum_in_vectors;
+          } else if (mb_col > cm->mb_cols / 2) {
+            if (mv.as_mv.col > 0)
+              ++stats->sum_in_vectors;
+            else if (mv.as_mv.col < 0)
+              --stats->sum_in_vectors;
           }
         }
+      }
+    } else {
+      stats->sr_coded_error += (int64_t)this_error;
+    }
+    stats->coded_error += (int64_t)this_error;
 
-        // Search in an older reference frame.
-        if (cm->current_video_frame > 1 && gld_yv12 != NULL) {
-          // Assume 0,0 motion with no mv overhead.
-          int gf_motion_error;
+    vp9_row_mt_sync_write(row_mt_sync, mb_row, mb_col, cm->mb_cols);
 
-          xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
-          gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                 &xd->plane[0].pre[0]);
+    // Adjust to the next column of MBs.
+    x->plane[0].src.buf += 16;
+    x->plane[1].src.buf += uv_mb_height;
+    x->plane[2].src.buf += uv_mb_height;
 
-          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv.as_mv,
-                                   &gf_motion_error);
-          if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-            vp9_clear_system_state();
-            gf_motion_error = (int)(gf_motion_error * error_weight);
-          }
+    recon_yoffset += 16;
+    recon_uvoffset += uv_mb_height;
+  }
 
-          if (gf_motion_error < motion_error && gf_motion_error < this_error)
-            ++second_ref_count;
-
-          // Reset to last frame as reference buffer.
-          xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
-          xd->plane[1].pre[0].buf = first_ref_buf->u_buffer + recon_uvoffset;
-          xd->plane[2].pre[0].buf = first_ref_buf->v_buffer + recon_uvoffset;
-
-          // In accumulating a score for the older reference frame take the
-          // best of the motion predicted score and the intra coded error
-          // (just as will be done for) accumulation of "coded_error" for
-          // the last frame.
-          if (gf_motion_error < this_error)
-            sr_coded_error += gf_motion_error;
-          else
-            sr_coded_error += this_error;
-        } else {
-          sr_coded_error += motion_error;
-        }
-        // Start by assuming that intra mode is best.
-        best_ref_mv.as_int = 0;
-
-        if (motion_error <= this_error) {
-          // Keep a count of cases where the inter and intra were very close
-          // and very low. This helps with scene cut detection for example in
-          // cropped clips with black bars at the sides or top and bottom.
-          if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
-              this_error < 2 * intrapenalty)
-            ++neutral_count;
-
-          mv.as_mv.row *= 8;
-          mv.as_mv.col *= 8;
-          this_error = motion_error;
-          xd->mi[0]->mbmi.mode = NEWMV;
-          xd->mi[0]->mbmi.mv[0] = mv;
-          xd->mi[0]->mbmi.tx_size = TX_4X4;
-          xd->mi[0]->mbmi.ref_frame[0] = LAST_FRAME;
-          xd->mi[0]->mbmi.ref_frame[1] = NONE;
-          vp9_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1, bsize);
-          vp9_encode_sby_pass1(x, bsize);
-          sum_mvr += mv.as_mv.row;
-          sum_mvr_abs += abs(mv.as_mv.row);
-          sum_mvc += mv.as_mv.col;
-          sum_mvc_abs += abs(mv.as_mv.col);
-          sum_mvrs += mv.as_mv.row * mv.as_mv.row;
-          sum_mvcs += mv.as_mv.col * mv.as_mv.col;
-          ++intercount;
-
-          best_ref_mv.as_int = mv.as_int;
-
-          if (mv.as_int) {
-            ++mvcount;
-
-            // Non-zero vector, was it different from the last non zero vector?
-            if (mv.as_int != lastmv_as_int)
-              ++new_mv_count;
-            lastmv_as_int = mv.as_int;
-
-            // Does the row vector point inwards or outwards?
-            if (mb_row < cm->mb_rows / 2) {
-              if (mv.as_mv.row > 0)
-                --sum_in_vectors;
-              else if (mv.as_mv.row < 0)
-                ++sum_in_vectors;
-            } else if (mb_row > cm->mb_rows / 2) {
-              if (mv.as_mv.row > 0)
-                ++sum_in_vectors;
-              else if (mv.as_mv.row < 0)
-                --sum_in_vectors;
-            }
-
-            // Does the col vector point inwards or outwards?
-            if (mb_col < cm->mb_cols / 2) {
-              if (mv.as_mv.col > 0)
-                --sum_in_vectors;
-              else if (mv.as_mv.col < 0)
-                ++sum_in_vectors;
-            } else if (mb_col > cm->mb_cols / 2) {
-              if (mv.as_mv.col > 0)
-                ++sum_in_vectors;
-              else if (mv.as_mv.col < 0)
-                --sum_in_vectors;
-            }
-          }
-        }
-      } else {
-        sr_coded_error += (int64_t)this_error;
-      }
-      coded_error += (int64_t)this_error;
+  xd->mi = cm->mi_grid_visible;
+  vp9_clear_system_state();
+}
 
-      // Adjust to the next column of MBs.
-      x->plane[0].src.buf += 16;
-      x->plane[1].src.buf += uv_mb_height;
-      x->plane[2].src.buf += uv_mb_height;
+// Adds the statistics of row 'src' to 'dst', rows being merged in raster
+// order.
+static void accumulate_row_stats(FIRSTPASS_ROW_STATS *dst,
+                                 const FIRSTPASS_ROW_STATS *src) {
+  dst->intra_error += src->intra_error;
+  dst->coded_error += src->coded_error;
+  dst->sr_coded_error += src->sr_coded_error;
+  dst->sum_mvr += src->sum_mvr;
+  dst->sum_mvc += src->sum_mvc;
+  dst->sum_mvr_abs += src->sum_mvr_abs;
+  dst->sum_mvc_abs += src->sum_mvc_abs;
+  dst->sum_mvrs += src->sum_mvrs;
+  dst->sum_mvcs += src->sum_mvcs;
+  dst->intercount += src->intercount;
+  dst->second_ref_count += src->second_ref_count;
+  dst->neutral_count += src->neutral_count;
+  dst->sum_in_vectors += src->sum_in_vectors;
+  dst->new_mv_count += src->new_mv_count;
+  if (src->mvcount) {
+    // The last non-zero vector of the frame so far is 0 if there is none.
+    if (src->first_mv_as_int != dst->last_mv_as_int)
+      ++dst->new_mv_count;
+    dst->last_mv_as_int = src->last_mv_as_int;
+    dst->mvcount += src->mvcount;
+  }
+}
 
-      recon_yoffset += 16;
-      recon_uvoffset += uv_mb_height;
-    }
+void vp9_first_pass(VP9_COMP *cpi) {
+  int mb_row;
+  MACROBLOCK *const x = &cpi->td.mb;
+  VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
+  YV12_BUFFER_CONFIG *const gld_yv12 = get_gld_buf(cpi);
+  YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
+  const YV12_BUFFER_CONFIG *first_ref_buf;
+  FIRSTPASS_ROW_STATS stats;
+  TWO_PASS *twopass = &cpi->twopass;
 
-    // Adjust to the next row of MBs.
-    x->plane[0].src.buf += 16 * x->plane[0].src.stride - 16 * cm->mb_cols;
-    x->plane[1].src.buf += uv_mb_height * x->plane[1].src.stride -
-                           uv_mb_height * cm->mb_cols;
-    x->plane[2].src.buf += uv_mb_height * x->plane[1].src.stride -
-                           uv_mb_height * cm->mb_cols;
+  vp9_clear_system_state();
 
-    vp9_clear_system_state();
+  if (cpi->use_svc && cpi->svc.number_temporal_layers == 1) {
+    MV_REFERENCE_FRAME ref_frame = LAST_FRAME;
+    twopass = &cpi->svc.layer_context[cpi->svc.spatial_layer_id].twopass;
+
+    vp9_scale_references(cpi);
+
+    if (!(cpi->ref_frame_flags & VP9_LAST_FLAG) &&
+        (cpi->ref_frame_flags & VP9_ALT_FLAG))
+      ref_frame = ALTREF_FRAME;
+    set_ref_ptrs(cm, xd, ref_frame, NONE);
+
+    cpi->Source = vp9_scale_if_required(cm, cpi->un_scaled_source,
+                                        &cpi->scaled_source);
+  }
+  first_ref_buf = get_first_ref_buf(cpi);
+
+  vp9_setup_src_planes(x, cpi->Source, 0, 0);
+  vp9_setup_pre_planes(xd, 0, first_ref_buf, 0, 0, NULL);
+  vp9_setup_dst_planes(xd->plane, new_yv12, 0, 0);
+
+  xd->mi = cm->mi_grid_visible;
+  xd->mi[0] = cm->mi;
+
+  vp9_setup_block_planes(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
+
+  vp9_frame_init_quantizer(cpi);
+
+  vp9_init_mv_probs(cm);
+  vp9_initialize_rd_consts(cpi);
+
+  if (cpi->fp_row_stats_rows < cm->mb_rows) {
+    vpx_free(cpi->fp_row_stats);
+    cpi->fp_row_stats_rows = 0;
+    CHECK_MEM_ERROR(cm, cpi->fp_row_stats,
+                    vpx_calloc(cm->mb_rows, sizeof(*cpi->fp_row_stats)));
+    cpi->fp_row_stats_rows = cm->mb_rows;
   }
 
+  // The rows only depend on each other through the intra prediction edge, so
+  // they are encoded in parallel in wavefront order. Each row accumulates its
+  // own statistics, which are merged below in the same order as a single
+  // threaded encode.
+  if (cpi->oxcf.max_threads > 1) {
+    vp9_first_pass_rows_mt(cpi);
+  } else {
+    for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+      vp9_first_pass_encode_mb_row(cpi, &cpi->td, mb_row, NULL);
+  }
+
+  vp9_zero(stats);
+  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+    accumulate_row_stats(&stats, &cpi->fp_row_stats[mb_row]);
+
   vp9_clear_system_state();
   {
     FIRSTPASS_STATS fps;
 
     fps.frame = cm->current_video_frame;
     fps.spatial_layer_id = cpi->svc.spatial_layer_id;
-    fps.intra_error = (double)(intra_error >> 8);
-    fps.coded_error = (double)(coded_error >> 8);
-    fps.sr_coded_error = (double)(sr_coded_error >> 8);
+    fps.intra_error = (double)(stats.intra_error >> 8);
+    fps.coded_error = (double)(stats.coded_error >> 8);
+    fps.sr_coded_error = (double)(stats.sr_coded_error >> 8);
     fps.ssim_weighted_pred_err = fps.coded_error * simple_weight(cpi->Source);
     fps.count = 1.0;
-    fps.pcnt_inter = (double)intercount / cm->MBs;
-    fps.pcnt_second_ref = (double)second_ref_count / cm->MBs;
-    fps.pcnt_neutral = (double)neutral_count / cm->MBs;
-
-    if (mvcount > 0) {
-      fps.MVr = (double)sum_mvr / mvcount;
-      fps.mvr_abs = (double)sum_mvr_abs / mvcount;
-      fps.MVc = (double)sum_mvc / mvcount;
-      fps.mvc_abs = (double)sum_mvc_abs / mvcount;
-      fps.MVrv = ((double)sum_mvrs - (fps.MVr * fps.MVr / mvcount)) / mvcount;
-      fps.MVcv = ((double)sum_mvcs - (fps.MVc * fps.MVc / mvcount)) / mvcount;
-      fps.mv_in_out_count = (double)sum_in_vectors / (mvcount * 2);
-      fps.new_mv_count = new_mv_count;
+    fps.pcnt_inter = (double)stats.intercount / cm->MBs;
+    fps.pcnt_second_ref = (double)stats.second_ref_count / cm->MBs;
+    fps.pcnt_neutral = (double)stats.neutral_count / cm->MBs;
+
+    if (stats.mvcount > 0) {
+      const int mvcount = stats.mvcount;
+      fps.MVr = (double)stats.sum_mvr / mvcount;
+      fps.mvr_abs = (double)stats.sum_mvr_abs / mvcount;
+      fps.MVc = (double)stats.sum_mvc / mvcount;
+      fps.mvc_abs = (double)stats.sum_mvc_abs / mvcount;
+      fps.MVrv = ((double)stats.sum_mvrs - (fps.MVr * fps.MVr / mvcount)) /
+                 mvcount;
+      fps.MVcv = ((double)stats.sum_mvcs - (fps.MVc * fps.MVc / mvcount)) /
+                 mvcount;
+      fps.mv_in_out_count = (double)stats.sum_in_vectors / (mvcount * 2);
+      fps.new_mv_count = stats.new_mv_count;
       fps.pcnt_motion = (double)mvcount / cm->MBs;
     } else {
       fps.MVr = 0.0;
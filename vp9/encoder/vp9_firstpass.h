@@ -40,6 +40,31 @@ typedef struct {
   int64_t spatial_layer_id;
 } FIRSTPASS_STATS;
 
+// First pass statistics of one macroblock row. Everything is accumulated in
+// integers, so rows encoded on different threads add up to exactly the same
+// totals as a single threaded encode.
+typedef struct {
+  int64_t intra_error;
+  int64_t coded_error;
+  int64_t sr_coded_error;
+  int64_t sum_mvrs;
+  int64_t sum_mvcs;
+  int sum_mvr;
+  int sum_mvc;
+  int sum_mvr_abs;
+  int sum_mvc_abs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int neutral_count;
+  int sum_in_vectors;
+  // Changes between consecutive non-zero vectors within the row; the first
+  // non-zero vector is compared against the previous row's last when merging.
+  int new_mv_count;
+  uint32_t first_mv_as_int;
+  uint32_t last_mv_as_int;
+} FIRSTPASS_ROW_STATS;
+
 typedef struct {
   unsigned int section_intra_rating;
   unsigned int next_iiratio;
@@ -73,11 +98,19 @@ typedef struct {
   int gf_group_bit_allocation[MAX_LAG_BUFFERS * 2];
 } TWO_PASS;
 
+struct ThreadData;
 struct VP9_COMP;
+struct VP9RowMTSyncData;
 
 void vp9_init_first_pass(struct VP9_COMP *cpi);
 void vp9_rc_get_first_pass_params(struct VP9_COMP *cpi);
 void vp9_first_pass(struct VP9_COMP *cpi);
+
+// Runs the first pass over macroblock row 'mb_row' into
+// cpi->fp_row_stats[mb_row]. A non-NULL row_mt_sync waits on the row above.
+void vp9_first_pass_encode_mb_row(struct VP9_COMP *cpi, struct ThreadData *td,
+                                  int mb_row,
+                                  struct VP9RowMTSyncData *const row_mt_sync);
 void vp9_end_first_pass(struct VP9_COMP *cpi);
 
 void vp9_init_second_pass(struct VP9_COMP *cpi);
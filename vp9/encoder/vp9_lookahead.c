@@ -9,6 +9,7 @@
  */
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "./vpx_config.h"
 
@@ -21,12 +22,25 @@
 // The max of past frames we want to keep in the queue.
 #define MAX_PRE_FRAMES 1
 
+// The storage behind a queue entry.
+struct lookahead_frame {
+  YV12_BUFFER_CONFIG img;      /* Internal buffer that sources are copied to */
+  vpx_zero_copy_input_t ref;   /* Set while the entry references a caller's
+                                  image */
+  void *user_priv;             /* User data of the referenced image */
+  uint8_t *changed;            /* Macroblocks that changed since img was
+                                  last written to */
+};
+
 struct lookahead_ctx {
   unsigned int max_sz;         /* Absolute size of the queue */
   unsigned int sz;             /* Number of buffers currently in the queue */
   unsigned int read_idx;       /* Read index */
   unsigned int write_idx;      /* Write index */
   struct lookahead_entry *buf; /* Buffer list */
+  struct lookahead_frame *frames;  /* Storage of each entry in buf */
+  int mb_rows;                 /* Size of the macroblock maps */
+  int mb_cols;
 };
 
 
@@ -44,13 +58,32 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx,
 }
 
 
+/* Hands a referenced image back to the caller */
+static void release_ref(struct lookahead_frame *frame) {
+  if (frame->ref.release_cb != NULL) {
+    frame->ref.release_cb(frame->ref.cb_priv, frame->user_priv);
+    frame->ref.release_cb = NULL;
+  }
+}
+
+
 void vp9_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
+    if (ctx->frames) {
+      unsigned int i;
+
+      for (i = 0; i < ctx->max_sz; i++) {
+        release_ref(&ctx->frames[i]);
+        vp9_free_frame_buffer(&ctx->frames[i].img);
+        free(ctx->frames[i].changed);
+      }
+      free(ctx->frames);
+    }
     if (ctx->buf) {
       unsigned int i;
 
       for (i = 0; i < ctx->max_sz; i++)
-        vp9_free_frame_buffer(&ctx->buf[i].img);
+        vp9_pyramid_free(&ctx->buf[i].pyramid);
       free(ctx->buf);
     }
     free(ctx);
@@ -76,14 +109,23 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
   if (ctx) {
     unsigned int i;
     ctx->max_sz = depth;
+    ctx->mb_rows = (height + 15) >> 4;
+    ctx->mb_cols = (width + 15) >> 4;
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
-    if (!ctx->buf)
+    ctx->frames = calloc(depth, sizeof(*ctx->frames));
+    if (!ctx->buf || !ctx->frames)
       goto bail;
-    for (i = 0; i < depth; i++)
-      if (vp9_alloc_frame_buffer(&ctx->buf[i].img,
+    for (i = 0; i < depth; i++) {
+      if (vp9_alloc_frame_buffer(&ctx->frames[i].img,
                                  width, height, subsampling_x, subsampling_y,
                                  VP9_ENC_BORDER_IN_PIXELS))
         goto bail;
+      ctx->buf[i].img = ctx->frames[i].img;
+      ctx->frames[i].changed = malloc(ctx->mb_rows * ctx->mb_cols);
+      if (!ctx->frames[i].changed)
+        goto bail;
+      memset(ctx->frames[i].changed, 1, ctx->mb_rows * ctx->mb_cols);
+    }
   }
   return ctx;
  bail:
@@ -91,72 +133,148 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
   return NULL;
 }
 
-#define USE_PARTIAL_COPY 0
+/* Adds the macroblocks that a new source changes to the maps of the internal
+ * buffers other than the one it was copied to. A NULL active_map means that
+ * every macroblock changed.
+ */
+static void mark_changed(struct lookahead_ctx *ctx,
+                         const struct lookahead_frame *written,
+                         const unsigned char *active_map) {
+  const int mbs = ctx->mb_rows * ctx->mb_cols;
+  unsigned int i;
+  int j;
+
+  for (i = 0; i < ctx->max_sz; i++) {
+    uint8_t *const changed = ctx->frames[i].changed;
+
+    if (&ctx->frames[i] == written)
+      continue;
+    if (active_map == NULL) {
+      memset(changed, 1, mbs);
+    } else {
+      for (j = 0; j < mbs; j++)
+        changed[j] |= active_map[j];
+    }
+  }
+}
+
 
-int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG   *src,
-                       int64_t ts_start, int64_t ts_end, unsigned int flags) {
-  struct lookahead_entry *buf;
-#if USE_PARTIAL_COPY
+/* Copies the macroblocks of src that are active, or that changed since the
+ * internal buffer was last written to, and extends the border next to them.
+ */
+static void copy_changed(struct lookahead_ctx *ctx, const uint8_t *changed,
+                         const unsigned char *active_map,
+                         const YV12_BUFFER_CONFIG *src,
+                         YV12_BUFFER_CONFIG *dst) {
   int row, col, active_end;
-  int mb_rows = (src->y_height + 15) >> 4;
-  int mb_cols = (src->y_width + 15) >> 4;
-#endif
 
-  if (ctx->sz + 1  + MAX_PRE_FRAMES > ctx->max_sz)
-    return 1;
-  ctx->sz++;
-  buf = pop(ctx, &ctx->write_idx);
+  for (row = 0; row < ctx->mb_rows; ++row) {
+    const int y = row << 4;
+    const int h = MIN(16, src->y_height - y);
 
-#if USE_PARTIAL_COPY
-  // TODO(jkoleszar): This is disabled for now, as
-  // vp9_copy_and_extend_frame_with_rect is not subsampling/alpha aware.
-
-  // Only do this partial copy if the following conditions are all met:
-  // 1. Lookahead queue has has size of 1.
-  // 2. Active map is provided.
-  // 3. This is not a key frame, golden nor altref frame.
-  if (ctx->max_sz == 1 && active_map && !flags) {
-    for (row = 0; row < mb_rows; ++row) {
-      col = 0;
-
-      while (1) {
-        // Find the first active macroblock in this row.
-        for (; col < mb_cols; ++col) {
-          if (active_map[col])
-            break;
-        }
-
-        // No more active macroblock in this row.
-        if (col == mb_cols)
+    col = 0;
+    while (1) {
+      // Find the first macroblock to copy in this row.
+      for (; col < ctx->mb_cols; ++col) {
+        if (active_map[col] || changed[col])
           break;
+      }
 
-        // Find the end of active region in this row.
-        active_end = col;
-
-        for (; active_end < mb_cols; ++active_end) {
-          if (!active_map[active_end])
-            break;
-        }
-
-        // Only copy this active region.
-        vp9_copy_and_extend_frame_with_rect(src, &buf->img,
-                                            row << 4,
-                                            col << 4, 16,
-                                            (active_end - col) << 4);
+      if (col == ctx->mb_cols)
+        break;
 
-        // Start again from the end of this active region.
-        col = active_end;
+      // Find the end of the run.
+      for (active_end = col; active_end < ctx->mb_cols; ++active_end) {
+        if (!active_map[active_end] && !changed[active_end])
+          break;
       }
 
-      active_map += mb_cols;
+      vp9_copy_and_extend_frame_with_rect(
+          src, dst, y, col << 4, h,
+          MIN(active_end << 4, src->y_width) - (col << 4));
+      col = active_end;
     }
-  } else {
-    vp9_copy_and_extend_frame(src, &buf->img);
+
+    active_map += ctx->mb_cols;
+    changed += ctx->mb_cols;
   }
-#else
-  // Partial copy not implemented yet
-  vp9_copy_and_extend_frame(src, &buf->img);
-#endif
+}
+
+
+int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG   *src,
+                       int64_t ts_start, int64_t ts_end, unsigned int flags,
+                       const unsigned char *active_map,
+                       const vpx_zero_copy_input_t *zero_copy,
+                       void *user_priv) {
+  struct lookahead_entry *buf;
+  struct lookahead_frame *frame;
+
+  // The maps are only meaningful for the size the queue was set up for. Key
+  // frames, and frames with other flags, are copied whole.
+  if (((src->y_height + 15) >> 4) != ctx->mb_rows ||
+      ((src->y_width + 15) >> 4) != ctx->mb_cols || flags)
+    active_map = NULL;
+
+  if (ctx->sz + 1  + MAX_PRE_FRAMES > ctx->max_sz) {
+    if (zero_copy != NULL)
+      zero_copy->release_cb(zero_copy->cb_priv, user_priv);
+    return 1;
+  }
+  ctx->sz++;
+  buf = pop(ctx, &ctx->write_idx);
+  frame = &ctx->frames[buf - ctx->buf];
+
+  // The entry's previous source is no longer needed by the encoder.
+  release_ref(frame);
+  buf->pyramid.built = 0;
+
+  if (zero_copy != NULL) {
+    // Reference the caller's image, described like the internal buffers. The
+    // caller guarantees the border that the extension writes to.
+    YV12_BUFFER_CONFIG *const img = &buf->img;
+    const int ss_x = src->uv_width < src->y_width;
+    const int ss_y = src->uv_height < src->y_height;
+
+    vp9_extend_frame_in_place(src);
+    vp9_zero(*img);
+    img->y_crop_width = src->y_crop_width;
+    img->y_crop_height = src->y_crop_height;
+    img->y_width = ALIGN_POWER_OF_TWO(src->y_crop_width, 3);
+    img->y_height = ALIGN_POWER_OF_TWO(src->y_crop_height, 3);
+    img->y_stride = src->y_stride;
+    img->uv_crop_width = (src->y_crop_width + ss_x) >> ss_x;
+    img->uv_crop_height = (src->y_crop_height + ss_y) >> ss_y;
+    img->uv_width = img->y_width >> ss_x;
+    img->uv_height = img->y_height >> ss_y;
+    img->uv_stride = src->uv_stride;
+    img->y_buffer = src->y_buffer;
+    img->u_buffer = src->u_buffer;
+    img->v_buffer = src->v_buffer;
+    img->alpha_width = src->alpha_width;
+    img->alpha_height = src->alpha_height;
+    img->alpha_stride = src->alpha_stride;
+    img->alpha_buffer = src->alpha_buffer;
+    img->border = VP9_ZERO_COPY_INPUT_BORDER;
+    // The internal buffer was skipped, so it misses this change too.
+    mark_changed(ctx, NULL, active_map);
+    frame->ref = *zero_copy;
+    frame->user_priv = user_priv;
+    buf->ts_start = ts_start;
+    buf->ts_end = ts_end;
+    buf->flags = flags;
+    return 0;
+  }
+  buf->img = frame->img;
+
+  // With an active map only the macroblocks that differ from what the
+  // internal buffer holds need to be copied. The map is trusted to mark
+  // every macroblock that changed since the previous source.
+  if (active_map != NULL)
+    copy_changed(ctx, frame->changed, active_map, src, &buf->img);
+  else
+    vp9_copy_and_extend_frame(src, &buf->img);
+  memset(frame->changed, 0, ctx->mb_rows * ctx->mb_cols);
+  mark_changed(ctx, frame, active_map);
 
   buf->ts_start = ts_start;
   buf->ts_end = ts_end;
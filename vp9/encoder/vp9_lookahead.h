@@ -12,7 +12,9 @@
 #define VP9_ENCODER_VP9_LOOKAHEAD_H_
 
 #include "vpx_scale/yv12config.h"
+#include "vpx/vp8cx.h"
 #include "vpx/vpx_integer.h"
+#include "vp9/encoder/vp9_pyramid.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +27,7 @@ struct lookahead_entry {
   int64_t             ts_start;
   int64_t             ts_end;
   unsigned int        flags;
+  PYRAMID             pyramid;  // Built on demand, once per source
 };
 
 
@@ -52,8 +55,13 @@ void vp9_lookahead_destroy(struct lookahead_ctx *ctx);
  * This function will copy the source image into a new framebuffer with
  * the expected stride/border.
  *
- * If active_map is non-NULL and there is only one frame in the queue, then copy
- * only active macroblocks.
+ * If active_map is non-NULL and flags is 0, only the macroblocks that it marks
+ * active, or that changed since the buffer being reused was written to, are
+ * copied. All inactive macroblocks must be unchanged from the previous source.
+ *
+ * If zero_copy is non-NULL the source is referenced instead. Its borders are
+ * extended in place and it is handed back through zero_copy->release_cb once
+ * the queue no longer needs it, or right away if it could not be enqueued.
  *
  * \param[in] ctx         Pointer to the lookahead context
  * \param[in] src         Pointer to the image to enqueue
@@ -61,9 +69,14 @@ void vp9_lookahead_destroy(struct lookahead_ctx *ctx);
  * \param[in] ts_end      Timestamp for the end of this frame
  * \param[in] flags       Flags set on this frame
  * \param[in] active_map  Map that specifies which macroblock is active
+ * \param[in] zero_copy   Release callback of a caller-owned source, or NULL
+ * \param[in] user_priv   Passed to zero_copy->release_cb
  */
 int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
-                       int64_t ts_start, int64_t ts_end, unsigned int flags);
+                       int64_t ts_start, int64_t ts_end, unsigned int flags,
+                       const unsigned char *active_map,
+                       const vpx_zero_copy_input_t *zero_copy,
+                       void *user_priv);
 
 
 /**\brief Get the next source buffer to encode
@@ -30,6 +30,9 @@ extern "C" {
 // Allowed motion vector pixel distance outside image border
 // for Block_16x16
 #define BORDER_MV_PIXELS_B16 (16 + VP9_INTERP_EXTEND)
+// Maximum pixel distance a searched block may reach outside the image, which
+// keeps the filter taps within the border of the reference, chroma included.
+#define MV_SEARCH_BORDER (VP9_ENC_BORDER_IN_PIXELS - 2 * VP9_INTERP_EXTEND)
 
 // motion search site
 typedef struct search_site {
@@ -18,7 +18,7 @@ extern "C" {
 #endif
 
 int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
-                            const struct TileInfo *const tile,
+                            TileDataEnc *tile_data,
                             int mi_row, int mi_col,
                             int *returnrate,
                             int64_t *returndistortion,
@@ -0,0 +1,284 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "./vp9_rtcd.h"
+
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_common.h"
+#include "vp9/encoder/vp9_lookahead.h"
+#include "vp9/encoder/vp9_pyramid.h"
+#include "vp9/encoder/vp9_variance.h"
+
+// Pixels of each downscaled level that blocks may reach past its edges.
+#define PYRAMID_BORDER 16
+
+// Range of the exhaustive search at the coarsest level, in its pixels. It
+// covers 4 times as many pixels at full resolution.
+#define PYRAMID_SEARCH_RANGE 8
+
+// A level of the search: the planes and the size of a macroblock in them.
+typedef struct {
+  const uint8_t *src;
+  int src_stride;
+  const uint8_t *ref;
+  int ref_stride;
+  int width;
+  int height;
+  int bs;
+  vp9_sad_fn_t sdf;
+} SEARCH_LEVEL;
+
+static void downscale_plane(const uint8_t *src, int src_stride,
+                            uint8_t *dst, int dst_stride, int w, int h) {
+  int r, c;
+
+  for (r = 0; r < h; ++r) {
+    const uint8_t *const s0 = src + 2 * r * src_stride;
+    const uint8_t *const s1 = s0 + src_stride;
+
+    for (c = 0; c < w; ++c)
+      dst[c] = ROUND_POWER_OF_TWO(s0[2 * c] + s0[2 * c + 1] +
+                                  s1[2 * c] + s1[2 * c + 1], 2);
+    dst += dst_stride;
+  }
+}
+
+static void extend_plane(uint8_t *plane, int stride, int w, int h,
+                         int border) {
+  uint8_t *const first = plane - border;
+  uint8_t *const last = first + (h - 1) * stride;
+  int i;
+
+  for (i = 0; i < h; ++i) {
+    uint8_t *const row = plane + i * stride;
+    memset(row - border, row[0], border);
+    memset(row + w, row[w - 1], border);
+  }
+  for (i = 1; i <= border; ++i) {
+    memcpy(first - i * stride, first, stride);
+    memcpy(last + i * stride, last, stride);
+  }
+}
+
+int vp9_pyramid_build(struct lookahead_entry *entry) {
+  PYRAMID *const pyr = &entry->pyramid;
+  const YV12_BUFFER_CONFIG *const img = &entry->img;
+  const int mb_rows = (img->y_crop_height + 15) >> 4;
+  const int mb_cols = (img->y_crop_width + 15) >> 4;
+  const uint8_t *src = img->y_buffer;
+  int src_stride = img->y_stride;
+  int i;
+
+  if (pyr->built)
+    return 0;
+
+  for (i = 0; i < PYRAMID_LEVELS; ++i) {
+    // The luma size is a multiple of 8, so each level covers all of it.
+    const int w = img->y_width >> (i + 1);
+    const int h = img->y_height >> (i + 1);
+
+    if (pyr->buf[i] == NULL || pyr->width[i] != w || pyr->height[i] != h) {
+      const int stride = w + 2 * PYRAMID_BORDER;
+
+      vpx_free(pyr->buf[i]);
+      pyr->buf[i] = vpx_malloc(stride * (h + 2 * PYRAMID_BORDER));
+      if (pyr->buf[i] == NULL)
+        return 1;
+      pyr->plane[i] = pyr->buf[i] + PYRAMID_BORDER * stride + PYRAMID_BORDER;
+      pyr->stride[i] = stride;
+      pyr->width[i] = w;
+      pyr->height[i] = h;
+    }
+    downscale_plane(src, src_stride, pyr->plane[i], pyr->stride[i], w, h);
+    extend_plane(pyr->plane[i], pyr->stride[i], w, h, PYRAMID_BORDER);
+    src = pyr->plane[i];
+    src_stride = pyr->stride[i];
+  }
+
+  if (pyr->mvs == NULL || pyr->mb_rows != mb_rows || pyr->mb_cols != mb_cols) {
+    vpx_free(pyr->mvs);
+    pyr->mvs = vpx_malloc(mb_rows * mb_cols * sizeof(*pyr->mvs));
+    if (pyr->mvs == NULL)
+      return 1;
+    pyr->mb_rows = mb_rows;
+    pyr->mb_cols = mb_cols;
+  }
+  pyr->mvs_valid = 0;
+  pyr->built = 1;
+  return 0;
+}
+
+// Tries the positions within range of centre for the macroblock at (x0, y0)
+// of the level, keeping the best in best and best_sad.
+static void search_window(const SEARCH_LEVEL *l, int x0, int y0,
+                          const MV *centre, int range,
+                          MV *best, unsigned int *best_sad) {
+  // Keeps the block within the border of the reference.
+  const int row_lo = -PYRAMID_BORDER - y0;
+  const int row_hi = l->height + PYRAMID_BORDER - l->bs - y0;
+  const int col_lo = -PYRAMID_BORDER - x0;
+  const int col_hi = l->width + PYRAMID_BORDER - l->bs - x0;
+  const int row = clamp(centre->row, row_lo, row_hi);
+  const int col = clamp(centre->col, col_lo, col_hi);
+  const int row_min = MAX(row - range, row_lo);
+  const int row_max = MIN(row + range, row_hi);
+  const int col_min = MAX(col - range, col_lo);
+  const int col_max = MIN(col + range, col_hi);
+  const uint8_t *const src = l->src + y0 * l->src_stride + x0;
+  int r, c;
+
+  for (r = row_min; r <= row_max; ++r) {
+    const uint8_t *const ref = l->ref + (y0 + r) * l->ref_stride + x0;
+
+    for (c = col_min; c <= col_max; ++c) {
+      const unsigned int sad = l->sdf(src, l->src_stride, ref + c,
+                                      l->ref_stride, *best_sad);
+      if (sad < *best_sad) {
+        *best_sad = sad;
+        best->row = r;
+        best->col = c;
+      }
+    }
+  }
+}
+
+// Refines the motion of every macroblock, given in the units of the level
+// above, by up to range pixels of this level. The motion just refined for
+// the neighbours to the left and above is tried as well, which recovers the
+// macroblocks that the coarser level got wrong.
+static void refine_level(const SEARCH_LEVEL *l, PYRAMID *pyr, int range) {
+  int mb_row, mb_col;
+
+  for (mb_row = 0; mb_row < pyr->mb_rows; ++mb_row) {
+    for (mb_col = 0; mb_col < pyr->mb_cols; ++mb_col) {
+      const int x0 = mb_col * l->bs;
+      const int y0 = mb_row * l->bs;
+      MV *const mv = &pyr->mvs[mb_row * pyr->mb_cols + mb_col];
+      const MV centre = { mv->row * 2, mv->col * 2 };
+      unsigned int best_sad = UINT_MAX;
+
+      search_window(l, x0, y0, &centre, range, mv, &best_sad);
+      if (mb_col > 0)
+        search_window(l, x0, y0, mv - 1, 1, mv, &best_sad);
+      if (mb_row > 0)
+        search_window(l, x0, y0, mv - pyr->mb_cols, 1, mv, &best_sad);
+    }
+  }
+}
+
+void vp9_pyramid_motion_search(struct lookahead_entry *src,
+                               const struct lookahead_entry *ref) {
+  PYRAMID *const pyr = &src->pyramid;
+  const PYRAMID *const ref_pyr = &ref->pyramid;
+  // The previous field was found on the same grid, and is a good guess for
+  // motion that carries on past the range of the exhaustive search.
+  const int use_temporal = ref_pyr->mvs_valid &&
+                           ref_pyr->mb_rows == pyr->mb_rows &&
+                           ref_pyr->mb_cols == pyr->mb_cols;
+  SEARCH_LEVEL l;
+  int mb_row, mb_col, i;
+
+  assert(pyr->built && ref_pyr->built);
+  pyr->mvs_valid = 0;
+  if (src->img.y_width != ref->img.y_width ||
+      src->img.y_height != ref->img.y_height)
+    return;
+
+  // Exhaustive search at the coarsest level, and around the motion of the
+  // neighbours found so far. A macroblock has too few pixels left at this
+  // level to match reliably, so it searches for 2x2 macroblocks at a time.
+  l.src = pyr->plane[1];
+  l.src_stride = pyr->stride[1];
+  l.ref = ref_pyr->plane[1];
+  l.ref_stride = ref_pyr->stride[1];
+  l.width = pyr->width[1];
+  l.height = pyr->height[1];
+  l.bs = 8;
+  l.sdf = vp9_sad8x8;
+  for (mb_row = 0; mb_row < pyr->mb_rows; mb_row += 2) {
+    for (mb_col = 0; mb_col < pyr->mb_cols; mb_col += 2) {
+      const int x0 = mb_col * 4;
+      const int y0 = mb_row * 4;
+      MV *const mv = &pyr->mvs[mb_row * pyr->mb_cols + mb_col];
+      const MV zero = { 0, 0 };
+      unsigned int best_sad = UINT_MAX;
+
+      // Searching from zero first makes it win ties.
+      search_window(&l, x0, y0, &zero, 0, mv, &best_sad);
+      search_window(&l, x0, y0, &zero, PYRAMID_SEARCH_RANGE, mv, &best_sad);
+      if (mb_col > 0)
+        search_window(&l, x0, y0, mv - 2, 1, mv, &best_sad);
+      if (mb_row > 0)
+        search_window(&l, x0, y0, mv - 2 * pyr->mb_cols, 1, mv, &best_sad);
+      if (use_temporal) {
+        const MV *const prev = &ref_pyr->mvs[mb_row * pyr->mb_cols + mb_col];
+        const MV centre = { (prev->row >> 3) / 4, (prev->col >> 3) / 4 };
+        search_window(&l, x0, y0, &centre, 1, mv, &best_sad);
+      }
+
+      if (mb_col + 1 < pyr->mb_cols)
+        mv[1] = *mv;
+      if (mb_row + 1 < pyr->mb_rows) {
+        mv[pyr->mb_cols] = *mv;
+        if (mb_col + 1 < pyr->mb_cols)
+          mv[pyr->mb_cols + 1] = *mv;
+      }
+    }
+  }
+
+  l.src = pyr->plane[0];
+  l.src_stride = pyr->stride[0];
+  l.ref = ref_pyr->plane[0];
+  l.ref_stride = ref_pyr->stride[0];
+  l.width = pyr->width[0];
+  l.height = pyr->height[0];
+  l.bs = 8;
+  l.sdf = vp9_sad8x8;
+  // The coarsest level only finds the motion to within about a pixel.
+  refine_level(&l, pyr, 2);
+
+  l.src = src->img.y_buffer;
+  l.src_stride = src->img.y_stride;
+  l.ref = ref->img.y_buffer;
+  l.ref_stride = ref->img.y_stride;
+  l.width = src->img.y_width;
+  l.height = src->img.y_height;
+  l.bs = 16;
+  l.sdf = vp9_sad16x16;
+  refine_level(&l, pyr, 1);
+
+  for (i = 0; i < pyr->mb_rows * pyr->mb_cols; ++i) {
+    pyr->mvs[i].row *= 8;
+    pyr->mvs[i].col *= 8;
+  }
+  pyr->mvs_valid = 1;
+}
+
+const MV *vp9_pyramid_block_mv(const PYRAMID *pyr, int mi_row, int mi_col,
+                               BLOCK_SIZE bsize) {
+  const int mb_row = MIN((mi_row + (num_8x8_blocks_high_lookup[bsize] >> 1))
+                             >> 1, pyr->mb_rows - 1);
+  const int mb_col = MIN((mi_col + (num_8x8_blocks_wide_lookup[bsize] >> 1))
+                             >> 1, pyr->mb_cols - 1);
+  return &pyr->mvs[mb_row * pyr->mb_cols + mb_col];
+}
+
+void vp9_pyramid_free(PYRAMID *pyr) {
+  int i;
+
+  for (i = 0; i < PYRAMID_LEVELS; ++i)
+    vpx_free(pyr->buf[i]);
+  vpx_free(pyr->mvs);
+  vp9_zero(*pyr);
+}
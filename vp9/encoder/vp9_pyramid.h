@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_ENCODER_VP9_PYRAMID_H_
+#define VP9_ENCODER_VP9_PYRAMID_H_
+
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/common/vp9_mv.h"
+#include "vpx/vpx_integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Levels below the full resolution: the source luma downscaled by 2 and by 4
+// in each dimension.
+#define PYRAMID_LEVELS 2
+
+// The downscaled luma of a source frame, and the motion field found on it
+// against the source before it. Built at most once per source frame.
+typedef struct {
+  uint8_t *buf[PYRAMID_LEVELS];  // Allocations, with a border
+  uint8_t *plane[PYRAMID_LEVELS];  // Top-left pixel of each level
+  int stride[PYRAMID_LEVELS];
+  int width[PYRAMID_LEVELS];
+  int height[PYRAMID_LEVELS];
+  int built;
+
+  MV *mvs;  // One per macroblock, in 1/8 pel
+  int mb_rows;
+  int mb_cols;
+  int mvs_valid;
+} PYRAMID;
+
+struct lookahead_entry;
+
+// Builds the downscaled planes of the entry's source, if not built yet.
+// Returns nonzero if they could not be allocated.
+int vp9_pyramid_build(struct lookahead_entry *entry);
+
+// Searches the pyramid of src coarse to fine for the motion of each
+// macroblock from the source of ref. Both pyramids must be built.
+void vp9_pyramid_motion_search(struct lookahead_entry *src,
+                               const struct lookahead_entry *ref);
+
+// Returns the motion found for the macroblock at the centre of the block.
+const MV *vp9_pyramid_block_mv(const PYRAMID *pyr, int mi_row, int mi_col,
+                               BLOCK_SIZE bsize);
+
+void vp9_pyramid_free(PYRAMID *pyr);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_ENCODER_VP9_PYRAMID_H_
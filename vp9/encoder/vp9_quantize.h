@@ -24,16 +24,25 @@ typedef struct {
   DECLARE_ALIGNED(16, int16_t, y_zbin[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, y_round[QINDEX_RANGE][8]);
 
+  // Tables for the fast-path quantizer: quant_fp is the reciprocal of the
+  // quantizer step scaled by 2^16.
+  DECLARE_ALIGNED(16, int16_t, y_quant_fp[QINDEX_RANGE][8]);
+  DECLARE_ALIGNED(16, int16_t, y_round_fp[QINDEX_RANGE][8]);
+
   DECLARE_ALIGNED(16, int16_t, uv_quant[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, uv_quant_shift[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, uv_zbin[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, uv_round[QINDEX_RANGE][8]);
+  DECLARE_ALIGNED(16, int16_t, uv_quant_fp[QINDEX_RANGE][8]);
+  DECLARE_ALIGNED(16, int16_t, uv_round_fp[QINDEX_RANGE][8]);
 
 #if CONFIG_ALPHA
   DECLARE_ALIGNED(16, int16_t, a_quant[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, a_quant_shift[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, a_zbin[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, a_round[QINDEX_RANGE][8]);
+  DECLARE_ALIGNED(16, int16_t, a_quant_fp[QINDEX_RANGE][8]);
+  DECLARE_ALIGNED(16, int16_t, a_round_fp[QINDEX_RANGE][8]);
 #endif
 } QUANTS;
 
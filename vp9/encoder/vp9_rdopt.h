@@ -29,18 +29,20 @@ extern "C" {
 #define INVALID_MV 0x80008000
 
 struct TileInfo;
+struct TileDataEnc;
 
 int vp9_compute_rd_mult(const VP9_COMP *cpi, int qindex);
 
 void vp9_initialize_rd_consts(VP9_COMP *cpi);
 
-void vp9_initialize_me_consts(VP9_COMP *cpi, int qindex);
+void vp9_initialize_me_consts(VP9_COMP *cpi, MACROBLOCK *x, int qindex);
 
 void vp9_model_rd_from_var_lapndz(unsigned int var, unsigned int n,
                                   unsigned int qstep, int *rate,
                                   int64_t *dist);
 
-int vp9_get_switchable_rate(const VP9_COMP *cpi);
+int vp9_get_switchable_rate(const VP9_COMP *cpi,
+                            const MACROBLOCKD *const xd);
 
 void vp9_setup_buffer_inter(VP9_COMP *cpi, MACROBLOCK *x,
                             const TileInfo *const tile,
@@ -58,8 +60,9 @@ void vp9_rd_pick_intra_mode_sb(VP9_COMP *cpi, MACROBLOCK *x,
                                int *r, int64_t *d, BLOCK_SIZE bsize,
                                PICK_MODE_CONTEXT *ctx, int64_t best_rd);
 
-int64_t vp9_rd_pick_inter_mode_sb(VP9_COMP *cpi, MACROBLOCK *x,
-                                  const struct TileInfo *const tile,
+int64_t vp9_rd_pick_inter_mode_sb(VP9_COMP *cpi,
+                                  struct TileDataEnc *tile_data,
+                                  MACROBLOCK *x,
                                   int mi_row, int mi_col,
                                   int *returnrate,
                                   int64_t *returndistortion,
@@ -67,8 +70,9 @@ int64_t vp9_rd_pick_inter_mode_sb(VP9_COMP *cpi, MACROBLOCK *x,
                                   PICK_MODE_CONTEXT *ctx,
                                   int64_t best_rd_so_far);
 
-int64_t vp9_rd_pick_inter_mode_sub8x8(VP9_COMP *cpi, MACROBLOCK *x,
-                                      const struct TileInfo *const tile,
+int64_t vp9_rd_pick_inter_mode_sub8x8(VP9_COMP *cpi,
+                                      struct TileDataEnc *tile_data,
+                                      MACROBLOCK *x,
                                       int mi_row, int mi_col,
                                       int *returnrate,
                                       int64_t *returndistortion,
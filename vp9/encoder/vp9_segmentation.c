@@ -37,8 +37,8 @@ void vp9_set_segment_data(struct segmentation *seg,
   vpx_memcpy(seg->feature_data, feature_data, sizeof(seg->feature_data));
 
   // TBD ?? Set the feature mask
-  // vpx_memcpy(cpi->mb.e_mbd.segment_feature_mask, 0,
-  //            sizeof(cpi->mb.e_mbd.segment_feature_mask));
+  // vpx_memcpy(cpi->td.mb.e_mbd.segment_feature_mask, 0,
+  //            sizeof(cpi->td.mb.e_mbd.segment_feature_mask));
 }
 void vp9_disable_segfeature(struct segmentation *seg, int segment_id,
                             SEG_LVL_FEATURES feature_id) {
@@ -115,7 +115,7 @@ static void count_segs(VP9_COMP *cpi, const TileInfo *const tile,
                        int *t_unpred_seg_counts,
                        int bw, int bh, int mi_row, int mi_col) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
   int segment_id;
 
   if (mi_row >= cm->mi_rows || mi_col >= cm->mi_cols)
@@ -273,6 +273,11 @@ typedef struct SPEED_FEATURES {
   // point for this motion search and limits the search range around it.
   int adaptive_motion_search;
 
+  // Finds the motion of each macroblock from the previous source on
+  // downscaled copies of the two, coarse to fine, and tries it as another
+  // starting point for the motion search against the last frame.
+  int pyramid_motion_search;
+
   // Allows sub 8x8 modes to use the prediction filter that was determined
   // best for 8x8 mode. If set to 0 we always re check all the filters for
   // sizes less than 8x8, 1 means we check all filter modes if no 8x8 filter
@@ -315,6 +320,13 @@ typedef struct SPEED_FEATURES {
   // higher than the best rd we've seen so far.
   int use_rd_breakout;
 
+  // Ranks the inter modes of a block by the rd cost modeled from their
+  // prediction error, in the order they are searched. Only a mode that is
+  // among the best this many searched so far in the block goes on to the full
+  // transform and token costing, so the first this many modes always do. 0
+  // costs every mode in full.
+  int model_rd_top_k;
+
   // This enables us to use an estimate for intra rd based on dc mode rather
   // than choosing an actual uv mode in the stage of encoding before the actual
   // final encode.
@@ -330,6 +342,10 @@ typedef struct SPEED_FEATURES {
   // This flag controls the use of non-RD mode decision.
   int use_nonrd_pick_mode;
 
+  // Use the fast-path quantizer, which has no zero-bin, when encoding inter
+  // blocks.
+  int use_quant_fp;
+
   // A binary mask indicating if NEARESTMV, NEARMV, ZEROMV, NEWMV
   // modes are disabled in order from LSB to MSB for each BLOCK_SIZE.
   int disable_inter_mode_mask[BLOCK_SIZES];
@@ -20,6 +20,7 @@
 #include "vp9/encoder/vp9_firstpass.h"
 #include "vp9/encoder/vp9_mcomp.h"
 #include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_segmentation.h"
@@ -134,10 +135,10 @@ void vp9_temporal_filter_apply_c(uint8_t *frame1,
 }
 
 static int temporal_filter_find_matching_mb_c(VP9_COMP *cpi,
+                                              MACROBLOCK *x,
                                               uint8_t *arf_frame_buf,
                                               uint8_t *frame_ptr_buf,
                                               int stride) {
-  MACROBLOCK *x = &cpi->mb;
   MACROBLOCKD* const xd = &x->e_mbd;
   int step_param;
   int sadpb = x->sadperbit16;
@@ -186,27 +187,34 @@ static int temporal_filter_find_matching_mb_c(VP9_COMP *cpi,
   return bestsme;
 }
 
-static void temporal_filter_iterate_c(VP9_COMP *cpi,
-                                      int frame_count,
-                                      int alt_ref_index,
-                                      int strength,
-                                      struct scale_factors *scale) {
+void vp9_temporal_filter_iterate_row(VP9_COMP *cpi, ThreadData *td,
+                                     int mb_row) {
+  const ARNRFilterData *const arnr = &cpi->arnr_filter_data;
+  const int frame_count = arnr->frame_count;
+  const int alt_ref_index = arnr->alt_ref_index;
+  const int strength = arnr->strength;
   int byte;
   int frame;
-  int mb_col, mb_row;
+  int mb_col;
   unsigned int filter_weight;
   int mb_cols = cpi->common.mb_cols;
-  int mb_rows = cpi->common.mb_rows;
-  int mb_y_offset = 0;
-  int mb_uv_offset = 0;
   DECLARE_ALIGNED_ARRAY(16, unsigned int, accumulator, 16 * 16 * 3);
   DECLARE_ALIGNED_ARRAY(16, uint16_t, count, 16 * 16 * 3);
-  MACROBLOCKD *mbd = &cpi->mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *mbd = &x->e_mbd;
   YV12_BUFFER_CONFIG *f = cpi->frames[alt_ref_index];
   uint8_t *dst1, *dst2;
   DECLARE_ALIGNED_ARRAY(16, uint8_t,  predictor, 16 * 16 * 3);
   const int mb_uv_height = 16 >> mbd->plane[1].subsampling_y;
   const int mb_uv_width  = 16 >> mbd->plane[1].subsampling_x;
+  int mb_y_offset = mb_row * 16 * f->y_stride;
+  int mb_uv_offset = mb_row * mb_uv_height * f->uv_stride;
+
+  // Each row searches with its own copy of the mode info, so that rows can be
+  // filtered in any order.
+  MODE_INFO mi = *mbd->mi[0];
+  MODE_INFO *mi_ptr = &mi;
+  MODE_INFO **const input_mi = mbd->mi;
 
   // Save input state
   uint8_t* input_buffer[MAX_MB_PLANE];
@@ -214,144 +222,155 @@ static void temporal_filter_iterate_c(VP9_COMP *cpi,
 
   for (i = 0; i < MAX_MB_PLANE; i++)
     input_buffer[i] = mbd->plane[i].pre[0].buf;
+  mbd->mi = &mi_ptr;
+
+  // Source frames are extended to 16 pixels. This is different than
+  //  L/A/G reference frames that have a border of 32 (VP9ENCBORDERINPIXELS)
+  // A 6/8 tap filter is used for motion search.  This requires 2 pixels
+  //  before and 3 pixels after.  So the largest Y mv on a border would
+  //  then be 16 - VP9_INTERP_EXTEND. The UV blocks are half the size of the
+  //  Y and therefore only extended by 8.  The largest mv that a UV block
+  //  can support is 8 - VP9_INTERP_EXTEND.  A UV mv is half of a Y mv.
+  //  (16 - VP9_INTERP_EXTEND) >> 1 which is greater than
+  //  8 - VP9_INTERP_EXTEND.
+  // To keep the mv in play for both Y and UV planes the max that it
+  //  can be on a border is therefore 16 - (2*VP9_INTERP_EXTEND+1).
+  x->mv_row_min = -((mb_row * 16) + (17 - 2 * VP9_INTERP_EXTEND));
+  x->mv_row_max = ((cpi->common.mb_rows - 1 - mb_row) * 16)
+                  + (17 - 2 * VP9_INTERP_EXTEND);
+
+  for (mb_col = 0; mb_col < mb_cols; mb_col++) {
+    int i, j, k;
+    int stride;
+
+    vpx_memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
+    vpx_memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
+
+    x->mv_col_min = -((mb_col * 16) + (17 - 2 * VP9_INTERP_EXTEND));
+    x->mv_col_max = ((cpi->common.mb_cols - 1 - mb_col) * 16)
+                    + (17 - 2 * VP9_INTERP_EXTEND);
+
+    for (frame = 0; frame < frame_count; frame++) {
+      const int thresh_low  = 10000;
+      const int thresh_high = 20000;
+
+      if (cpi->frames[frame] == NULL)
+        continue;
+
+      mbd->mi[0]->bmi[0].as_mv[0].as_mv.row = 0;
+      mbd->mi[0]->bmi[0].as_mv[0].as_mv.col = 0;
+
+      if (frame == alt_ref_index) {
+        filter_weight = 2;
+      } else {
+        // Find best match in this frame by MC
+        int err = temporal_filter_find_matching_mb_c(cpi, x,
+            cpi->frames[alt_ref_index]->y_buffer + mb_y_offset,
+            cpi->frames[frame]->y_buffer + mb_y_offset,
+            cpi->frames[frame]->y_stride);
+
+        // Assign higher weight to matching MB if it's error
+        // score is lower. If not applying MC default behavior
+        // is to weight all MBs equal.
+        filter_weight = err < thresh_low
+                        ? 2 : err < thresh_high ? 1 : 0;
+      }
 
-  for (mb_row = 0; mb_row < mb_rows; mb_row++) {
-    // Source frames are extended to 16 pixels. This is different than
-    //  L/A/G reference frames that have a border of 32 (VP9ENCBORDERINPIXELS)
-    // A 6/8 tap filter is used for motion search.  This requires 2 pixels
-    //  before and 3 pixels after.  So the largest Y mv on a border would
-    //  then be 16 - VP9_INTERP_EXTEND. The UV blocks are half the size of the
-    //  Y and therefore only extended by 8.  The largest mv that a UV block
-    //  can support is 8 - VP9_INTERP_EXTEND.  A UV mv is half of a Y mv.
-    //  (16 - VP9_INTERP_EXTEND) >> 1 which is greater than
-    //  8 - VP9_INTERP_EXTEND.
-    // To keep the mv in play for both Y and UV planes the max that it
-    //  can be on a border is therefore 16 - (2*VP9_INTERP_EXTEND+1).
-    cpi->mb.mv_row_min = -((mb_row * 16) + (17 - 2 * VP9_INTERP_EXTEND));
-    cpi->mb.mv_row_max = ((cpi->common.mb_rows - 1 - mb_row) * 16)
-                         + (17 - 2 * VP9_INTERP_EXTEND);
-
-    for (mb_col = 0; mb_col < mb_cols; mb_col++) {
-      int i, j, k;
-      int stride;
-
-      vpx_memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
-      vpx_memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
-
-      cpi->mb.mv_col_min = -((mb_col * 16) + (17 - 2 * VP9_INTERP_EXTEND));
-      cpi->mb.mv_col_max = ((cpi->common.mb_cols - 1 - mb_col) * 16)
-                           + (17 - 2 * VP9_INTERP_EXTEND);
-
-      for (frame = 0; frame < frame_count; frame++) {
-        const int thresh_low  = 10000;
-        const int thresh_high = 20000;
-
-        if (cpi->frames[frame] == NULL)
-          continue;
-
-        mbd->mi[0]->bmi[0].as_mv[0].as_mv.row = 0;
-        mbd->mi[0]->bmi[0].as_mv[0].as_mv.col = 0;
-
-        if (frame == alt_ref_index) {
-          filter_weight = 2;
-        } else {
-          // Find best match in this frame by MC
-          int err = temporal_filter_find_matching_mb_c(cpi,
-              cpi->frames[alt_ref_index]->y_buffer + mb_y_offset,
-              cpi->frames[frame]->y_buffer + mb_y_offset,
-              cpi->frames[frame]->y_stride);
-
-          // Assign higher weight to matching MB if it's error
-          // score is lower. If not applying MC default behavior
-          // is to weight all MBs equal.
-          filter_weight = err < thresh_low
-                          ? 2 : err < thresh_high ? 1 : 0;
-        }
-
-        if (filter_weight != 0) {
-          // Construct the predictors
-          temporal_filter_predictors_mb_c(mbd,
-              cpi->frames[frame]->y_buffer + mb_y_offset,
-              cpi->frames[frame]->u_buffer + mb_uv_offset,
-              cpi->frames[frame]->v_buffer + mb_uv_offset,
-              cpi->frames[frame]->y_stride,
-              mb_uv_width, mb_uv_height,
-              mbd->mi[0]->bmi[0].as_mv[0].as_mv.row,
-              mbd->mi[0]->bmi[0].as_mv[0].as_mv.col,
-              predictor, scale,
-              mb_col * 16, mb_row * 16);
-
-          // Apply the filter (YUV)
-          vp9_temporal_filter_apply(f->y_buffer + mb_y_offset, f->y_stride,
-                                    predictor, 16, 16,
-                                    strength, filter_weight,
-                                    accumulator, count);
-          vp9_temporal_filter_apply(f->u_buffer + mb_uv_offset, f->uv_stride,
-                                    predictor + 256,
-                                    mb_uv_width, mb_uv_height, strength,
-                                    filter_weight, accumulator + 256,
-                                    count + 256);
-          vp9_temporal_filter_apply(f->v_buffer + mb_uv_offset, f->uv_stride,
-                                    predictor + 512,
-                                    mb_uv_width, mb_uv_height, strength,
-                                    filter_weight, accumulator + 512,
-                                    count + 512);
-        }
+      if (filter_weight != 0) {
+        // Construct the predictors
+        temporal_filter_predictors_mb_c(mbd,
+            cpi->frames[frame]->y_buffer + mb_y_offset,
+            cpi->frames[frame]->u_buffer + mb_uv_offset,
+            cpi->frames[frame]->v_buffer + mb_uv_offset,
+            cpi->frames[frame]->y_stride,
+            mb_uv_width, mb_uv_height,
+            mbd->mi[0]->bmi[0].as_mv[0].as_mv.row,
+            mbd->mi[0]->bmi[0].as_mv[0].as_mv.col,
+            predictor, &cpi->arnr_filter_data.sf,
+            mb_col * 16, mb_row * 16);
+
+        // Apply the filter (YUV)
+        vp9_temporal_filter_apply(f->y_buffer + mb_y_offset, f->y_stride,
+                                  predictor, 16, 16,
+                                  strength, filter_weight,
+                                  accumulator, count);
+        vp9_temporal_filter_apply(f->u_buffer + mb_uv_offset, f->uv_stride,
+                                  predictor + 256,
+                                  mb_uv_width, mb_uv_height, strength,
+                                  filter_weight, accumulator + 256,
+                                  count + 256);
+        vp9_temporal_filter_apply(f->v_buffer + mb_uv_offset, f->uv_stride,
+                                  predictor + 512,
+                                  mb_uv_width, mb_uv_height, strength,
+                                  filter_weight, accumulator + 512,
+                                  count + 512);
       }
+    }
 
-      // Normalize filter output to produce AltRef frame
-      dst1 = cpi->alt_ref_buffer.y_buffer;
-      stride = cpi->alt_ref_buffer.y_stride;
-      byte = mb_y_offset;
-      for (i = 0, k = 0; i < 16; i++) {
-        for (j = 0; j < 16; j++, k++) {
-          unsigned int pval = accumulator[k] + (count[k] >> 1);
-          pval *= fixed_divide[count[k]];
-          pval >>= 19;
-
-          dst1[byte] = (uint8_t)pval;
-
-          // move to next pixel
-          byte++;
-        }
-        byte += stride - 16;
+    // Normalize filter output to produce AltRef frame
+    dst1 = cpi->alt_ref_buffer.y_buffer;
+    stride = cpi->alt_ref_buffer.y_stride;
+    byte = mb_y_offset;
+    for (i = 0, k = 0; i < 16; i++) {
+      for (j = 0; j < 16; j++, k++) {
+        unsigned int pval = accumulator[k] + (count[k] >> 1);
+        pval *= fixed_divide[count[k]];
+        pval >>= 19;
+
+        dst1[byte] = (uint8_t)pval;
+
+        // move to next pixel
+        byte++;
       }
+      byte += stride - 16;
+    }
 
-      dst1 = cpi->alt_ref_buffer.u_buffer;
-      dst2 = cpi->alt_ref_buffer.v_buffer;
-      stride = cpi->alt_ref_buffer.uv_stride;
-      byte = mb_uv_offset;
-      for (i = 0, k = 256; i < mb_uv_height; i++) {
-        for (j = 0; j < mb_uv_width; j++, k++) {
-          int m = k + 256;
-
-          // U
-          unsigned int pval = accumulator[k] + (count[k] >> 1);
-          pval *= fixed_divide[count[k]];
-          pval >>= 19;
-          dst1[byte] = (uint8_t)pval;
-
-          // V
-          pval = accumulator[m] + (count[m] >> 1);
-          pval *= fixed_divide[count[m]];
-          pval >>= 19;
-          dst2[byte] = (uint8_t)pval;
-
-          // move to next pixel
-          byte++;
-        }
-        byte += stride - mb_uv_width;
+    dst1 = cpi->alt_ref_buffer.u_buffer;
+    dst2 = cpi->alt_ref_buffer.v_buffer;
+    stride = cpi->alt_ref_buffer.uv_stride;
+    byte = mb_uv_offset;
+    for (i = 0, k = 256; i < mb_uv_height; i++) {
+      for (j = 0; j < mb_uv_width; j++, k++) {
+        int m = k + 256;
+
+        // U
+        unsigned int pval = accumulator[k] + (count[k] >> 1);
+        pval *= fixed_divide[count[k]];
+        pval >>= 19;
+        dst1[byte] = (uint8_t)pval;
+
+        // V
+        pval = accumulator[m] + (count[m] >> 1);
+        pval *= fixed_divide[count[m]];
+        pval >>= 19;
+        dst2[byte] = (uint8_t)pval;
+
+        // move to next pixel
+        byte++;
       }
-      mb_y_offset += 16;
-      mb_uv_offset += mb_uv_width;
+      byte += stride - mb_uv_width;
     }
-    mb_y_offset += 16 * (f->y_stride - mb_cols);
-    mb_uv_offset += mb_uv_height * f->uv_stride - mb_uv_width * mb_cols;
+    mb_y_offset += 16;
+    mb_uv_offset += mb_uv_width;
   }
 
   // Restore input state
   for (i = 0; i < MAX_MB_PLANE; i++)
     mbd->plane[i].pre[0].buf = input_buffer[i];
+  mbd->mi = input_mi;
+}
+
+static void temporal_filter_iterate_c(VP9_COMP *cpi) {
+  int mb_row;
+
+  // The macroblocks are filtered independently of each other, so the rows
+  // can be split over the encoder threads without changing the output.
+  if (cpi->oxcf.max_threads > 1) {
+    vp9_temporal_filter_row_mt(cpi);
+  } else {
+    for (mb_row = 0; mb_row < cpi->common.mb_rows; mb_row++)
+      vp9_temporal_filter_iterate_row(cpi, &cpi->td, mb_row);
+  }
 }
 
 void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
@@ -367,7 +386,7 @@ void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
   const int num_frames_backward = distance;
   const int num_frames_forward = vp9_lookahead_depth(cpi->lookahead)
                                - (num_frames_backward + 1);
-  struct scale_factors sf;
+  ARNRFilterData *const arnr = &cpi->arnr_filter_data;
 
   switch (blur_type) {
     case 1:
@@ -426,7 +445,7 @@ void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
 #endif
 
   // Setup scaling factors. Scaling on each of the arnr frames is not supported
-  vp9_setup_scale_factors_for_frame(&sf,
+  vp9_setup_scale_factors_for_frame(&arnr->sf,
       get_frame_new_buffer(cm)->y_crop_width,
       get_frame_new_buffer(cm)->y_crop_height,
       cm->width, cm->height);
@@ -440,8 +459,10 @@ void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
     cpi->frames[frames_to_blur - 1 - frame] = &buf->img;
   }
 
-  temporal_filter_iterate_c(cpi, frames_to_blur, frames_to_blur_backward,
-                            strength, &sf);
+  arnr->frame_count = frames_to_blur;
+  arnr->alt_ref_index = frames_to_blur_backward;
+  arnr->strength = strength;
+  temporal_filter_iterate_c(cpi);
 }
 
 void vp9_configure_arnr_filter(VP9_COMP *cpi,
@@ -17,6 +17,11 @@ extern "C" {
 
 void vp9_temporal_filter_init();
 void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance);
+
+// Filters macroblock row 'mb_row' of the alt-ref frame described by
+// cpi->arnr_filter_data into cpi->alt_ref_buffer.
+void vp9_temporal_filter_iterate_row(VP9_COMP *cpi, ThreadData *td,
+                                     int mb_row);
 void vp9_configure_arnr_filter(VP9_COMP *cpi,
                                const unsigned int frames_to_arnr,
                                const int group_boost);
@@ -36,6 +36,12 @@ typedef struct {
   uint8_t         skip_eob_node;
 } TOKENEXTRA;
 
+// The tokens produced for one superblock row of a tile.
+typedef struct {
+  TOKENEXTRA *start;
+  int count;
+} TOKENLIST;
+
 extern const vp9_tree_index vp9_coef_tree[];
 extern const vp9_tree_index vp9_coef_con_tree[];
 extern struct vp9_token vp9_coef_encodings[];
@@ -43,9 +49,10 @@ extern struct vp9_token vp9_coef_encodings[];
 int vp9_is_skippable_in_plane(MACROBLOCK *x, BLOCK_SIZE bsize, int plane);
 
 struct VP9_COMP;
+struct ThreadData;
 
-void vp9_tokenize_sb(struct VP9_COMP *cpi, TOKENEXTRA **t, int dry_run,
-                     BLOCK_SIZE bsize);
+void vp9_tokenize_sb(struct VP9_COMP *cpi, struct ThreadData *td,
+                     TOKENEXTRA **t, int dry_run, BLOCK_SIZE bsize);
 
 extern const int16_t *vp9_dct_value_cost_ptr;
 /* TODO: The Token field should be broken out into a separate char array to
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>  // AVX2
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+// Returns a vector holding the dc value in lane 0 and the ac value in the
+// other lanes, which is the layout of the first 16 coefficients of a block.
+static INLINE __m256i dc_ac_avx2(int dc, int ac) {
+  return _mm256_insert_epi16(_mm256_set1_epi16((int16_t)ac), (int16_t)dc, 0);
+}
+
+// Returns a vector with every lane set to the ac value of v.
+static INLINE __m256i ac_only_avx2(__m256i v) {
+  return _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(v, v), 0);
+}
+
+static INLINE int16_t hmax_epi16_avx2(__m256i v) {
+  __m128i m = _mm_max_epi16(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 8));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 4));
+  m = _mm_max_epi16(m, _mm_srli_si128(m, 2));
+  return (int16_t)_mm_extract_epi16(m, 0);
+}
+
+// Shared implementation of the regular (use_zbin) and fast-path quantizers.
+// All the arithmetic is done on 16 coefficients at a time in raster order;
+// the end of block is found from the inverse scan. The results match the C
+// versions bit-exactly.
+static INLINE void quantize_avx2(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                                 int skip_block, const int16_t *zbin_ptr,
+                                 const int16_t *round_ptr,
+                                 const int16_t *quant_ptr,
+                                 const int16_t *quant_shift_ptr,
+                                 int16_t *qcoeff_ptr, int16_t *dqcoeff_ptr,
+                                 const int16_t *dequant_ptr,
+                                 int zbin_oq_value, uint16_t *eob_ptr,
+                                 const int16_t *iscan, int is_32x32,
+                                 int use_zbin) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i minus_one = _mm256_set1_epi16(-1);
+  const __m256i max_coeff = _mm256_set1_epi16(INT16_MAX);
+  // 32x32 blocks halve the zbin and rounding and scale by 2^15 instead of
+  // 2^16. The latter is folded into the multipliers, which stay below 2^16.
+  const int shift = is_32x32;
+  const int zbins[2] = { zbin_ptr[0] + zbin_oq_value,
+                         zbin_ptr[1] + zbin_oq_value };
+  __m256i zbin, round, quant, quant_shift, dequant;
+  __m256i eob = zero;
+  intptr_t i;
+
+  if (skip_block) {
+    for (i = 0; i < n_coeffs; i += 16) {
+      _mm256_storeu_si256((__m256i *)(qcoeff_ptr + i), zero);
+      _mm256_storeu_si256((__m256i *)(dqcoeff_ptr + i), zero);
+    }
+    *eob_ptr = 0;
+    return;
+  }
+
+  zbin = dc_ac_avx2((zbins[0] + shift) >> shift, (zbins[1] + shift) >> shift);
+  round = dc_ac_avx2((round_ptr[0] + shift) >> shift,
+                     (round_ptr[1] + shift) >> shift);
+  if (use_zbin) {
+    quant = dc_ac_avx2(quant_ptr[0], quant_ptr[1]);
+    quant_shift = dc_ac_avx2(quant_shift_ptr[0] << shift,
+                             quant_shift_ptr[1] << shift);
+  } else {
+    quant = dc_ac_avx2(quant_ptr[0] << shift, quant_ptr[1] << shift);
+    quant_shift = zero;
+  }
+  dequant = dc_ac_avx2(dequant_ptr[0], dequant_ptr[1]);
+
+  for (i = 0; i < n_coeffs; i += 16) {
+    const __m256i coeff = _mm256_loadu_si256((const __m256i *)(coeff_ptr + i));
+    const __m256i coeff_sign = _mm256_srai_epi16(coeff, 15);
+    // abs(INT16_MIN) is 0x8000, which is correct when treated as unsigned.
+    const __m256i abs_coeff = _mm256_abs_epi16(coeff);
+    __m256i tmp = _mm256_min_epu16(_mm256_adds_epu16(abs_coeff, round),
+                                   max_coeff);
+    __m256i qcoeff, dqcoeff, zero_coeff;
+
+    if (use_zbin) {
+      const __m256i in_zbin =
+          _mm256_cmpeq_epi16(_mm256_max_epu16(abs_coeff, zbin), abs_coeff);
+      tmp = _mm256_add_epi16(_mm256_mulhi_epi16(tmp, quant), tmp);
+      tmp = _mm256_mulhi_epu16(tmp, quant_shift);
+      tmp = _mm256_and_si256(tmp, in_zbin);
+    } else {
+      tmp = _mm256_mulhi_epu16(tmp, quant);
+    }
+
+    qcoeff = _mm256_sub_epi16(_mm256_xor_si256(tmp, coeff_sign), coeff_sign);
+    if (is_32x32) {
+      // (qcoeff * dequant) / 2, rounded towards zero like the C version.
+      const __m256i lo = _mm256_mullo_epi16(tmp, dequant);
+      const __m256i hi = _mm256_mulhi_epu16(tmp, dequant);
+      dqcoeff = _mm256_or_si256(_mm256_srli_epi16(lo, 1),
+                                _mm256_slli_epi16(hi, 15));
+      dqcoeff = _mm256_sub_epi16(_mm256_xor_si256(dqcoeff, coeff_sign),
+                                 coeff_sign);
+    } else {
+      dqcoeff = _mm256_mullo_epi16(qcoeff, dequant);
+    }
+    _mm256_storeu_si256((__m256i *)(qcoeff_ptr + i), qcoeff);
+    _mm256_storeu_si256((__m256i *)(dqcoeff_ptr + i), dqcoeff);
+
+    // eob = max(iscan + 1) over the non-zero coefficients.
+    zero_coeff = _mm256_cmpeq_epi16(tmp, zero);
+    eob = _mm256_max_epi16(eob, _mm256_andnot_si256(
+        zero_coeff, _mm256_sub_epi16(
+            _mm256_loadu_si256((const __m256i *)(iscan + i)), minus_one)));
+
+    if (i == 0) {
+      zbin = ac_only_avx2(zbin);
+      round = ac_only_avx2(round);
+      quant = ac_only_avx2(quant);
+      quant_shift = ac_only_avx2(quant_shift);
+      dequant = ac_only_avx2(dequant);
+    }
+  }
+  *eob_ptr = (uint16_t)hmax_epi16_avx2(eob);
+}
+
+void vp9_quantize_b_avx2(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                         int skip_block, const int16_t *zbin_ptr,
+                         const int16_t *round_ptr, const int16_t *quant_ptr,
+                         const int16_t *quant_shift_ptr, int16_t *qcoeff_ptr,
+                         int16_t *dqcoeff_ptr, const int16_t *dequant_ptr,
+                         int zbin_oq_value, uint16_t *eob_ptr,
+                         const int16_t *scan, const int16_t *iscan) {
+  (void)scan;
+  quantize_avx2(coeff_ptr, n_coeffs, skip_block, zbin_ptr, round_ptr,
+                quant_ptr, quant_shift_ptr, qcoeff_ptr, dqcoeff_ptr,
+                dequant_ptr, zbin_oq_value, eob_ptr, iscan, 0, 1);
+}
+
+void vp9_quantize_b_32x32_avx2(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                               int skip_block, const int16_t *zbin_ptr,
+                               const int16_t *round_ptr,
+                               const int16_t *quant_ptr,
+                               const int16_t *quant_shift_ptr,
+                               int16_t *qcoeff_ptr, int16_t *dqcoeff_ptr,
+                               const int16_t *dequant_ptr, int zbin_oq_value,
+                               uint16_t *eob_ptr, const int16_t *scan,
+                               const int16_t *iscan) {
+  (void)scan;
+  quantize_avx2(coeff_ptr, n_coeffs, skip_block, zbin_ptr, round_ptr,
+                quant_ptr, quant_shift_ptr, qcoeff_ptr, dqcoeff_ptr,
+                dequant_ptr, zbin_oq_value, eob_ptr, iscan, 1, 1);
+}
+
+void vp9_quantize_fp_avx2(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                          int skip_block, const int16_t *zbin_ptr,
+                          const int16_t *round_ptr, const int16_t *quant_ptr,
+                          const int16_t *quant_shift_ptr, int16_t *qcoeff_ptr,
+                          int16_t *dqcoeff_ptr, const int16_t *dequant_ptr,
+                          int zbin_oq_value, uint16_t *eob_ptr,
+                          const int16_t *scan, const int16_t *iscan) {
+  (void)scan;
+  quantize_avx2(coeff_ptr, n_coeffs, skip_block, zbin_ptr, round_ptr,
+                quant_ptr, quant_shift_ptr, qcoeff_ptr, dqcoeff_ptr,
+                dequant_ptr, zbin_oq_value, eob_ptr, iscan, 0, 0);
+}
+
+void vp9_quantize_fp_32x32_avx2(const int16_t *coeff_ptr, intptr_t n_coeffs,
+                                int skip_block, const int16_t *zbin_ptr,
+                                const int16_t *round_ptr,
+                                const int16_t *quant_ptr,
+                                const int16_t *quant_shift_ptr,
+                                int16_t *qcoeff_ptr, int16_t *dqcoeff_ptr,
+                                const int16_t *dequant_ptr, int zbin_oq_value,
+                                uint16_t *eob_ptr, const int16_t *scan,
+                                const int16_t *iscan) {
+  (void)scan;
+  quantize_avx2(coeff_ptr, n_coeffs, skip_block, zbin_ptr, round_ptr,
+                quant_ptr, quant_shift_ptr, qcoeff_ptr, dqcoeff_ptr,
+                dequant_ptr, zbin_oq_value, eob_ptr, iscan, 1, 0);
+}
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <immintrin.h>  // AVX2
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+// Loads 32 bytes of a block of the given width into one register. Blocks
+// narrower than 32 pixels pack several rows into the register: two rows of
+// 16, four rows of 8 or up to eight rows of 4. Rows beyond 'rows' are zero.
+static INLINE __m256i load_block_avx2(const uint8_t *p, int stride,
+                                      int width, int rows) {
+  if (width >= 32) {
+    return _mm256_loadu_si256((const __m256i *)p);
+  } else if (width == 16) {
+    const __m128i r0 = _mm_loadu_si128((const __m128i *)p);
+    const __m128i r1 = _mm_loadu_si128((const __m128i *)(p + stride));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(r0), r1, 1);
+  } else if (width == 8) {
+    const __m128i r01 = _mm_castpd_si128(
+        _mm_loadh_pd(_mm_castsi128_pd(_mm_loadl_epi64((const __m128i *)p)),
+                     (const double *)(p + stride)));
+    const __m128i r23 = _mm_castpd_si128(
+        _mm_loadh_pd(_mm_castsi128_pd(
+                         _mm_loadl_epi64((const __m128i *)(p + 2 * stride))),
+                     (const double *)(p + 3 * stride)));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(r01), r23, 1);
+  } else {
+    int32_t r[8] = { 0 };
+    int i;
+    for (i = 0; i < rows; ++i)
+      r[i] = *(const int32_t *)(p + i * stride);
+    return _mm256_setr_epi32(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+  }
+}
+
+static INLINE unsigned int sad_hsum_avx2(__m256i sum) {
+  const __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                       _mm256_extracti128_si256(sum, 1));
+  return _mm_cvtsi128_si32(_mm_add_epi32(sum128, _mm_srli_si128(sum128, 8)));
+}
+
+// Number of block rows held in one 32 byte register.
+#define ROWS_PER_LOAD(width) ((width) >= 32 ? 1 : 32 / (width))
+
+static INLINE unsigned int sad_avx2(const uint8_t *src, int src_stride,
+                                    const uint8_t *ref, int ref_stride,
+                                    const uint8_t *second_pred,
+                                    int width, int height) {
+  const int rows_per_load = ROWS_PER_LOAD(width);
+  __m256i sum = _mm256_setzero_si256();
+  int i, j;
+
+  for (i = 0; i < height; i += rows_per_load) {
+    const int rows = height - i < rows_per_load ? height - i : rows_per_load;
+    for (j = 0; j < width; j += 32) {
+      const __m256i s = load_block_avx2(src + j, src_stride, width, rows);
+      __m256i r = load_block_avx2(ref + j, ref_stride, width, rows);
+      if (second_pred != NULL) {
+        // second_pred is a contiguous width x height block.
+        r = _mm256_avg_epu8(r, load_block_avx2(second_pred + j, width,
+                                               width, rows));
+      }
+      sum = _mm256_add_epi32(sum, _mm256_sad_epu8(s, r));
+    }
+    src += rows_per_load * src_stride;
+    ref += rows_per_load * ref_stride;
+    if (second_pred != NULL)
+      second_pred += rows_per_load * width;
+  }
+  return sad_hsum_avx2(sum);
+}
+
+// Computes the SADs of 'num' reference blocks against the same source block,
+// loading each source row only once.
+static INLINE void sad_multi_avx2(const uint8_t *src, int src_stride,
+                                  const uint8_t *const ref[], int num,
+                                  int ref_stride, int width, int height,
+                                  unsigned int *sad_array) {
+  const int rows_per_load = ROWS_PER_LOAD(width);
+  __m256i sum[8];
+  int i, j, k;
+
+  for (k = 0; k < num; ++k)
+    sum[k] = _mm256_setzero_si256();
+
+  for (i = 0; i < height; i += rows_per_load) {
+    const int rows = height - i < rows_per_load ? height - i : rows_per_load;
+    const int ref_offset = i * ref_stride;
+    for (j = 0; j < width; j += 32) {
+      const __m256i s = load_block_avx2(src + i * src_stride + j, src_stride,
+                                        width, rows);
+      for (k = 0; k < num; ++k) {
+        const __m256i r = load_block_avx2(ref[k] + ref_offset + j, ref_stride,
+                                          width, rows);
+        sum[k] = _mm256_add_epi32(sum[k], _mm256_sad_epu8(s, r));
+      }
+    }
+  }
+
+  for (k = 0; k < num; ++k)
+    sad_array[k] = sad_hsum_avx2(sum[k]);
+}
+
+#define SAD_MXN_AVX2(m, n) \
+unsigned int vp9_sad##m##x##n##_avx2(const uint8_t *src, int src_stride, \
+                                     const uint8_t *ref, int ref_stride, \
+                                     unsigned int max_sad) { \
+  (void)max_sad; \
+  return sad_avx2(src, src_stride, ref, ref_stride, NULL, m, n); \
+} \
+unsigned int vp9_sad##m##x##n##_avg_avx2(const uint8_t *src, int src_stride, \
+                                         const uint8_t *ref, int ref_stride, \
+                                         const uint8_t *second_pred, \
+                                         unsigned int max_sad) { \
+  (void)max_sad; \
+  return sad_avx2(src, src_stride, ref, ref_stride, second_pred, m, n); \
+}
+
+#define SAD_MXNXK_AVX2(m, n, k) \
+void vp9_sad##m##x##n##x##k##_avx2(const uint8_t *src, int src_stride, \
+                                   const uint8_t *ref, int ref_stride, \
+                                   unsigned int *sads) { \
+  const uint8_t *refs[k]; \
+  int i; \
+  for (i = 0; i < k; ++i) \
+    refs[i] = ref + i; \
+  sad_multi_avx2(src, src_stride, refs, k, ref_stride, m, n, sads); \
+}
+
+#define SAD_MXNX4D_AVX2(m, n) \
+void vp9_sad##m##x##n##x4d_avx2(const uint8_t *src, int src_stride, \
+                                const uint8_t *const refs[], int ref_stride, \
+                                unsigned int *sads) { \
+  sad_multi_avx2(src, src_stride, refs, 4, ref_stride, m, n, sads); \
+}
+
+// 64x64 and 32x32 x4d are in vp9_sad4d_intrin_avx2.c.
+
+// 64x64
+SAD_MXN_AVX2(64, 64)
+SAD_MXNXK_AVX2(64, 64, 3)
+SAD_MXNXK_AVX2(64, 64, 8)
+
+// 64x32
+SAD_MXN_AVX2(64, 32)
+SAD_MXNX4D_AVX2(64, 32)
+
+// 32x64
+SAD_MXN_AVX2(32, 64)
+SAD_MXNX4D_AVX2(32, 64)
+
+// 32x32
+SAD_MXN_AVX2(32, 32)
+SAD_MXNXK_AVX2(32, 32, 3)
+SAD_MXNXK_AVX2(32, 32, 8)
+
+// 32x16
+SAD_MXN_AVX2(32, 16)
+SAD_MXNX4D_AVX2(32, 16)
+
+// 16x32
+SAD_MXN_AVX2(16, 32)
+SAD_MXNX4D_AVX2(16, 32)
+
+// 16x16
+SAD_MXN_AVX2(16, 16)
+SAD_MXNXK_AVX2(16, 16, 3)
+SAD_MXNXK_AVX2(16, 16, 8)
+SAD_MXNX4D_AVX2(16, 16)
+
+// 16x8
+SAD_MXN_AVX2(16, 8)
+SAD_MXNXK_AVX2(16, 8, 3)
+SAD_MXNXK_AVX2(16, 8, 8)
+SAD_MXNX4D_AVX2(16, 8)
+
+// 8x16
+SAD_MXN_AVX2(8, 16)
+SAD_MXNXK_AVX2(8, 16, 3)
+SAD_MXNXK_AVX2(8, 16, 8)
+SAD_MXNX4D_AVX2(8, 16)
+
+// 8x8
+SAD_MXN_AVX2(8, 8)
+SAD_MXNXK_AVX2(8, 8, 3)
+SAD_MXNXK_AVX2(8, 8, 8)
+SAD_MXNX4D_AVX2(8, 8)
+
+// 8x4
+SAD_MXN_AVX2(8, 4)
+SAD_MXNXK_AVX2(8, 4, 8)
+SAD_MXNX4D_AVX2(8, 4)
+
+// 4x8
+SAD_MXN_AVX2(4, 8)
+SAD_MXNXK_AVX2(4, 8, 8)
+SAD_MXNX4D_AVX2(4, 8)
+
+// 4x4
+SAD_MXN_AVX2(4, 4)
+SAD_MXNXK_AVX2(4, 4, 3)
+SAD_MXNXK_AVX2(4, 4, 8)
+SAD_MXNX4D_AVX2(4, 4)
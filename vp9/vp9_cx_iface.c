@@ -38,6 +38,8 @@ struct vp9_extracfg {
   unsigned int                frame_parallel_decoding_mode;
   AQ_MODE                     aq_mode;
   unsigned int                frame_periodic_boost;
+  unsigned int                row_mt;
+  unsigned int                inactive_unchanged;
   BIT_DEPTH                   bit_depth;
 };
 
@@ -68,6 +70,8 @@ static const struct extraconfig_map extracfg_map[] = {
       0,                          // frame_parallel_decoding_mode
       NO_AQ,                      // aq_mode
       0,                          // frame_periodic_delta_q
+      0,                          // row_mt
+      0,                          // inactive_unchanged
       BITS_8,                     // Bit depth
     }
   }
@@ -81,6 +85,7 @@ struct vpx_codec_alg_priv {
   VP9_COMP               *cpi;
   unsigned char          *cx_data;
   size_t                  cx_data_sz;
+  size_t                  cx_frame_sz;
   unsigned char          *pending_cx_data;
   size_t                  pending_cx_data_sz;
   int                     pending_frame_count;
@@ -90,6 +95,7 @@ struct vpx_codec_alg_priv {
   vp8_postproc_cfg_t      preview_ppcfg;
   vpx_codec_pkt_list_decl(64) pkt_list;
   unsigned int                fixed_kf_cntr;
+  vpx_zero_copy_input_t       zero_copy_input;
 };
 
 static VP9_REFFRAME ref_frame_to_vp9_reframe(vpx_ref_frame_type_t frame) {
@@ -155,6 +161,8 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
   RANGE_CHECK_BOOL(extra_cfg, lossless);
   RANGE_CHECK(extra_cfg, aq_mode,           0, AQ_MODE_COUNT - 1);
   RANGE_CHECK(extra_cfg, frame_periodic_boost, 0, 1);
+  RANGE_CHECK_BOOL(extra_cfg, row_mt);
+  RANGE_CHECK_BOOL(extra_cfg, inactive_unchanged);
   RANGE_CHECK_HI(cfg, g_threads,          64);
   RANGE_CHECK_HI(cfg, g_lag_in_frames,    MAX_LAG_BUFFERS);
   RANGE_CHECK(cfg, rc_end_usage,          VPX_VBR, VPX_Q);
@@ -287,6 +295,18 @@ static vpx_codec_err_t validate_img(vpx_codec_alg_priv_t *ctx,
   if (img->d_w != ctx->cfg.g_w || img->d_h != ctx->cfg.g_h)
     ERROR("Image size must match encoder init configuration size");
 
+  if (ctx->zero_copy_input.release_cb != NULL) {
+    // The encoder extends the edges of referenced images in place.
+    const int uv_w = (img->d_w + img->x_chroma_shift) >> img->x_chroma_shift;
+    const int uv_border = VP9_ZERO_COPY_INPUT_BORDER >> img->x_chroma_shift;
+    if (img->stride[VPX_PLANE_Y] <
+            (int)img->d_w + 2 * VP9_ZERO_COPY_INPUT_BORDER ||
+        img->stride[VPX_PLANE_U] < uv_w + 2 * uv_border ||
+        img->stride[VPX_PLANE_V] < uv_w + 2 * uv_border)
+      ERROR("Zero-copy input images need a border of "
+            "VP9_ZERO_COPY_INPUT_BORDER pixels");
+  }
+
   return VPX_CODEC_OK;
 }
 
@@ -375,6 +395,8 @@ static vpx_codec_err_t set_encoder_config(
   oxcf->tile_columns = extra_cfg->tile_columns;
   oxcf->tile_rows    = extra_cfg->tile_rows;
 
+  oxcf->max_threads = (int)cfg->g_threads;
+
   oxcf->lossless = extra_cfg->lossless;
 
   oxcf->error_resilient_mode         = cfg->g_error_resilient;
@@ -384,6 +406,10 @@ static vpx_codec_err_t set_encoder_config(
 
   oxcf->frame_periodic_boost =  extra_cfg->frame_periodic_boost;
 
+  oxcf->row_mt = extra_cfg->row_mt;
+
+  oxcf->inactive_unchanged = extra_cfg->inactive_unchanged;
+
   oxcf->ss_number_layers = cfg->ss_number_layers;
 
   if (oxcf->ss_number_layers > 1) {
@@ -508,6 +534,8 @@ static vpx_codec_err_t ctrl_set_param(vpx_codec_alg_priv_t *ctx, int ctrl_id,
         extra_cfg.frame_parallel_decoding_mode);
     MAP(VP9E_SET_AQ_MODE,                 extra_cfg.aq_mode);
     MAP(VP9E_SET_FRAME_PERIODIC_BOOST,   extra_cfg.frame_periodic_boost);
+    MAP(VP9E_SET_ROW_MT,                  extra_cfg.row_mt);
+    MAP(VP9E_SET_INACTIVE_UNCHANGED,      extra_cfg.inactive_unchanged);
   }
 
   res = validate_config(ctx, &ctx->cfg, &extra_cfg);
@@ -559,15 +587,9 @@ static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
 
     priv->extra_cfg = extracfg_map[i].cfg;
     priv->extra_cfg.pkt_list = &priv->pkt_list.head;
-     // Maximum buffer size approximated based on having multiple ARF.
-    priv->cx_data_sz = priv->cfg.g_w * priv->cfg.g_h * 3 / 2 * 8;
-
-    if (priv->cx_data_sz < 4096)
-      priv->cx_data_sz = 4096;
-
-    priv->cx_data = (unsigned char *)malloc(priv->cx_data_sz);
-    if (priv->cx_data == NULL)
-      return VPX_CODEC_MEM_ERROR;
+    // The output buffer is allocated on first use, if the application does
+    // not provide one, and grows with the frame size.
+    priv->cx_frame_sz = 4096;
 
     vp9_initialize_enc();
 
@@ -625,9 +647,40 @@ static void pick_quickcompress_mode(vpx_codec_alg_priv_t  *ctx,
   }
 }
 
+// Returns the largest frame that may be coded from img. The bitstream writer
+// does not check for overflow, so this has to be a worst case. Lossless
+// frames of noisy content come out bigger than the uncompressed image, so
+// this leaves room for twice its size.
+static size_t get_cx_frame_sz(const vpx_image_t *img) {
+  const size_t uv_w = (img->d_w + img->x_chroma_shift) >> img->x_chroma_shift;
+  const size_t uv_h = (img->d_h + img->y_chroma_shift) >> img->y_chroma_shift;
+  return 2 * ((size_t)img->d_w * img->d_h + 2 * uv_w * uv_h);
+}
+
+// Grows the internal output buffer to sz bytes, keeping any pending
+// invisible frames, which are always held in that buffer between calls.
+static vpx_codec_err_t grow_cx_data(vpx_codec_alg_priv_t *ctx, size_t sz) {
+  if (sz > ctx->cx_data_sz || ctx->cx_data == NULL) {
+    const size_t pending_offset =
+        ctx->pending_cx_data ? ctx->pending_cx_data - ctx->cx_data : 0;
+    unsigned char *const cx_data =
+        (unsigned char *)realloc(ctx->cx_data, MAX(sz, ctx->cx_data_sz));
+    if (cx_data == NULL) {
+      ctx->base.err_detail = "Failed to allocate compressed data buffer";
+      return VPX_CODEC_MEM_ERROR;
+    }
+    ctx->cx_data = cx_data;
+    ctx->cx_data_sz = MAX(sz, ctx->cx_data_sz);
+    if (ctx->pending_cx_data)
+      ctx->pending_cx_data = cx_data + pending_offset;
+  }
+  return VPX_CODEC_OK;
+}
+
 // Turn on to test if supplemental superframe data breaks decoding
 // #define TEST_SUPPLEMENTAL_SUPERFRAME_DATA
-static int write_superframe_index(vpx_codec_alg_priv_t *ctx) {
+// buf_sz is the space available at ctx->pending_cx_data.
+static int write_superframe_index(vpx_codec_alg_priv_t *ctx, size_t buf_sz) {
   uint8_t marker = 0xc0;
   unsigned int mask;
   int mag, index_sz;
@@ -649,7 +702,7 @@ static int write_superframe_index(vpx_codec_alg_priv_t *ctx) {
 
   // Write the index
   index_sz = 2 + (mag + 1) * ctx->pending_frame_count;
-  if (ctx->pending_cx_data_sz + index_sz < ctx->cx_data_sz) {
+  if (ctx->pending_cx_data_sz + index_sz < buf_sz) {
     uint8_t *x = ctx->pending_cx_data + ctx->pending_cx_data_sz;
     int i, j;
 #ifdef TEST_SUPPLEMENTAL_SUPERFRAME_DATA
@@ -757,8 +810,9 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t  *ctx,
     unsigned int lib_flags;
     YV12_BUFFER_CONFIG sd;
     int64_t dst_time_stamp, dst_end_time_stamp;
-    size_t size, cx_data_sz;
+    size_t size, cx_data_sz, data_sz, pad_sz;
     unsigned char *cx_data;
+    int use_app_buf;
 
     // Set up internal flags
     if (ctx->base.init_flags & VPX_CODEC_USE_PSNR)
@@ -777,14 +831,41 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t  *ctx,
       res = image2yuvconfig(img, &sd);
 
       if (vp9_receive_raw_frame(ctx->cpi, lib_flags,
-                                &sd, dst_time_stamp, dst_end_time_stamp)) {
+                                &sd, dst_time_stamp, dst_end_time_stamp,
+                                ctx->zero_copy_input.release_cb != NULL ?
+                                    &ctx->zero_copy_input : NULL,
+                                img->user_priv)) {
         VP9_COMP *cpi = (VP9_COMP *)ctx->cpi;
         res = update_error_state(ctx, &cpi->common.error);
       }
     }
 
-    cx_data = ctx->cx_data;
-    cx_data_sz = ctx->cx_data_sz;
+    if (img != NULL && res == VPX_CODEC_OK)
+      ctx->cx_frame_sz = MAX(ctx->cx_frame_sz, get_cx_frame_sz(img));
+
+    // Room for the invisible frames still waiting, and for an alt-ref and the
+    // visible frame that follows it. A frame is only coded while there is
+    // room for a whole one, so any further frames wait for the next call.
+    data_sz = ctx->pending_cx_data_sz + 2 * ctx->cx_frame_sz;
+
+    // Encode straight into the application's buffer when it has room for
+    // everything this call can produce, so that vpx_codec_get_cx_data() has
+    // nothing to copy. Packets are laid out there the way it would lay them
+    // out, padding included.
+    pad_sz = ctx->base.enc.cx_data_pad_before + ctx->base.enc.cx_data_pad_after;
+    use_app_buf = ctx->base.enc.cx_data_dst_buf.buf != NULL &&
+                  ctx->base.enc.cx_data_dst_buf.sz >= data_sz + pad_sz;
+    if (use_app_buf) {
+      cx_data = (unsigned char *)ctx->base.enc.cx_data_dst_buf.buf +
+                ctx->base.enc.cx_data_pad_before;
+      cx_data_sz = ctx->base.enc.cx_data_dst_buf.sz - pad_sz;
+    } else {
+      res = grow_cx_data(ctx, data_sz);
+      if (res != VPX_CODEC_OK)
+        return res;
+      cx_data = ctx->cx_data;
+      cx_data_sz = ctx->cx_data_sz;
+    }
     lib_flags = 0;
 
     /* Any pending invisible frames? */
@@ -797,13 +878,13 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t  *ctx,
       /* TODO: this is a minimal check, the underlying codec doesn't respect
        * the buffer size anyway.
        */
-      if (cx_data_sz < ctx->cx_data_sz / 2) {
+      if (cx_data_sz < ctx->cx_frame_sz) {
         ctx->base.err_detail = "Compressed data buffer too small";
         return VPX_CODEC_ERROR;
       }
     }
 
-    while (cx_data_sz >= ctx->cx_data_sz / 2 &&
+    while (cx_data_sz >= ctx->cx_frame_sz &&
            -1 != vp9_get_compressed_data(ctx->cpi, &lib_flags, &size,
                                          cx_data, &dst_time_stamp,
                                          &dst_end_time_stamp, !img)) {
@@ -859,7 +940,8 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t  *ctx,
           ctx->pending_frame_sizes[ctx->pending_frame_count++] = size;
           ctx->pending_frame_magnitude |= size;
           ctx->pending_cx_data_sz += size;
-          size += write_superframe_index(ctx);
+          size += write_superframe_index(
+              ctx, (size_t)(cx_data + cx_data_sz - ctx->pending_cx_data));
           pkt.data.frame.buf = ctx->pending_cx_data;
           pkt.data.frame.sz  = ctx->pending_cx_data_sz;
           ctx->pending_cx_data = NULL;
@@ -871,11 +953,32 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t  *ctx,
           pkt.data.frame.sz  = size;
         }
         pkt.data.frame.partition_id = -1;
+        if (use_app_buf) {
+          pkt.data.frame.buf =
+              (char *)pkt.data.frame.buf - ctx->base.enc.cx_data_pad_before;
+          pkt.data.frame.sz += pad_sz;
+        }
         vpx_codec_pkt_list_add(&ctx->pkt_list.head, &pkt);
         cx_data += size;
         cx_data_sz -= size;
+        if (use_app_buf) {
+          cx_data += pad_sz;
+          cx_data_sz = cx_data_sz > pad_sz ? cx_data_sz - pad_sz : 0;
+        }
       }
     }
+
+    // The application may reuse its buffer once it has the packets, so keep
+    // invisible frames that are still waiting for a visible one ourselves.
+    if (use_app_buf && ctx->pending_cx_data) {
+      unsigned char *const pending = ctx->pending_cx_data;
+      ctx->pending_cx_data = NULL;
+      res = grow_cx_data(ctx, 2 * ctx->pending_cx_data_sz);
+      if (res != VPX_CODEC_OK)
+        return res;
+      memcpy(ctx->cx_data, pending, ctx->pending_cx_data_sz);
+      ctx->pending_cx_data = ctx->cx_data;
+    }
   }
 
   return res;
@@ -1014,6 +1117,19 @@ static vpx_codec_err_t ctrl_set_roi_map(vpx_codec_alg_priv_t *ctx,
 }
 
 
+static vpx_codec_err_t ctrl_set_zero_copy_input(vpx_codec_alg_priv_t *ctx,
+                                                int ctrl_id, va_list args) {
+  const vpx_zero_copy_input_t *const zero_copy =
+      va_arg(args, vpx_zero_copy_input_t *);
+  (void)ctrl_id;
+
+  if (zero_copy != NULL)
+    ctx->zero_copy_input = *zero_copy;
+  else
+    vp9_zero(ctx->zero_copy_input);
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_active_map(vpx_codec_alg_priv_t *ctx,
                                            int ctrl_id, va_list args) {
   vpx_active_map_t *const map = va_arg(args, vpx_active_map_t *);
@@ -1146,6 +1262,9 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   {VP9E_SET_SVC,                      ctrl_set_svc},
   {VP9E_SET_SVC_PARAMETERS,           ctrl_set_svc_parameters},
   {VP9E_SET_SVC_LAYER_ID,             ctrl_set_svc_layer_id},
+  {VP9E_SET_ROW_MT,                   ctrl_set_param},
+  {VP9E_SET_ZERO_COPY_INPUT,          ctrl_set_zero_copy_input},
+  {VP9E_SET_INACTIVE_UNCHANGED,       ctrl_set_param},
 
   // Getters
   {VP8E_GET_LAST_QUANTIZER,           ctrl_get_param},
@@ -26,8 +26,19 @@
 
 #define VP9_CAP_POSTPROC (CONFIG_VP9_POSTPROC ? VPX_CODEC_CAP_POSTPROC : 0)
 
+// Frame-parallel decoding: with the reference frames, the frames being decoded
+// and those waiting to be output need to fit in the FRAME_BUFFERS buffers.
+#define MAX_FRAME_WORKERS 4
+#define FRAME_CACHE_SIZE (MAX_FRAME_WORKERS + 1)
+
 typedef vpx_codec_stream_info_t vp9_stream_info_t;
 
+// Frame-parallel decoding: a shown frame waiting to be output.
+typedef struct FrameCacheEntry {
+  int fb_idx;
+  void *user_priv;
+} FrameCacheEntry;
+
 struct vpx_codec_alg_priv {
   vpx_codec_priv_t        base;
   vpx_codec_dec_cfg_t     cfg;
@@ -40,6 +51,25 @@ struct vpx_codec_alg_priv {
   vpx_image_t             img;
   int                     img_avail;
   int                     invert_tile_order;
+  int                     skip_loop_filter;
+  int                     bilinear_prediction;
+  int                     skip_frames;
+  int                     droppable;
+  VP9WorkerPool          *worker_pool;
+
+  // put_slice callbacks: the frame being decoded and its rows reported so far.
+  vpx_image_t             slice_img;
+  void                   *slice_user_priv;
+  int                     slice_rows;
+
+  // Frame-parallel decoding: the shown frames in output order, and the frames
+  // returned since the last call to decoder_decode().
+  FrameCacheEntry         frame_cache[FRAME_CACHE_SIZE];
+  int                     frame_cache_read;
+  int                     num_cache_frames;
+  int                     returned_fb_idx[FRAME_CACHE_SIZE];
+  int                     num_returned_frames;
+  int                     last_show_corrupted;
 
   // External frame buffer info to save for VP9 common.
   void *ext_priv;  // Private data associated with the external frame buffers.
@@ -162,6 +192,52 @@ static vpx_codec_err_t decoder_peek_si_internal(const uint8_t *data,
   return VPX_CODEC_OK;
 }
 
+static void peek_truncated(void *data) {
+  *(int *)data = 1;
+}
+
+// Reads the start of the uncompressed header. Only frames that show an
+// existing frame are droppable. Every other frame leaves state behind that
+// later frames depend on, even when it refreshes no reference buffer: error
+// resilient frames reset the frame contexts, segmentation map and loop filter
+// deltas, and the next frame may predict from their motion vectors.
+static vpx_codec_err_t decoder_peek_droppable(const uint8_t *data,
+                                              unsigned int data_sz,
+                                              int *is_kf, int *droppable,
+                                              vpx_decrypt_cb decrypt_cb,
+                                              void *decrypt_state) {
+  uint8_t clear_buffer[1];
+  int truncated = 0;
+
+  *is_kf = 0;
+  *droppable = 0;
+
+  if (decrypt_cb) {
+    data_sz = MIN(sizeof(clear_buffer), data_sz);
+    decrypt_cb(decrypt_state, data, clear_buffer, data_sz);
+    data = clear_buffer;
+  }
+
+  {
+    struct vp9_read_bit_buffer rb = { data, data + data_sz, 0, &truncated,
+                                      peek_truncated };
+
+    if (vp9_rb_read_literal(&rb, 2) != VP9_FRAME_MARKER)
+      return VPX_CODEC_UNSUP_BITSTREAM;
+    rb.bit_offset += 2;  // profile
+
+    if (vp9_rb_read_bit(&rb))  // show an existing frame
+      *droppable = 1;
+    else
+      *is_kf = !vp9_rb_read_bit(&rb);
+
+    if (truncated)
+      return VPX_CODEC_UNSUP_BITSTREAM;
+  }
+
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t decoder_peek_si(const uint8_t *data,
                                        unsigned int data_sz,
                                        vpx_codec_stream_info_t *si) {
@@ -230,6 +306,17 @@ static void init_decoder(vpx_codec_alg_priv_t *ctx) {
 
   ctx->pbi->max_threads = ctx->cfg.threads;
   ctx->pbi->inv_tile_order = ctx->invert_tile_order;
+  ctx->pbi->worker_pool = ctx->worker_pool;
+
+  if ((ctx->base.init_flags & VPX_CODEC_USE_FRAME_THREADING) &&
+      ctx->cfg.threads > 1) {
+    if (vp9_frameworker_create(ctx->pbi,
+                               MIN(ctx->cfg.threads, MAX_FRAME_WORKERS))) {
+      vp9_decoder_remove(ctx->pbi);
+      ctx->pbi = NULL;
+      return;
+    }
+  }
 
   // If postprocessing was enabled by the application and a
   // configuration has not been provided, default it.
@@ -240,6 +327,58 @@ static void init_decoder(vpx_codec_alg_priv_t *ctx) {
   init_buffer_callbacks(ctx);
 }
 
+static vpx_codec_err_t check_frame_worker_error(vpx_codec_alg_priv_t *ctx) {
+  struct vpx_internal_error_info *const error = &ctx->pbi->frame_worker_error;
+  const vpx_codec_err_t res = update_error_state(ctx, error);
+  error->error_code = VPX_CODEC_OK;
+  return res;
+}
+
+static void drop_cached_frame(vpx_codec_alg_priv_t *ctx) {
+  vp9_release_frame_buffer_ref(ctx->pbi,
+                               ctx->frame_cache[ctx->frame_cache_read].fb_idx);
+  ctx->frame_cache_read = (ctx->frame_cache_read + 1) % FRAME_CACHE_SIZE;
+  --ctx->num_cache_frames;
+}
+
+static void release_returned_frames(vpx_codec_alg_priv_t *ctx) {
+  int i;
+  for (i = 0; i < ctx->num_returned_frames; ++i)
+    vp9_release_frame_buffer_ref(ctx->pbi, ctx->returned_fb_idx[i]);
+  ctx->num_returned_frames = 0;
+}
+
+// Hands the application the rows of the shown frame being decoded that are
+// final, as it is loop filtered.
+static void put_slice_rows(void *priv, int rows) {
+  vpx_codec_alg_priv_t *const ctx = (vpx_codec_alg_priv_t *)priv;
+  VP9_COMMON *const cm = &ctx->pbi->common;
+  vpx_image_rect_t valid, update;
+
+  rows = MIN(rows, cm->height);
+  if (!cm->show_frame || rows <= ctx->slice_rows)
+    return;
+
+  if (ctx->slice_rows == 0) {
+    yuvconfig2image(&ctx->slice_img, get_frame_new_buffer(cm),
+                    ctx->slice_user_priv);
+    ctx->slice_img.fb_priv =
+        cm->frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
+  }
+
+  valid.x = 0;
+  valid.y = 0;
+  valid.w = cm->width;
+  valid.h = rows;
+  update = valid;
+  update.y = ctx->slice_rows;
+  update.h = rows - ctx->slice_rows;
+  ctx->slice_rows = rows;
+
+  ctx->base.dec.put_slice_cb.u.put_slice(ctx->base.dec.put_slice_cb.user_priv,
+                                         &ctx->slice_img, &valid, &update);
+}
+
 static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
                                   const uint8_t **data, unsigned int data_sz,
                                   void *user_priv, int64_t deadline) {
@@ -273,12 +412,45 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
   }
 
   // Set these even if already initialized.  The caller may have changed the
-  // decrypt config between frames.
+  // decrypt config or the decode-time shortcuts between frames.
   ctx->pbi->decrypt_cb = ctx->decrypt_cb;
   ctx->pbi->decrypt_state = ctx->decrypt_state;
+  ctx->pbi->skip_loop_filter = ctx->skip_loop_filter;
+  ctx->pbi->bilinear_prediction = ctx->bilinear_prediction;
 
   cm = &ctx->pbi->common;
 
+  if (ctx->pbi->frame_parallel_decode) {
+    // Frames not retrieved by the application are dropped, as with serial
+    // decoding, once they hold up the frame buffers.
+    while (ctx->num_cache_frames > ctx->pbi->num_frame_workers)
+      drop_cached_frame(ctx);
+
+    if (vp9_receive_compressed_data(ctx->pbi, data_sz, data))
+      return update_error_state(ctx, &cm->error);
+
+    if (cm->show_frame) {
+      FrameCacheEntry *const entry =
+          &ctx->frame_cache[(ctx->frame_cache_read + ctx->num_cache_frames) %
+                            FRAME_CACHE_SIZE];
+      entry->fb_idx = cm->new_fb_idx;
+      entry->user_priv = user_priv;
+      vp9_ref_frame_buffer(ctx->pbi, entry->fb_idx);
+      ++ctx->num_cache_frames;
+    }
+    return check_frame_worker_error(ctx);
+  }
+
+  // Postprocessing works on the whole frame, so partial frames are only handed
+  // out without it.
+  if (ctx->base.dec.put_slice_cb.u.put_slice != NULL &&
+      !(ctx->base.init_flags & VPX_CODEC_USE_POSTPROC)) {
+    ctx->pbi->decoded_rows_cb = put_slice_rows;
+    ctx->pbi->decoded_rows_priv = ctx;
+    ctx->slice_user_priv = user_priv;
+    ctx->slice_rows = 0;
+  }
+
   if (vp9_receive_compressed_data(ctx->pbi, data_sz, data))
     return update_error_state(ctx, &cm->error);
 
@@ -372,6 +544,28 @@ static vpx_codec_err_t decode_one_iter(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+// Returns 1 if the decoder is to skip the frame, noting whether it is
+// droppable. Frames that cannot be peeked at are decoded, to report the error.
+static int skip_frame(vpx_codec_alg_priv_t *ctx, const uint8_t *data,
+                      unsigned int data_sz) {
+  int is_kf, droppable;
+
+  if (decoder_peek_droppable(data, data_sz, &is_kf, &droppable,
+                             ctx->decrypt_cb, ctx->decrypt_state) !=
+      VPX_CODEC_OK) {
+    ctx->droppable = 0;
+    return 0;
+  }
+
+  ctx->droppable &= droppable;
+  if ((ctx->skip_frames == 1 && droppable) ||
+      (ctx->skip_frames == 2 && !is_kf)) {
+    ctx->img_avail = 0;
+    return 1;
+  }
+  return 0;
+}
+
 static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
                                       const uint8_t *data, unsigned int data_sz,
                                       void *user_priv, long deadline) {
@@ -381,11 +575,23 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
   uint32_t frame_sizes[8];
   int frame_count;
 
+  // Release the frames returned by the last call to decoder_get_frame().
+  if (ctx->pbi != NULL)
+    release_returned_frames(ctx);
+
+  // Frame-parallel decoding: finish decoding the remaining frames.
+  if (data == NULL && data_sz == 0 && ctx->pbi != NULL &&
+      ctx->pbi->frame_parallel_decode) {
+    vp9_frameworker_sync_all(ctx->pbi);
+    return check_frame_worker_error(ctx);
+  }
+
   if (data == NULL || data_sz == 0)
     return VPX_CODEC_INVALID_PARAM;
 
   parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
                          ctx->decrypt_cb, ctx->decrypt_state);
+  ctx->droppable = 1;
 
   if (frame_count > 0) {
     int i;
@@ -398,6 +604,11 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
         return VPX_CODEC_CORRUPT_FRAME;
       }
 
+      if (skip_frame(ctx, data_start, frame_size)) {
+        data_start += frame_size;
+        continue;
+      }
+
       res = decode_one_iter(ctx, &data_start, data_end, frame_size,
                             user_priv, deadline);
       if (res != VPX_CODEC_OK)
@@ -405,8 +616,11 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
     }
   } else {
     while (data_start < data_end) {
-      res = decode_one_iter(ctx, &data_start, data_end,
-                            (uint32_t)(data_end - data_start),
+      const uint32_t frame_size = (uint32_t)(data_end - data_start);
+      if (skip_frame(ctx, data_start, frame_size))
+        break;
+
+      res = decode_one_iter(ctx, &data_start, data_end, frame_size,
                             user_priv, deadline);
       if (res != VPX_CODEC_OK)
         return res;
@@ -420,6 +634,27 @@ static vpx_image_t *decoder_get_frame(vpx_codec_alg_priv_t *ctx,
                                       vpx_codec_iter_t *iter) {
   vpx_image_t *img = NULL;
 
+  // Frame-parallel decoding: output the next shown frame once decoded.
+  if (ctx->pbi != NULL && ctx->pbi->frame_parallel_decode) {
+    const FrameCacheEntry *const entry =
+        &ctx->frame_cache[ctx->frame_cache_read];
+    if (ctx->num_cache_frames > 0 &&
+        !vp9_frameworker_is_busy(ctx->pbi, entry->fb_idx)) {
+      const RefCntBuffer *const buf =
+          &ctx->pbi->common.frame_bufs[entry->fb_idx];
+      yuvconfig2image(&ctx->img, &buf->buf, entry->user_priv);
+      ctx->img.fb_priv = buf->raw_frame_buffer.priv;
+      ctx->last_show_corrupted = buf->buf.corrupted;
+      // The frame buffer is released by the next call to decoder_decode().
+      ctx->returned_fb_idx[ctx->num_returned_frames++] = entry->fb_idx;
+      ctx->frame_cache_read = (ctx->frame_cache_read + 1) % FRAME_CACHE_SIZE;
+      --ctx->num_cache_frames;
+      img = &ctx->img;
+      *iter = img;
+    }
+    return img;
+  }
+
   if (ctx->img_avail) {
     // iter acts as a flip flop, so an image is only returned on the first
     // call to get_frame.
@@ -459,6 +694,8 @@ static vpx_codec_err_t ctrl_set_reference(vpx_codec_alg_priv_t *ctx,
     vpx_ref_frame_t *const frame = (vpx_ref_frame_t *)data;
     YV12_BUFFER_CONFIG sd;
 
+    if (ctx->pbi->frame_parallel_decode)
+      vp9_frameworker_sync_all(ctx->pbi);
     image2yuvconfig(&frame->img, &sd);
     return vp9_set_reference_dec(&ctx->pbi->common,
                                  (VP9_REFFRAME)frame->frame_type, &sd);
@@ -475,6 +712,8 @@ static vpx_codec_err_t ctrl_copy_reference(vpx_codec_alg_priv_t *ctx,
     vpx_ref_frame_t *frame = (vpx_ref_frame_t *)data;
     YV12_BUFFER_CONFIG sd;
 
+    if (ctx->pbi->frame_parallel_decode)
+      vp9_frameworker_sync_all(ctx->pbi);
     image2yuvconfig(&frame->img, &sd);
 
     return vp9_copy_reference_dec(ctx->pbi,
@@ -491,6 +730,8 @@ static vpx_codec_err_t ctrl_get_reference(vpx_codec_alg_priv_t *ctx,
   if (data) {
     YV12_BUFFER_CONFIG* fb;
 
+    if (ctx->pbi->frame_parallel_decode)
+      vp9_frameworker_sync_all(ctx->pbi);
     vp9_get_reference_dec(ctx->pbi, data->idx, &fb);
     yuvconfig2image(&data->img, fb, NULL);
     return VPX_CODEC_OK;
@@ -542,7 +783,9 @@ static vpx_codec_err_t ctrl_get_frame_corrupted(vpx_codec_alg_priv_t *ctx,
   int *corrupted = va_arg(args, int *);
 
   if (corrupted) {
-    if (ctx->pbi)
+    if (ctx->pbi && ctx->pbi->frame_parallel_decode)
+      *corrupted = ctx->last_show_corrupted;
+    else if (ctx->pbi)
       *corrupted = ctx->pbi->common.frame_to_show->corrupted;
     else
       return VPX_CODEC_ERROR;
@@ -570,12 +813,57 @@ static vpx_codec_err_t ctrl_get_display_size(vpx_codec_alg_priv_t *ctx,
   }
 }
 
+static vpx_codec_err_t ctrl_get_frame_droppable(vpx_codec_alg_priv_t *ctx,
+                                                int ctrl_id, va_list args) {
+  int *const droppable = va_arg(args, int *);
+  (void)ctrl_id;
+
+  if (droppable) {
+    *droppable = ctx->droppable;
+    return VPX_CODEC_OK;
+  } else {
+    return VPX_CODEC_INVALID_PARAM;
+  }
+}
+
 static vpx_codec_err_t ctrl_set_invert_tile_order(vpx_codec_alg_priv_t *ctx,
                                                   int ctr_id, va_list args) {
   ctx->invert_tile_order = va_arg(args, int);
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_skip_loop_filter(vpx_codec_alg_priv_t *ctx,
+                                                 int ctrl_id, va_list args) {
+  const int skip = va_arg(args, int);
+  (void)ctrl_id;
+
+  if (skip < 0 || skip > 2)
+    return VPX_CODEC_INVALID_PARAM;
+
+  ctx->skip_loop_filter = skip;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_skip_frames(vpx_codec_alg_priv_t *ctx,
+                                            int ctrl_id, va_list args) {
+  const int skip_frames = va_arg(args, int);
+  (void)ctrl_id;
+
+  if (skip_frames < 0 || skip_frames > 2)
+    return VPX_CODEC_INVALID_PARAM;
+
+  ctx->skip_frames = skip_frames;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_bilinear_prediction(vpx_codec_alg_priv_t *ctx,
+                                                    int ctrl_id,
+                                                    va_list args) {
+  (void)ctrl_id;
+  ctx->bilinear_prediction = va_arg(args, int) != 0;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_decryptor(vpx_codec_alg_priv_t *ctx,
                                           int ctrl_id,
                                           va_list args) {
@@ -585,6 +873,19 @@ static vpx_codec_err_t ctrl_set_decryptor(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_worker_pool(vpx_codec_alg_priv_t *ctx,
+                                            int ctrl_id, va_list args) {
+  vp9d_worker_pool_t *const pool = va_arg(args, vp9d_worker_pool_t *);
+  (void)ctrl_id;
+
+  // The workers are set up with the decoder, on the first frame.
+  if (ctx->pbi != NULL)
+    return VPX_CODEC_ERROR;
+
+  ctx->worker_pool = (VP9WorkerPool *)pool;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   {VP8_COPY_REFERENCE,            ctrl_copy_reference},
 
@@ -597,24 +898,38 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   {VP8_SET_DBG_DISPLAY_MV,        ctrl_set_dbg_options},
   {VP9_INVERT_TILE_DECODE_ORDER,  ctrl_set_invert_tile_order},
   {VPXD_SET_DECRYPTOR,            ctrl_set_decryptor},
+  {VP9D_SET_WORKER_POOL,          ctrl_set_worker_pool},
+  {VP9D_SET_SKIP_LOOP_FILTER,     ctrl_set_skip_loop_filter},
+  {VP9D_SET_BILINEAR_PREDICTION,  ctrl_set_bilinear_prediction},
+  {VPXD_SET_SKIP_FRAMES,          ctrl_set_skip_frames},
 
   // Getters
   {VP8D_GET_LAST_REF_UPDATES,     ctrl_get_last_ref_updates},
   {VP8D_GET_FRAME_CORRUPTED,      ctrl_get_frame_corrupted},
   {VP9_GET_REFERENCE,             ctrl_get_reference},
   {VP9D_GET_DISPLAY_SIZE,         ctrl_get_display_size},
+  {VPXD_GET_FRAME_DROPPABLE,      ctrl_get_frame_droppable},
 
   { -1, NULL},
 };
 
+vp9d_worker_pool_t *vp9d_worker_pool_create(int num_threads) {
+  return (vp9d_worker_pool_t *)vp9_worker_pool_create(num_threads);
+}
+
+void vp9d_worker_pool_destroy(vp9d_worker_pool_t *pool) {
+  vp9_worker_pool_destroy((VP9WorkerPool *)pool);
+}
+
 #ifndef VERSION_STRING
 #define VERSION_STRING
 #endif
 CODEC_INTERFACE(vpx_codec_vp9_dx) = {
   "WebM Project VP9 Decoder" VERSION_STRING,
   VPX_CODEC_INTERNAL_ABI_VERSION,
-  VPX_CODEC_CAP_DECODER | VP9_CAP_POSTPROC |
-      VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER,  // vpx_codec_caps_t
+  VPX_CODEC_CAP_DECODER | VP9_CAP_POSTPROC | VPX_CODEC_CAP_PUT_SLICE |
+      VPX_CODEC_CAP_EXTERNAL_FRAME_BUFFER |
+      VPX_CODEC_CAP_FRAME_THREADING,  // vpx_codec_caps_t
   decoder_init,       // vpx_codec_init_fn_t
   decoder_destroy,    // vpx_codec_destroy_fn_t
   decoder_ctrl_maps,  // vpx_codec_ctrl_fn_map_t
@@ -43,6 +43,9 @@ vpx_codec_err_t vpx_codec_enc_init_ver(vpx_codec_ctx_t      *ctx,
   else if ((flags & VPX_CODEC_USE_OUTPUT_PARTITION)
            && !(iface->caps & VPX_CODEC_CAP_OUTPUT_PARTITION))
     res = VPX_CODEC_INCAPABLE;
+  else if ((flags & VPX_CODEC_USE_SHARED_THREADS)
+           && !(iface->caps & VPX_CODEC_CAP_SHARED_THREADS))
+    res = VPX_CODEC_INCAPABLE;
   else {
     ctx->iface = iface;
     ctx->name = iface->name;
@@ -88,6 +91,9 @@ vpx_codec_err_t vpx_codec_enc_init_multi_ver(vpx_codec_ctx_t      *ctx,
   else if ((flags & VPX_CODEC_USE_OUTPUT_PARTITION)
            && !(iface->caps & VPX_CODEC_CAP_OUTPUT_PARTITION))
     res = VPX_CODEC_INCAPABLE;
+  else if ((flags & VPX_CODEC_USE_SHARED_THREADS)
+           && !(iface->caps & VPX_CODEC_CAP_SHARED_THREADS))
+    res = VPX_CODEC_INCAPABLE;
   else {
     int i;
     void *mem_loc = NULL;
@@ -205,9 +205,61 @@ enum vp8e_enc_control_id {
    *                     layer and 0..#vpx_codec_enc_cfg::ts_number_layers for
    *                     temporal layer.
    */
-  VP9E_SET_SVC_LAYER_ID
+  VP9E_SET_SVC_LAYER_ID,
+
+  /*!\brief control function to enable row based multi-threading.
+   *
+   * When enabled, the superblock rows of each tile column are encoded in
+   * wavefront order, so all of #vpx_codec_enc_cfg::g_threads can be used
+   * even when there is a single tile column. The output does not depend on
+   * the number of threads.
+   *
+   * \note Valid range: 0..1. 0 is the default.
+   */
+  VP9E_SET_ROW_MT,
+
+  /*!\brief control function to pass input images without copying them.
+   *
+   * By default every image passed to vpx_codec_encode() is copied into the
+   * encoder's lookahead queue. With a #vpx_zero_copy_input_t whose
+   * release_cb is set, the encoder instead references the caller's image
+   * until it no longer needs it and then calls release_cb with the image's
+   * user_priv. Passing NULL, or a NULL release_cb, restores copying for the
+   * following images.
+   *
+   * While enabled, the image planes must stay valid and unchanged until
+   * released, and each plane must have at least
+   * #VP9_ZERO_COPY_INPUT_BORDER pixels (scaled by the chroma subsampling)
+   * of writable memory around the displayed image, into which the encoder
+   * extends the image's edges. vpx_img_set_rect() on a larger image is one
+   * way to provide this. release_cb is called exactly once for each image
+   * the encoder accepts, at the latest when the encoder is destroyed; images
+   * are accepted unless vpx_codec_encode() fails with
+   * #VPX_CODEC_INVALID_PARAM.
+   */
+  VP9E_SET_ZERO_COPY_INPUT,
+
+  /*!\brief control function to promise that inactive macroblocks are
+   * unchanged.
+   *
+   * When enabled, the macroblocks that the map set with #VP8E_SET_ACTIVEMAP
+   * marks inactive must be unchanged from the previous image passed to
+   * vpx_codec_encode(). The encoder then copies only the active macroblocks
+   * of each image into its lookahead queue. Images forced to be key frames
+   * with #VPX_EFLAG_FORCE_KF, and every image of a lossless encode, are still
+   * copied whole. When disabled, inactive macroblocks may change, and every
+   * image is copied whole.
+   *
+   * \note Valid range: 0..1. 0 is the default.
+   */
+  VP9E_SET_INACTIVE_UNCHANGED
 };
 
+/*!\brief Border, in luma pixels, that images passed with
+ * #VP9E_SET_ZERO_COPY_INPUT need around each edge.
+ */
+#define VP9_ZERO_COPY_INPUT_BORDER 64
+
 /*!\brief vpx 1-D scaling mode
  *
  * This set of constants define 1-D vpx scaling modes
@@ -319,6 +371,24 @@ typedef struct vpx_svc_layer_id {
   int temporal_layer_id;      /**< Temporal layer id number. */
 } vpx_svc_layer_id_t;
 
+/*!\brief Callback that releases an input image retained by the encoder.
+ *
+ * \param[in] cb_priv    The cb_priv of the #vpx_zero_copy_input_t
+ * \param[in] user_priv  The vpx_image_t::user_priv of the released image
+ */
+typedef void (*vpx_release_input_cb_fn_t)(void *cb_priv, void *user_priv);
+
+/*!\brief  vp9 zero-copy input
+ *
+ * This is used with the #VP9E_SET_ZERO_COPY_INPUT control to let the encoder
+ * reference input images instead of copying them.
+ *
+ */
+typedef struct vpx_zero_copy_input {
+  vpx_release_input_cb_fn_t release_cb;  /**< Releases a retained image. */
+  void *cb_priv;                         /**< Passed to release_cb. */
+} vpx_zero_copy_input_t;
+
 /*!\brief VP8 encoder control function parameter type
  *
  * Defines the data types that VP8E control functions take. Note that
@@ -371,6 +441,12 @@ VPX_CTRL_USE_TYPE(VP9E_SET_AQ_MODE, unsigned int)
 
 VPX_CTRL_USE_TYPE(VP9E_SET_FRAME_PERIODIC_BOOST, unsigned int)
 
+VPX_CTRL_USE_TYPE(VP9E_SET_ROW_MT, unsigned int)
+
+VPX_CTRL_USE_TYPE(VP9E_SET_ZERO_COPY_INPUT, vpx_zero_copy_input_t *)
+
+VPX_CTRL_USE_TYPE(VP9E_SET_INACTIVE_UNCHANGED, unsigned int)
+
 /*! @} - end defgroup vp8_encoder */
 #ifdef __cplusplus
 }  // extern "C"
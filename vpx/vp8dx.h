@@ -78,6 +78,46 @@ enum vp8_dec_control_id {
   /** For testing. */
   VP9_INVERT_TILE_DECODE_ORDER,
 
+  /** control function to run the tile decoding and loop filtering of a VP9
+   *  decoder on a vp9d_worker_pool_t, which may be shared with other decoders.
+   *  Must be called before the first frame is decoded.
+   */
+  VP9D_SET_WORKER_POOL,
+
+  /** control function to skip the loop filter of a VP9 decoder, for uses
+   *  that value speed over accuracy: 0 filters every frame (the default),
+   *  1 skips the frames that no other frame references, which only affects
+   *  those frames, 2 skips every frame, so that errors build up until the
+   *  next intra-only frame.
+   */
+  VP9D_SET_SKIP_LOOP_FILTER,
+
+  /** control function to have a VP9 decoder predict with the bilinear
+   *  filter, whichever filter the stream uses, when set to 1. As with
+   *  VP9D_SET_SKIP_LOOP_FILTER, errors build up until the next intra-only
+   *  frame.
+   */
+  VP9D_SET_BILINEAR_PREDICTION,
+
+  /** control function to have the decoder skip frames after parsing no more
+   *  of them than it takes to know what they update: 0 decodes every frame
+   *  (the default), 1 skips the droppable frames (see
+   *  VPXD_GET_FRAME_DROPPABLE), 2 skips every frame but key frames. A
+   *  skipped frame decodes successfully, without output. For seeking, skip
+   *  droppable frames from the key frame before the target frame up to it.
+   */
+  VPXD_SET_SKIP_FRAMES,
+
+  /** control function to get whether the frames passed to the last decode
+   *  are droppable: 1 if none of them updates a reference frame or other
+   *  state that later frames depend on, so that they may be skipped without
+   *  changing the frames that follow. The only droppable VP9 frames are
+   *  those that show an existing frame, as every other frame updates state
+   *  that later frames depend on, whether or not it refreshes a reference
+   *  frame.
+   */
+  VPXD_GET_FRAME_DROPPABLE,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -103,6 +143,28 @@ typedef struct vpx_decrypt_init {
  */
 typedef vpx_decrypt_init vp8_decrypt_init;
 
+/*!\brief A bounded set of threads shared by VP9 decoders
+ *
+ * Decoders attached to a pool with VP9D_SET_WORKER_POOL create no threads of
+ * their own for tile decoding and loop filtering. Their jobs are queued to
+ * the pool, whose threads run the jobs of all the decoders in the order they
+ * were started. The threads member of vpx_codec_dec_cfg_t still sets how many
+ * jobs a decoder splits a frame into. Frame-parallel decoding
+ * (VPX_CODEC_USE_FRAME_THREADING) keeps its own threads. VP8 decoders
+ * cannot use a pool yet, and create their own row threads.
+ */
+typedef struct vp9d_worker_pool vp9d_worker_pool_t;
+
+/*!\brief Creates a pool of num_threads threads for VP9 decoders. Returns
+ * NULL on failure.
+ */
+vp9d_worker_pool_t *vp9d_worker_pool_create(int num_threads);
+
+/*!\brief Destroys a pool. The decoders attached to it must be destroyed
+ * first.
+ */
+void vp9d_worker_pool_destroy(vp9d_worker_pool_t *pool);
+
 
 /*!\brief VP8 decoder control function parameter type
  *
@@ -119,6 +181,11 @@ VPX_CTRL_USE_TYPE(VPXD_SET_DECRYPTOR,           vpx_decrypt_init *)
 VPX_CTRL_USE_TYPE(VP8D_SET_DECRYPTOR,           vpx_decrypt_init *)
 VPX_CTRL_USE_TYPE(VP9D_GET_DISPLAY_SIZE,        int *)
 VPX_CTRL_USE_TYPE(VP9_INVERT_TILE_DECODE_ORDER, int)
+VPX_CTRL_USE_TYPE(VP9D_SET_WORKER_POOL,         vp9d_worker_pool_t *)
+VPX_CTRL_USE_TYPE(VP9D_SET_SKIP_LOOP_FILTER,    int)
+VPX_CTRL_USE_TYPE(VP9D_SET_BILINEAR_PREDICTION, int)
+VPX_CTRL_USE_TYPE(VPXD_SET_SKIP_FRAMES,         int)
+VPX_CTRL_USE_TYPE(VPXD_GET_FRAME_DROPPABLE,     int *)
 
 /*! @} - end defgroup vp8_decoder */
 
@@ -205,6 +205,11 @@ extern "C" {
    * be empty. When no more data is available, this function should be called
    * with NULL as data and 0 as data_sz. The memory passed to this function
    * must be available until the frame has been decoded.
+   * If the decoder is configured with VPX_CODEC_USE_FRAME_THREADING enabled,
+   * frames are output once decoded, a few calls later, and errors may be
+   * reported by a later call. At the end of the stream, this function should
+   * be called with NULL as data and 0 as data_sz to finish decoding the
+   * remaining frames.
    *
    * \param[in] ctx          Pointer to this instance's context
    * \param[in] data         Pointer to this block of new coded data. If
@@ -80,6 +80,11 @@ extern "C" {
    */
 #define VPX_CODEC_CAP_OUTPUT_PARTITION  0x20000
 
+  /*! Can run its threads on a pool shared with the other encoders of the
+   *  process.
+   */
+#define VPX_CODEC_CAP_SHARED_THREADS  0x40000
+
 
   /*! \brief Initialization-time Feature Enabling
    *
@@ -91,6 +96,11 @@ extern "C" {
 #define VPX_CODEC_USE_PSNR  0x10000 /**< Calculate PSNR on each frame */
 #define VPX_CODEC_USE_OUTPUT_PARTITION  0x20000 /**< Make the encoder output one
   partition at a time. */
+#define VPX_CODEC_USE_SHARED_THREADS  0x40000 /**< Run the encoder's threads,
+  as many as g_threads asks for, on a pool of one fewer thread than there are
+  cores, shared by all the encoders created with this flag. Encoders that run
+  side by side, such as those of a multi-resolution group, then never start
+  more threads than the machine can run. */
 
 
   /*!\brief Generic fixed size buffer structure
@@ -25,6 +25,10 @@ extern "C" {
  */
 #define VPX_MAXIMUM_WORK_BUFFERS 1
 
+/*!\brief The maximum number of reference buffers that a VP8 encoder may use.
+ */
+#define VP8_MAXIMUM_REF_BUFFERS 3
+
 /*!\brief The maximum number of reference buffers that a VP9 encoder may use.
  */
 #define VP9_MAXIMUM_REF_BUFFERS 8
@@ -44,8 +44,11 @@ vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
   return 0;
 }
 
-int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
-                                  int width, int height, int border) {
+static int realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
+                                int width, int height, int border,
+                                vpx_codec_frame_buffer_t *fb,
+                                vpx_get_frame_buffer_cb_fn_t cb,
+                                void *cb_priv) {
   if (ybf) {
     int aligned_width = (width + 15) & ~15;
     int aligned_height = (height + 15) & ~15;
@@ -59,13 +62,32 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
     int uvplane_size = (uv_height + border) * uv_stride;
     const int frame_size = yplane_size + 2 * uvplane_size;
 
-    if (!ybf->buffer_alloc) {
-      ybf->buffer_alloc = (uint8_t *)vpx_memalign(32, frame_size);
-      ybf->buffer_alloc_sz = frame_size;
-    }
+    if (cb != NULL) {
+      const int align_addr_extra_size = 31;
+      const size_t external_frame_size = frame_size + align_addr_extra_size;
+
+      assert(fb != NULL);
+
+      // The memory belongs to the application, so it must not be freed.
+      if (ybf->buffer_alloc_sz > 0)
+        return -1;
+
+      if (cb(cb_priv, external_frame_size, fb) < 0)
+        return -1;
+
+      if (fb->data == NULL || fb->size < external_frame_size)
+        return -1;
 
-    if (!ybf->buffer_alloc || ybf->buffer_alloc_sz < frame_size)
-      return -1;
+      ybf->buffer_alloc = (uint8_t *)yv12_align_addr(fb->data, 32);
+    } else {
+      if (!ybf->buffer_alloc) {
+        ybf->buffer_alloc = (uint8_t *)vpx_memalign(32, frame_size);
+        ybf->buffer_alloc_sz = frame_size;
+      }
+
+      if (!ybf->buffer_alloc || ybf->buffer_alloc_sz < frame_size)
+        return -1;
+    }
 
     /* Only support allocating buffers that have a border that's a multiple
      * of 32. The border restriction is required to get 16-byte alignment of
@@ -103,6 +125,19 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
   return -2;
 }
 
+int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
+                                  int width, int height, int border) {
+  return realloc_frame_buffer(ybf, width, height, border, NULL, NULL, NULL);
+}
+
+int vp8_yv12_realloc_external_frame_buffer(YV12_BUFFER_CONFIG *ybf,
+                                           int width, int height, int border,
+                                           vpx_codec_frame_buffer_t *fb,
+                                           vpx_get_frame_buffer_cb_fn_t cb,
+                                           void *cb_priv) {
+  return realloc_frame_buffer(ybf, width, height, border, fb, cb, cb_priv);
+}
+
 int vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
                                 int width, int height, int border) {
   if (ybf) {
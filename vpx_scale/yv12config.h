@@ -21,7 +21,10 @@ extern "C" {
 #define VP8BORDERINPIXELS           32
 #define VP9INNERBORDERINPIXELS      96
 #define VP9_INTERP_EXTEND           4
-#define VP9_ENC_BORDER_IN_PIXELS    160
+// The encoder reads whole 64x64 blocks, which may reach 56 pixels past the
+// frame, plus the filter taps. Motion vectors reaching further are predicted
+// with the edge emulated, as in the decoder.
+#define VP9_ENC_BORDER_IN_PIXELS    64
 #define VP9_DEC_BORDER_IN_PIXELS    32
 
 typedef struct yv12_buffer_config {
@@ -61,6 +64,18 @@ int vp8_yv12_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
                                   int width, int height, int border);
 int vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf);
 
+// Same as vp8_yv12_realloc_frame_buffer(), except that if cb is not NULL the
+// memory comes from cb, which fills in fb, instead of being allocated by
+// libvpx. ybf must not own any memory of its own. Whenever fb->data is set
+// afterwards, even on failure, the caller must pass fb to the matching
+// release callback once ybf is no longer needed. Returns 0 on success.
+// Returns < 0 on failure.
+int vp8_yv12_realloc_external_frame_buffer(YV12_BUFFER_CONFIG *ybf,
+                                           int width, int height, int border,
+                                           vpx_codec_frame_buffer_t *fb,
+                                           vpx_get_frame_buffer_cb_fn_t cb,
+                                           void *cb_priv);
+
 int vp9_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
                            int width, int height, int ss_x, int ss_y,
                            int border);